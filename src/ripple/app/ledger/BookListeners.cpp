@@ -36,23 +36,30 @@ void BookListeners::removeSubscriber (std::uint64_t seq)
     mListeners.erase (seq);
 }
 
-void BookListeners::publish (Json::Value const& jvObj)
+void BookListeners::publish (
+    std::shared_ptr<InfoSub::Message const> const& message)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
-    auto it = mListeners.cbegin ();
-
-    while (it != mListeners.cend ())
+    std::vector<InfoSub::pointer> subs;
     {
-        InfoSub::pointer p = it->second.lock ();
+        std::lock_guard <std::recursive_mutex> sl (mLock);
+        auto it = mListeners.cbegin ();
 
-        if (p)
+        while (it != mListeners.cend ())
         {
-            p->send (jvObj, true);
-            ++it;
+            InfoSub::pointer p = it->second.lock ();
+
+            if (p)
+            {
+                subs.push_back (std::move (p));
+                ++it;
+            }
+            else
+                it = mListeners.erase (it);
         }
-        else
-            it = mListeners.erase (it);
     }
+
+    for (auto const& p : subs)
+        p->send (message, true);
 }
 
 } // ripple
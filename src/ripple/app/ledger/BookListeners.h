@@ -36,7 +36,7 @@ public:
 
     void addSubscriber (InfoSub::ref sub);
     void removeSubscriber (std::uint64_t sub);
-    void publish (Json::Value const& jvObj);
+    void publish (std::shared_ptr<InfoSub::Message const> const& message);
 
 private:
     std::recursive_mutex mLock;
@@ -24,6 +24,7 @@
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/overlay/PeerSet.h>
 #include <ripple/basics/CountedObject.h>
+#include <deque>
 #include <mutex>
 #include <set>
 #include <utility>
@@ -98,10 +99,17 @@ private:
 
     void filterNodes (
         std::vector<std::pair<SHAMapNodeID, uint256>>& nodes,
-        TriggerReason reason);
+        TriggerReason reason, std::size_t parts = 1);
 
     void trigger (std::shared_ptr<Peer> const&, TriggerReason);
 
+    std::vector<std::shared_ptr<Peer>>
+    splitPeers (std::shared_ptr<Peer> const& peer);
+
+    void sendSplit (protocol::TMGetLedger const& request,
+        std::vector<std::pair<SHAMapNodeID, uint256>> const& nodes,
+        std::vector<std::shared_ptr<Peer>> const& peers);
+
     std::vector<neededHash_t> getNeededHashes ();
 
     void addPeers ();
@@ -167,8 +175,12 @@ private:
 
     // Data we have received from peers
     std::mutex mReceivedDataLock;
-    std::vector <PeerDataPairType> mReceivedData;
-    bool mReceiveDispatched;
+    std::deque <PeerDataPairType> mReceivedData;
+    int mReceiveJobs;           // jobs processing mReceivedData
+
+    // The most useful peer of the replies the running jobs processed
+    std::shared_ptr<Peer> mChosenPeer;
+    int mChosenPeerCount;
 };
 
 } // ripple
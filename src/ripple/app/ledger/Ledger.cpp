@@ -50,8 +50,10 @@
 #include <ripple/beast/core/LexicalCast.h>
 #include <ripple/beast/unit_test.h>
 #include <boost/optional.hpp>
+#include <algorithm>
 #include <cassert>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -255,6 +257,7 @@ Ledger::Ledger (
 Ledger::Ledger (Ledger const& prevLedger,
     NetClock::time_point closeTime)
     : mImmutable (false)
+    , cache_ (prevLedger.cache_.load())
     , txMap_ (std::make_shared <SHAMap> (
         SHAMapType::TRANSACTION,
         prevLedger.stateMap_->family(),
@@ -412,18 +415,40 @@ Ledger::read (Keylet const& k) const
         assert(false);
         return nullptr;
     }
+    auto const cache = mImmutable ? cache_.load() : nullptr;
+    if (! cache)
+    {
+        auto const& item =
+            stateMap_->peekItem(k.key);
+        if (! item)
+            return nullptr;
+        auto sle = std::make_shared<SLE>(
+            SerialIter{item->data(),
+                item->size()}, item->key());
+        if (! k.check(*sle))
+            return nullptr;
+        // need move otherwise makes a copy
+        // because return type is different
+        return std::move(sle);
+    }
+
+    // The leaf hash covers the key and the data, so
+    // ledgers holding the same item share one SLE.
+    SHAMapHash digest;
     auto const& item =
-        stateMap_->peekItem(k.key);
+        stateMap_->peekItem(k.key, digest);
     if (! item)
         return nullptr;
-    auto sle = std::make_shared<SLE>(
-        SerialIter{item->data(),
-            item->size()}, item->key());
+    auto sle = cache->fetch(digest.as_uint256(),
+        [&item]()
+        {
+            return std::make_shared<SLE const>(
+                SerialIter{item->data(),
+                    item->size()}, item->key());
+        });
     if (! k.check(*sle))
         return nullptr;
-    // need move otherwise makes a copy
-    // because return type is different
-    return std::move(sle);
+    return sle;
 }
 
 //------------------------------------------------------------------------------
@@ -772,6 +797,50 @@ void Ledger::updateSkipList ()
         rawReplace(sle);
 }
 
+namespace {
+
+// The statements saveValidatedLedger runs on the transaction
+// database, prepared once and rebound for each ledger.
+struct TxnDBWriter : DatabaseCon::Prepared
+{
+    std::uint32_t ledgerSeq = 0;
+    std::string txnId;
+    std::vector<std::string> txnIds;
+    std::vector<std::string> accounts;
+    std::vector<std::uint32_t> ledgerSeqs;
+    std::vector<std::uint32_t> txnSeqs;
+
+    soci::statement deleteTrans;
+    soci::statement deleteAcctTrans;
+    soci::statement deleteTxnAcctTrans;
+    soci::statement addAcctTrans;
+
+    explicit
+    TxnDBWriter (soci::session& session)
+        : deleteTrans ((session.prepare <<
+            "DELETE FROM Transactions WHERE LedgerSeq = :ledgerSeq;",
+            soci::use (ledgerSeq)))
+        , deleteAcctTrans ((session.prepare <<
+            "DELETE FROM AccountTransactions WHERE LedgerSeq = :ledgerSeq;",
+            soci::use (ledgerSeq)))
+        , deleteTxnAcctTrans ((session.prepare <<
+            "DELETE FROM AccountTransactions WHERE TransID = :txnId;",
+            soci::use (txnId)))
+        , addAcctTrans ((session.prepare <<
+            R"sql(INSERT INTO AccountTransactions
+                (TransID, Account, LedgerSeq, TxnSeq)
+            VALUES
+                (:txnId, :account, :ledgerSeq, :txnSeq);)sql",
+            soci::use (txnIds),
+            soci::use (accounts),
+            soci::use (ledgerSeqs),
+            soci::use (txnSeqs)))
+    {
+    }
+};
+
+} // namespace
+
 static bool saveValidatedLedger (
     Application& app,
     std::shared_ptr<Ledger const> const& ledger,
@@ -792,12 +861,9 @@ static bool saveValidatedLedger (
         << (current ? "" : "fromAcquire ") << ledger->info().seq;
     static boost::format deleteLedger (
         "DELETE FROM Ledgers WHERE LedgerSeq = %u;");
-    static boost::format deleteTrans1 (
-        "DELETE FROM Transactions WHERE LedgerSeq = %u;");
-    static boost::format deleteTrans2 (
-        "DELETE FROM AccountTransactions WHERE LedgerSeq = %u;");
-    static boost::format deleteAcctTrans (
-        "DELETE FROM AccountTransactions WHERE TransID = '%s';");
+
+    // SQLite limits the number of rows in one VALUES clause
+    std::size_t const txnRowsPerInsert = 128;
 
     auto seq = ledger->info().seq;
 
@@ -856,74 +922,85 @@ static bool saveValidatedLedger (
 
     {
         auto db = app.getTxnDB ().checkoutDb ();
+        auto& w = app.getTxnDB ().getPrepared<TxnDBWriter> ();
 
         soci::transaction tr(*db);
 
-        *db << boost::str (deleteTrans1 % seq);
-        *db << boost::str (deleteTrans2 % seq);
+        w.ledgerSeq = seq;
+        w.deleteTrans.execute (true);
+        w.deleteAcctTrans.execute (true);
 
-        std::string const ledgerSeq (std::to_string (seq));
+        // Gather the rows for the whole ledger first, so that the
+        // AccountTransactions rows are inserted in one execution.
+        auto const& txns = aLedger->getMap ();
 
-        for (auto const& vt : aLedger->getMap ())
+        std::vector<std::string> txnRows;
+        txnRows.reserve (txns.size ());
+
+        w.txnIds.clear ();
+        w.accounts.clear ();
+        w.ledgerSeqs.clear ();
+        w.txnSeqs.clear ();
+
+        for (auto const& vt : txns)
         {
             uint256 transactionID = vt.second->getTransactionID ();
 
             app.getMasterTransaction ().inLedger (
                 transactionID, seq);
 
-            std::string const txnId (to_string (transactionID));
-            std::string const txnSeq (std::to_string (vt.second->getTxnSeq ()));
+            auto const txnId = to_string (transactionID);
 
-            *db << boost::str (deleteAcctTrans % transactionID);
+            // Drop any rows left from saving it in another ledger
+            w.txnId = txnId;
+            w.deleteTxnAcctTrans.execute (true);
 
             auto const& accts = vt.second->getAffected ();
 
-            if (!accts.empty ())
-            {
-                std::string sql (
-                    "INSERT INTO AccountTransactions "
-                    "(TransID, Account, LedgerSeq, TxnSeq) VALUES ");
-
-                // Try to make an educated guess on how much space we'll need
-                // for our arguments. In argument order we have:
-                // 64 + 34 + 10 + 10 = 118 + 10 extra = 128 bytes
-                sql.reserve (sql.length () + (accts.size () * 128));
-
-                bool first = true;
-                for (auto const& account : accts)
-                {
-                    if (!first)
-                        sql += ", ('";
-                    else
-                    {
-                        sql += "('";
-                        first = false;
-                    }
-
-                    sql += txnId;
-                    sql += "','";
-                    sql += app.accountIDCache().toBase58(account);
-                    sql += "',";
-                    sql += ledgerSeq;
-                    sql += ",";
-                    sql += txnSeq;
-                    sql += ")";
-                }
-                sql += ";";
-                JLOG (j.trace()) << "ActTx: " << sql;
-                *db << sql;
-            }
-            else
+            if (accts.empty ())
             {
                 JLOG (j.warn())
                     << "Transaction in ledger " << seq
                     << " affects no accounts";
             }
 
-            *db <<
-               (STTx::getMetaSQLInsertReplaceHeader () +
-                vt.second->getTxn ()->getMetaSQL (
-                    seq, vt.second->getEscMeta ()) + ";");
+            for (auto const& account : accts)
+            {
+                w.txnIds.push_back (txnId);
+                w.accounts.push_back (
+                    app.accountIDCache().toBase58 (account));
+                w.ledgerSeqs.push_back (seq);
+                w.txnSeqs.push_back (vt.second->getTxnSeq ());
+            }
+
+            txnRows.push_back (vt.second->getTxn ()->getMetaSQL (
+                seq, vt.second->getEscMeta ()));
+        }
+
+        // soci rejects bulk operations on empty vectors
+        if (! w.accounts.empty ())
+        {
+            JLOG (j.trace()) << "ActTx: " << w.accounts.size () << " rows";
+            w.addAcctTrans.execute (true);
+        }
+
+        // RawTxn and TxnMeta are written as blob literals,
+        // so these rows go out as text, many per statement.
+        for (std::size_t i = 0; i < txnRows.size ();)
+        {
+            auto const end = std::min (
+                txnRows.size (), i + txnRowsPerInsert);
+
+            std::string sql = STTx::getMetaSQLInsertReplaceHeader ();
+            for (bool first = true; i < end; ++i, first = false)
+            {
+                if (! first)
+                    sql += ", ";
+                sql += txnRows[i];
+            }
+            sql += ";";
+
+            *db << sql;
         }
 
         tr.commit ();
@@ -1084,7 +1161,7 @@ loadLedgerHelper(std::string const& sqlSuffix, Application& app)
     uint256 ledgerHash{};
     std::uint32_t ledgerSeq{0};
 
-    auto db = app.getLedgerDB ().checkoutDb ();
+    auto db = app.getLedgerDB ().checkoutReadDb ();
 
     boost::optional<std::string> sLedgerHash, sPrevHash, sAccountHash,
         sTransHash;
@@ -1227,7 +1304,7 @@ getHashByIndex (std::uint32_t ledgerIndex, Application& app)
 
     std::string hash;
     {
-        auto db = app.getLedgerDB ().checkoutDb ();
+        auto db = app.getLedgerDB ().checkoutReadDb ();
 
         boost::optional<std::string> lh;
         *db << sql,
@@ -1250,7 +1327,7 @@ getHashesByIndex(std::uint32_t ledgerIndex,
     uint256& ledgerHash, uint256& parentHash,
         Application& app)
 {
-    auto db = app.getLedgerDB ().checkoutDb ();
+    auto db = app.getLedgerDB ().checkoutReadDb ();
 
     boost::optional <std::string> lhO, phO;
 
@@ -1287,7 +1364,7 @@ getHashesByIndex (std::uint32_t minSeq, std::uint32_t maxSeq,
     sql.append (beast::lexicalCastThrow <std::string> (maxSeq));
     sql.append (";");
 
-    auto db = app.getLedgerDB ().checkoutDb ();
+    auto db = app.getLedgerDB ().checkoutReadDb ();
 
     std::uint64_t ls;
     std::string lh;
@@ -32,6 +32,7 @@
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/beast/utility/Journal.h>
 #include <boost/optional.hpp>
+#include <atomic>
 #include <mutex>
 
 namespace ripple {
@@ -241,6 +242,19 @@ public:
         return mImmutable;
     }
 
+    /** Share the SLEs read from this ledger once it is immutable.
+
+        SLEs are cached by the digest of their leaf, so ledgers
+        using the same cache share the SLEs they have in common.
+        Ledgers built on this one inherit the cache.
+
+        @note The cache must outlive the ledger's readers.
+    */
+    void setCache (CachedSLEs& cache) const
+    {
+        cache_ = &cache;
+    }
+
     /*  Mark this ledger as "should be full".
 
         "Full" is metadata property of the ledger, it indicates
@@ -313,6 +327,9 @@ private:
 
     bool mImmutable;
 
+    // Used by read once immutable
+    std::atomic<CachedSLEs*> mutable cache_ {nullptr};
+
     std::shared_ptr<SHAMap> txMap_;
     std::shared_ptr<SHAMap> stateMap_;
 
@@ -23,6 +23,7 @@
 #include <ripple/basics/Log.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/basics/contract.h>
+#include <ripple/ledger/CachedSLEs.h>
 #include <ripple/json/to_string.h>
 
 namespace ripple {
@@ -63,6 +64,8 @@ LedgerHistory::insert(
 
     assert (ledger->stateMap().getHash ().isNonZero ());
 
+    ledger->setCache (app_.cachedSLEs());
+
     LedgersByHash::ScopedLockType sl (m_ledgers_by_hash.peekMutex ());
 
     const bool alreadyHad = m_ledgers_by_hash.canonicalize (
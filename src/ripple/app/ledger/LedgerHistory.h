@@ -71,6 +71,14 @@ public:
     */
     void tune (int size, int age);
 
+    /** Charge the history cache against a shared memory budget
+        @param budget The budget, which must outlive this object
+    */
+    void setCacheBudget (CacheBudget& budget)
+    {
+        m_ledgers_by_hash.setBudget (budget);
+    }
+
     /** Remove stale cache entries
     */
     void sweep ()
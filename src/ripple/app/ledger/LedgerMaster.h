@@ -194,6 +194,7 @@ public:
         std::uint32_t& minVal, std::uint32_t& maxVal);
 
     void tune (int size, int age);
+    void setCacheBudget (CacheBudget& budget);
     void sweep ();
     float getCacheHitRate ();
 
@@ -228,10 +229,23 @@ public:
         bool progress,
         std::uint32_t seq);
 
+    /** Add a fetch pack entry whose hash was computed from its data. */
     void addFetchPack (
         uint256 const& hash,
         std::shared_ptr<Blob>& data);
 
+    using FetchPackEntry = std::pair<uint256, std::shared_ptr<Blob>>;
+
+    /** Add entries received in a fetch pack.
+
+        The data of all the entries is hashed in one batch, and entries
+        whose data does not match their hash are dropped.
+
+        @return The number of entries dropped.
+    */
+    std::size_t addFetchPack (
+        std::vector<FetchPackEntry>& entries);
+
     bool getFetchPack (
         uint256 const& hash,
         Blob& data);
@@ -25,13 +25,70 @@
 #include <ripple/core/Config.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/protocol/Indexes.h>
+#include <ripple/shamap/SHAMapMissingNode.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
 namespace ripple {
 
+namespace {
+
+// The most threads, the caller included, which scan a ledger
+int const scanJobs = 4;
+
+// Returns the book whose directory fields the object holds
+Book
+bookFromFields (STObject const& fields)
+{
+    // Metadata leaves out fields with their default value,
+    // so a missing currency or issuer is XRP.
+    auto const get = [&fields] (SField const& field)
+    {
+        return fields.isFieldPresent (field)
+            ? fields.getFieldH160 (field)
+            : uint160 ();
+    };
+
+    Book book;
+    book.in.currency.copyFrom (get (sfTakerPaysCurrency));
+    book.in.account.copyFrom (get (sfTakerPaysIssuer));
+    book.out.account.copyFrom (get (sfTakerGetsIssuer));
+    book.out.currency.copyFrom (get (sfTakerGetsCurrency));
+    return book;
+}
+
+// Returns true if the directory fields are those of the root page
+// of an order book quality directory
+bool
+isBookRoot (STObject const& fields, uint256 const& key)
+{
+    return fields.isFieldPresent (sfExchangeRate) &&
+        fields.isFieldPresent (sfRootIndex) &&
+        fields.getFieldH256 (sfRootIndex) == key;
+}
+
+void
+insertBook (
+    OrderBookDB::IssueToOrderBook& sourceMap,
+    OrderBookDB::IssueToOrderBook& destMap,
+    hash_set <Issue>& XRPBooks,
+    Book const& book)
+{
+    auto orderBook = std::make_shared<OrderBook> (getBookBase (book), book);
+    sourceMap[book.in].push_back (orderBook);
+    destMap[book.out].push_back (orderBook);
+    if (isXRP (book.out))
+        XRPBooks.insert (book.in);
+}
+
+} // (anonymous)
+
 OrderBookDB::OrderBookDB (Application& app, Stoppable& parent)
     : Stoppable ("OrderBookDB", parent)
     , app_ (app)
     , mSeq (0)
+    , mUpdating (false)
     , j_ (app.journal ("OrderBookDB"))
 {
 }
@@ -45,16 +102,24 @@ void OrderBookDB::invalidate ()
 void OrderBookDB::setup(
     std::shared_ptr<ReadView const> const& ledger)
 {
+    if (app_.config().PATH_SEARCH_MAX == 0)
+    {
+        // pathfinding has been disabled
+        return;
+    }
+
     {
         std::lock_guard <std::recursive_mutex> sl (mLock);
         auto seq = ledger->info().seq;
 
-        // Do a full update every 256 ledgers
+        // A running scan replays the ledgers published after its own
+        if (mUpdating)
+            return;
+
+        // processLedger keeps the books current from here
         if (mSeq != 0)
         {
-            if (seq == mSeq)
-                return;
-            if ((seq > mSeq) && ((seq - mSeq) < 256))
+            if ((seq == mSeq) || (seq == mSeq + 1))
                 return;
             if ((seq < mSeq) && ((mSeq - seq) < 16))
                 return;
@@ -63,14 +128,17 @@ void OrderBookDB::setup(
         JLOG (j_.debug())
             << "Advancing from " << mSeq << " to " << seq;
 
-        mSeq = seq;
+        mUpdating = true;
+        mPending.clear ();
     }
 
-    if (app_.config().PATH_SEARCH_MAX == 0)
-    {
-        // nothing to do
-    }
-    else if (app_.config().standalone())
+    startUpdate (ledger);
+}
+
+void OrderBookDB::startUpdate(
+    std::shared_ptr<ReadView const> const& ledger)
+{
+    if (app_.config().standalone())
         update(ledger);
     else
         app_.getJobQueue().addJob(
@@ -81,72 +149,281 @@ void OrderBookDB::setup(
 void OrderBookDB::update(
     std::shared_ptr<ReadView const> const& ledger)
 {
-    hash_set< uint256 > seen;
+    JLOG (j_.debug()) << "OrderBookDB::update>";
+
+    // Unless the books are replaced, drop them and whatever was
+    // queued for them, so that the next ledger starts another scan.
+    struct Abandon
+    {
+        OrderBookDB& db;
+        bool active = true;
+
+        ~Abandon ()
+        {
+            if (! active)
+                return;
+            std::lock_guard <std::recursive_mutex> sl (db.mLock);
+            db.mSeq = 0;
+            db.mUpdating = false;
+            db.mPending.clear ();
+        }
+    } abandon {*this};
+
+    RootMap roots;
+
+    if (! scan (*ledger, roots))
+        return;
+
     OrderBookDB::IssueToOrderBook destMap;
     OrderBookDB::IssueToOrderBook sourceMap;
     hash_set< Issue > XRPBooks;
+    hash_map< Book, int > bookRoots;
 
-    JLOG (j_.debug()) << "OrderBookDB::update>";
+    for (auto const& root : roots)
+    {
+        if (++bookRoots[root.second] == 1)
+            insertBook (sourceMap, destMap, XRPBooks, root.second);
+    }
 
-    if (app_.config().PATH_SEARCH_MAX == 0)
+    JLOG (j_.debug())
+        << "OrderBookDB::update< " << bookRoots.size () << " books found";
     {
-        // pathfinding has been disabled
-        return;
+        std::lock_guard <std::recursive_mutex> sl (mLock);
+
+        mXRPBooks.swap(XRPBooks);
+        mSourceMap.swap(sourceMap);
+        mDestMap.swap(destMap);
+        mRoots.swap(roots);
+        mBookRoots.swap(bookRoots);
+        mSeq = ledger->info().seq;
+        mUpdating = false;
+
+        // Catch up with the ledgers published during the scan. After
+        // a gap, the next ledger published starts another scan.
+        for (auto const& pending : mPending)
+        {
+            if (pending.first <= mSeq)
+                continue;
+            if (pending.first != mSeq + 1)
+                break;
+            applyDelta (pending.second);
+            mSeq = pending.first;
+        }
+        mPending.clear ();
+        abandon.active = false;
     }
+    app_.getLedgerMaster().newOrderBookDB();
+}
 
-    // walk through the entire ledger looking for orderbook entries
-    int books = 0;
+bool OrderBookDB::scan (ReadView const& ledger, RootMap& roots)
+{
+    std::atomic <bool> missing (false);
+    std::mutex mutex;
 
-    try
-    {
-        for(auto& sle : ledger->sles)
+    // Each index covers the keys which start with that byte value
+    app_.getJobQueue().parallelFor (jtUPDATE_PF, "OrderBookDB::scan",
+        256, scanJobs,
+        [&](std::size_t i)
         {
-            if (sle->getType () == ltDIR_NODE &&
-                sle->isFieldPresent (sfExchangeRate) &&
-                sle->getFieldH256 (sfRootIndex) == sle->key())
+            if (missing)
+                return;
+
+            auto iter = ledger.sles.begin ();
+            if (i != 0)
             {
-                Book book;
-                book.in.currency.copyFrom(sle->getFieldH160(
-                    sfTakerPaysCurrency));
-                book.in.account.copyFrom(sle->getFieldH160 (
-                    sfTakerPaysIssuer));
-                book.out.account.copyFrom(sle->getFieldH160(
-                    sfTakerGetsIssuer));
-                book.out.currency.copyFrom (sle->getFieldH160(
-                    sfTakerGetsCurrency));
-
-                uint256 index = getBookBase (book);
-                if (seen.insert (index).second)
+                // Start after the last key of the previous range
+                uint256 last;
+                std::fill (last.begin (), last.end (), 0xff);
+                *last.begin () = static_cast <unsigned char> (i - 1);
+                iter = ledger.sles.upper_bound (last);
+            }
+
+            RootMap found;
+            try
+            {
+                for (; iter != ledger.sles.end (); ++iter)
                 {
-                    auto orderBook = std::make_shared<OrderBook> (index, book);
-                    sourceMap[book.in].push_back (orderBook);
-                    destMap[book.out].push_back (orderBook);
-                    if (isXRP(book.out))
-                        XRPBooks.insert(book.in);
-                    ++books;
+                    auto const sle = *iter;
+                    if (*sle->key().begin () != i)
+                        break;
+
+                    if (sle->getType () == ltDIR_NODE &&
+                        isBookRoot (*sle, sle->key()))
+                    {
+                        found.emplace (sle->key(), bookFromFields (*sle));
+                    }
                 }
             }
-        }
-    }
-    catch (const SHAMapMissingNode&)
+            catch (SHAMapMissingNode const&)
+            {
+                missing = true;
+                return;
+            }
+
+            std::lock_guard <std::mutex> lock (mutex);
+            roots.insert (found.begin (), found.end ());
+        });
+
+    if (missing)
     {
         JLOG (j_.info())
             << "OrderBookDB::update encountered a missing node";
-        std::lock_guard <std::recursive_mutex> sl (mLock);
-        mSeq = 0;
-        return;
+        return false;
     }
 
-    JLOG (j_.debug())
-        << "OrderBookDB::update< " << books << " books found";
+    return true;
+}
+
+void OrderBookDB::processLedger (AcceptedLedger const& accepted)
+{
+    if (app_.config().PATH_SEARCH_MAX == 0)
+        return;
+
+    auto const& ledger = accepted.getLedger ();
+    auto const seq = ledger->info().seq;
+    auto delta = getDelta (accepted);
+
     {
         std::lock_guard <std::recursive_mutex> sl (mLock);
 
-        mXRPBooks.swap(XRPBooks);
-        mSourceMap.swap(sourceMap);
-        mDestMap.swap(destMap);
+        if (mUpdating)
+        {
+            // Bound the backlog, a later gap starts another scan
+            if (mPending.size () < 256)
+                mPending.emplace (seq, std::move (delta));
+            return;
+        }
+
+        if (mSeq != 0)
+        {
+            // The books may already hold some of the changes of a ledger
+            // with the same sequence, applying them again does no harm.
+            if ((seq == mSeq) || (seq == mSeq + 1))
+            {
+                applyDelta (delta);
+                mSeq = seq;
+                return;
+            }
+
+            if (seq < mSeq)
+                return;
+        }
+
+        JLOG (j_.info())
+            << "Rebuilding order books at " << seq
+            << ", last seen " << mSeq;
+
+        mUpdating = true;
+        mPending.clear ();
     }
-    app_.getLedgerMaster().newOrderBookDB();
+
+    startUpdate (ledger);
+}
+
+OrderBookDB::Delta OrderBookDB::getDelta (AcceptedLedger const& accepted)
+{
+    Delta delta;
+
+    // Transactions which only claim a fee can still remove
+    // offers, and with them the directories which held them.
+    for (auto const& item : accepted.getMap ())
+    {
+        for (auto const& node : item.second->getMeta ()->getNodes ())
+        {
+            if (node.getFieldU16 (sfLedgerEntryType) != ltDIR_NODE)
+                continue;
+
+            auto const key = node.getFieldH256 (sfLedgerIndex);
+
+            if (node.getFName () == sfDeletedNode)
+            {
+                delta.push_back ({key, boost::none});
+            }
+            else if (node.getFName () == sfCreatedNode)
+            {
+                auto const fields = dynamic_cast<const STObject*> (
+                    node.peekAtPField (sfNewFields));
+
+                if (fields && isBookRoot (*fields, key))
+                    delta.push_back ({key, bookFromFields (*fields)});
+            }
+        }
+    }
+
+    return delta;
+}
+
+void OrderBookDB::applyDelta (Delta const& delta)
+{
+    for (auto const& change : delta)
+    {
+        if (change.book)
+        {
+            if (mRoots.emplace (change.key, *change.book).second &&
+                ++mBookRoots[*change.book] == 1)
+            {
+                rawAddBook (*change.book);
+            }
+            continue;
+        }
+
+        // Only the roots of quality directories are tracked
+        auto const iter = mRoots.find (change.key);
+        if (iter == mRoots.end ())
+            continue;
+
+        auto const book = iter->second;
+        mRoots.erase (iter);
+
+        auto const count = mBookRoots.find (book);
+        assert (count != mBookRoots.end ());
+        if (--count->second == 0)
+        {
+            mBookRoots.erase (count);
+            rawRemoveBook (book);
+        }
+    }
+}
+
+void OrderBookDB::rawAddBook (Book const& book)
+{
+    // addOrderBook may have added it already
+    auto const& source = mSourceMap[book.in];
+    auto const& dest = mDestMap[book.out];
+    for (auto const& ob : (source.size () < dest.size ()) ? source : dest)
+    {
+        if (ob->book () == book)
+            return;
+    }
+
+    insertBook (mSourceMap, mDestMap, mXRPBooks, book);
+}
+
+void OrderBookDB::rawRemoveBook (Book const& book)
+{
+    auto const remove = [&book] (IssueToOrderBook& map, Issue const& issue)
+    {
+        auto const iter = map.find (issue);
+        if (iter == map.end ())
+            return;
+
+        auto& books = iter->second;
+        books.erase (std::remove_if (books.begin (), books.end (),
+            [&book] (OrderBook::pointer const& ob)
+            {
+                return ob->book () == book;
+            }), books.end ());
+
+        if (books.empty ())
+            map.erase (iter);
+    };
+
+    remove (mSourceMap, book.in);
+    remove (mDestMap, book.out);
+
+    // There is only one book from an issue to XRP
+    if (isXRP (book.out))
+        mXRPBooks.erase (book.in);
 }
 
 void OrderBookDB::addOrderBook(Book const& book)
@@ -236,9 +513,12 @@ BookListeners::pointer OrderBookDB::getBookListeners (Book const& book)
 // We need to determine which streams a given meta effects.
 void OrderBookDB::processTxn (
     std::shared_ptr<ReadView const> const& ledger,
-        const AcceptedLedgerTx& alTx, Json::Value const& jvObj)
+        const AcceptedLedgerTx& alTx,
+        std::shared_ptr<InfoSub::Message const> const& message)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    // The books are looked up first and published to afterwards,
+    // so that sending to subscribers never holds mLock.
+    std::vector<BookListeners::pointer> affected;
 
     if (alTx.getResult () == tesSUCCESS)
     {
@@ -277,7 +557,7 @@ void OrderBookDB::processTxn (
                                  data->getFieldAmount (sfTakerPays).issue()});
 
                             if (listeners)
-                                listeners->publish (jvObj);
+                                affected.push_back (std::move (listeners));
                         }
                     }
                 }
@@ -289,6 +569,9 @@ void OrderBookDB::processTxn (
             }
         }
     }
+
+    for (auto const& listeners : affected)
+        listeners->publish (message);
 }
 
 } // ripple
@@ -20,22 +20,44 @@
 #ifndef RIPPLE_APP_LEDGER_ORDERBOOKDB_H_INCLUDED
 #define RIPPLE_APP_LEDGER_ORDERBOOKDB_H_INCLUDED
 
+#include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/AcceptedLedgerTx.h>
 #include <ripple/app/ledger/BookListeners.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/OrderBook.h>
+#include <boost/optional.hpp>
+#include <map>
 #include <mutex>
+#include <vector>
 
 namespace ripple {
 
+/** Tracks the order books present in the ledger.
+
+    The books are found by a full scan of a ledger at startup, or when
+    a published ledger does not follow the last one seen. After that
+    they are kept current from the metadata of each published ledger,
+    which records the creation and deletion of book directories.
+*/
 class OrderBookDB
     : public Stoppable
 {
 public:
     OrderBookDB (Application& app, Stoppable& parent);
 
+    /** Rebuild the books from the ledger unless they already reflect it. */
     void setup (std::shared_ptr<ReadView const> const& ledger);
+
+    /** Rebuild the books with a full scan of the ledger. */
     void update (std::shared_ptr<ReadView const> const& ledger);
+
+    /** Apply the book directory changes of a published ledger.
+
+        If the ledger does not follow the last one applied, the books
+        are rebuilt from it instead.
+    */
+    void processLedger (AcceptedLedger const& ledger);
+
     void invalidate ();
 
     void addOrderBook(Book const&);
@@ -56,12 +78,32 @@ public:
     // see if this txn effects any orderbook
     void processTxn (
         std::shared_ptr<ReadView const> const& ledger,
-        const AcceptedLedgerTx& alTx, Json::Value const& jvObj);
+        const AcceptedLedgerTx& alTx,
+        std::shared_ptr<InfoSub::Message const> const& message);
 
     using IssueToOrderBook = hash_map <Issue, OrderBook::List>;
 
 private:
+    // A book directory root created (with its book) or deleted
+    struct RootChange
+    {
+        uint256 key;
+        boost::optional<Book> book;
+    };
+
+    using Delta = std::vector<RootChange>;
+
+    // The root of every quality directory, and the book it belongs to
+    using RootMap = hash_map <uint256, Book>;
+
+    static Delta getDelta (AcceptedLedger const& ledger);
+
+    void applyDelta (Delta const& delta);
+    void startUpdate (std::shared_ptr<ReadView const> const& ledger);
+    bool scan (ReadView const& ledger, RootMap& roots);
+
     void rawAddBook(Book const&);
+    void rawRemoveBook(Book const&);
 
     Application& app_;
 
@@ -80,8 +122,19 @@ private:
 
     BookToListenersMap mListeners;
 
+    // The roots of the book directories, and how many each book has
+    RootMap mRoots;
+    hash_map <Book, int> mBookRoots;
+
+    // The sequence of the last ledger the books reflect, or zero
     std::uint32_t mSeq;
 
+    // Set while a full scan is running
+    bool mUpdating;
+
+    // Changes from ledgers published during a full scan, by sequence
+    std::map <std::uint32_t, Delta> mPending;
+
     beast::Journal j_;
 };
 
@@ -61,11 +61,36 @@ enum
 
     // Number of nodes to request blindly
     ,reqNodes = 8
+
+    // Number of peers a request for state nodes is spread across
+    ,splitPeersMax = 4
+
+    // Number of jobs that may process received data at once
+    ,dataJobsMax = 4
 };
 
 // millisecond for each ledger timeout
 auto constexpr ledgerAcquireTimeout = 2500ms;
 
+// Local reads for ledgers we need now jump ahead of history backfill
+static
+NodeStore::FetchPriority
+fetchPriority (InboundLedger::fcReason reason)
+{
+    switch (reason)
+    {
+    case InboundLedger::fcHISTORY:
+        return NodeStore::FetchPriority::low;
+    case InboundLedger::fcVALIDATION:
+    case InboundLedger::fcCURRENT:
+    case InboundLedger::fcCONSENSUS:
+        return NodeStore::FetchPriority::high;
+    default:
+        break;
+    }
+    return NodeStore::FetchPriority::normal;
+}
+
 InboundLedger::InboundLedger (
     Application& app, uint256 const& hash, std::uint32_t seq, fcReason reason, clock_type& clock)
     : PeerSet (app, hash, ledgerAcquireTimeout, clock,
@@ -77,7 +102,8 @@ InboundLedger::InboundLedger (
     , mByHash (true)
     , mSeq (seq)
     , mReason (reason)
-    , mReceiveDispatched (false)
+    , mReceiveJobs (0)
+    , mChosenPeerCount (-1)
 {
     JLOG (m_journal.trace()) <<
         "Acquiring ledger " << mHash;
@@ -609,10 +635,18 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
         {
             AccountStateSF filter(app_);
 
+            // When a peer has just replied, spread the next request
+            // across several peers so their replies arrive together
+            std::vector<std::shared_ptr<Peer>> peers;
+            if (reason == TriggerReason::reply)
+                peers = splitPeers (peer);
+            std::size_t const parts = std::max<std::size_t> (
+                peers.size (), 1);
+
             // Release the lock while we process the large state map
             sl.unlock();
             auto nodes = mLedger->stateMap().getMissingNodes (
-                missingNodesFind, &filter);
+                missingNodesFind * parts, &filter, fetchPriority (mReason));
             sl.lock();
 
             // Make sure nothing happened while we released the lock
@@ -632,7 +666,14 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
                 }
                 else
                 {
-                    filterNodes (nodes, reason);
+                    filterNodes (nodes, reason, parts);
+
+                    if (!nodes.empty () && (parts > 1))
+                    {
+                        tmGL.set_itype (protocol::liAS_NODE);
+                        sendSplit (tmGL, nodes, peers);
+                        return;
+                    }
 
                     if (!nodes.empty ())
                     {
@@ -683,7 +724,7 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
             TransactionStateSF filter(app_);
 
             auto nodes = mLedger->txMap().getMissingNodes (
-                missingNodesFind, &filter);
+                missingNodesFind, &filter, fetchPriority (mReason));
 
             if (nodes.empty ())
             {
@@ -735,9 +776,60 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
     }
 }
 
+/** Choose the peers to spread a request across
+    The peer that prompted the request comes first.
+    Call with a lock
+*/
+std::vector<std::shared_ptr<Peer>>
+InboundLedger::splitPeers (std::shared_ptr<Peer> const& peer)
+{
+    std::vector<std::shared_ptr<Peer>> ret;
+    if (peer)
+        ret.push_back (peer);
+
+    for (auto id : mPeers)
+    {
+        if (ret.size () >= splitPeersMax)
+            break;
+
+        if (peer && (id == peer->id ()))
+            continue;
+
+        if (auto p = app_.overlay ().findPeerByShortID (id))
+            ret.push_back (std::move (p));
+    }
+
+    return ret;
+}
+
+/** Request nodes from several peers, each getting its share
+    Call with a lock
+*/
+void InboundLedger::sendSplit (protocol::TMGetLedger const& request,
+    std::vector<std::pair<SHAMapNodeID, uint256>> const& nodes,
+    std::vector<std::shared_ptr<Peer>> const& peers)
+{
+    auto const groups = SHAMap::splitMissingNodes (nodes, peers.size ());
+
+    for (std::size_t i = 0; i < peers.size (); ++i)
+    {
+        if (groups[i].empty ())
+            continue;
+
+        protocol::TMGetLedger tmGL (request);
+        for (auto const& n : groups[i])
+            * (tmGL.add_nodeids ()) = n.first.getRawString ();
+
+        JLOG (m_journal.trace()) <<
+            "Sending AS node request (" <<
+            groups[i].size () << ") to " << peers[i]->id ();
+        sendRequest (tmGL, peers[i]);
+    }
+}
+
 void InboundLedger::filterNodes (
     std::vector<std::pair<SHAMapNodeID, uint256>>& nodes,
-    TriggerReason reason)
+    TriggerReason reason, std::size_t parts)
 {
     // Sort nodes so that the ones we haven't recently
     // requested come before the ones we have.
@@ -770,9 +862,9 @@ void InboundLedger::filterNodes (
         nodes.erase (dup, nodes.end());
     }
 
-    std::size_t const limit = (reason == TriggerReason::reply)
+    std::size_t const limit = parts * ((reason == TriggerReason::reply)
         ? reqNodesReply
-        : reqNodes;
+        : reqNodes);
 
     if (nodes.size () > limit)
         nodes.resize (limit);
@@ -887,7 +979,10 @@ bool InboundLedger::takeTxNode (const std::vector<SHAMapNodeID>& nodeIDs,
 }
 
 /** Process AS data received from a peer
-    Call with a lock
+    Call without a lock. Nodes below the root are added without
+    holding it, so replies from several peers can be added at the
+    same time. The root is only ever set under the lock, and other
+    nodes are only added once it has been seen there.
 */
 bool InboundLedger::takeAsNode (const std::vector<SHAMapNodeID>& nodeIDs,
     const std::vector< Blob >& data, SHAMapAddNode& san)
@@ -901,20 +996,27 @@ bool InboundLedger::takeAsNode (const std::vector<SHAMapNodeID>& nodeIDs,
             "got AS node: " << nodeIDs.front ();
     }
 
-    ScopedLockType sl (mLock);
-
-    if (!mHaveHeader)
+    std::shared_ptr<Ledger> ledger;
+    bool haveRoot;
     {
-        JLOG (m_journal.warn()) <<
-            "Don't have ledger header";
-        san.incInvalid();
-        return false;
-    }
+        ScopedLockType sl (mLock);
 
-    if (mHaveState || mFailed)
-    {
-        san.incDuplicate();
-        return true;
+        if (!mHaveHeader)
+        {
+            JLOG (m_journal.warn()) <<
+                "Don't have ledger header";
+            san.incInvalid();
+            return false;
+        }
+
+        if (mHaveState || mFailed)
+        {
+            san.incDuplicate();
+            return true;
+        }
+
+        ledger = mLedger;
+        haveRoot = ledger->stateMap().getHash ().isNonZero ();
     }
 
     auto nodeIDit = nodeIDs.cbegin ();
@@ -925,18 +1027,36 @@ bool InboundLedger::takeAsNode (const std::vector<SHAMapNodeID>& nodeIDs,
     {
         if (nodeIDit->isRoot ())
         {
-            san += mLedger->stateMap().addRootNode (
-                SHAMapHash{mLedger->info().accountHash}, makeSlice(*nodeDatait), snfWIRE, &tFilter);
+            ScopedLockType sl (mLock);
+            san += ledger->stateMap().addRootNode (
+                SHAMapHash{ledger->info().accountHash}, makeSlice(*nodeDatait), snfWIRE, &tFilter);
             if (!san.isGood ())
             {
                 JLOG (m_journal.warn()) <<
                     "Bad ledger header";
                 return false;
             }
+            haveRoot = true;
         }
         else
         {
-            san += mLedger->stateMap().addKnownNode (
+            if (!haveRoot)
+            {
+                // Another job may have added it since we looked
+                ScopedLockType sl (mLock);
+                haveRoot = ledger->stateMap().getHash ().isNonZero ();
+            }
+
+            if (!haveRoot)
+            {
+                // Nothing can hang below a root we don't have
+                JLOG (m_journal.warn()) <<
+                    "Unable to add AS node without root";
+                san.incInvalid();
+                return false;
+            }
+
+            san += ledger->stateMap().addKnownNode (
                 *nodeIDit, makeSlice(*nodeDatait), &tFilter);
             if (!san.isGood ())
             {
@@ -950,7 +1070,10 @@ bool InboundLedger::takeAsNode (const std::vector<SHAMapNodeID>& nodeIDs,
         ++nodeDatait;
     }
 
-    if (!mLedger->stateMap().isSynching ())
+    ScopedLockType sl (mLock);
+
+    // Another job may have finished the state map first
+    if (!mHaveState && !mFailed && !ledger->stateMap().isSynching ())
     {
         mHaveState = true;
 
@@ -1059,10 +1182,12 @@ bool InboundLedger::gotData (std::weak_ptr<Peer> peer,
 
     mReceivedData.emplace_back (peer, data);
 
-    if (mReceiveDispatched)
+    // Bring in another job while each one running has a backlog
+    if ((mReceiveJobs >= dataJobsMax) ||
+            (mReceivedData.size () <= std::size_t (mReceiveJobs)))
         return false;
 
-    mReceiveDispatched = true;
+    ++mReceiveJobs;
     return true;
 }
 
@@ -1077,10 +1202,10 @@ bool InboundLedger::gotData (std::weak_ptr<Peer> peer,
 int InboundLedger::processData (std::shared_ptr<Peer> peer,
     protocol::TMLedgerData& packet)
 {
-    ScopedLockType sl (mLock);
-
     if (packet.type () == protocol::liBASE)
     {
+        ScopedLockType sl (mLock);
+
         if (packet.nodes_size () < 1)
         {
             JLOG (m_journal.warn()) <<
@@ -1164,6 +1289,7 @@ int InboundLedger::processData (std::shared_ptr<Peer> peer,
 
         if (packet.type () == protocol::liTX_NODE)
         {
+            ScopedLockType sl (mLock);
             takeTxNode (nodeIDs, nodeData, san);
             JLOG (m_journal.debug()) <<
                 "Ledger TX node stats: " << san.get();
@@ -1175,6 +1301,7 @@ int InboundLedger::processData (std::shared_ptr<Peer> peer,
                 "Ledger AS node stats: " << san.get();
         }
 
+        ScopedLockType sl (mLock);
         if (san.isUseful ())
             progress ();
 
@@ -1187,41 +1314,48 @@ int InboundLedger::processData (std::shared_ptr<Peer> peer,
 
 /** Process pending TMLedgerData
     Query the 'best' peer
+
+    Several jobs may run this at once, each taking one reply at a
+    time, so replies from different peers are added in parallel.
+    The last job to run out of work sends the one follow-up request,
+    to the peer whose reply was most useful across all the jobs.
 */
 void InboundLedger::runData ()
 {
     std::shared_ptr<Peer> chosenPeer;
-    int chosenPeerCount = -1;
-
-    std::vector <PeerDataPairType> data;
 
     for (;;)
     {
-        data.clear();
+        PeerDataPairType entry;
         {
             std::lock_guard<std::mutex> sl (mReceivedDataLock);
 
             if (mReceivedData.empty ())
             {
-                mReceiveDispatched = false;
+                if (--mReceiveJobs == 0)
+                {
+                    chosenPeer = std::move (mChosenPeer);
+                    mChosenPeer.reset ();
+                    mChosenPeerCount = -1;
+                }
                 break;
             }
 
-            data.swap(mReceivedData);
+            entry = std::move (mReceivedData.front ());
+            mReceivedData.pop_front ();
         }
 
         // Select the peer that gives us the most nodes that are useful,
-        // breaking ties in favor of the peer that responded first.
-        for (auto& entry : data)
+        // breaking ties in favor of the peer whose reply finished first.
+        if (auto peer = entry.first.lock())
         {
-            if (auto peer = entry.first.lock())
+            int count = processData (peer, *(entry.second));
+
+            std::lock_guard<std::mutex> sl (mReceivedDataLock);
+            if (count > mChosenPeerCount)
             {
-                int count = processData (peer, *(entry.second));
-                if (count > chosenPeerCount)
-                {
-                    chosenPeerCount = count;
-                    chosenPeer = std::move (peer);
-                }
+                mChosenPeerCount = count;
+                mChosenPeer = std::move (peer);
             }
         }
     }
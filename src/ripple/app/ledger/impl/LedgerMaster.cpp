@@ -1505,6 +1505,12 @@ LedgerMaster::tune (int size, int age)
     mLedgerHistory.tune (size, age);
 }
 
+void
+LedgerMaster::setCacheBudget (CacheBudget& budget)
+{
+    mLedgerHistory.setCacheBudget (budget);
+}
+
 void
 LedgerMaster::sweep ()
 {
@@ -1779,6 +1785,29 @@ LedgerMaster::addFetchPack (
     fetch_packs_.canonicalize (hash, data);
 }
 
+std::size_t
+LedgerMaster::addFetchPack (
+    std::vector<FetchPackEntry>& entries)
+{
+    std::vector<Slice> messages;
+    messages.reserve (entries.size ());
+    for (auto const& entry : entries)
+        messages.push_back (makeSlice (*entry.second));
+
+    std::vector<uint256> digests (entries.size ());
+    sha512HalfBatch (messages.data (), messages.size (), digests.data ());
+
+    std::size_t bad = 0;
+    for (std::size_t i = 0; i < entries.size (); ++i)
+    {
+        if (digests[i] == entries[i].first)
+            fetch_packs_.canonicalize (entries[i].first, entries[i].second);
+        else
+            ++bad;
+    }
+    return bad;
+}
+
 bool
 LedgerMaster::getFetchPack (
     uint256 const& hash,
@@ -1789,7 +1818,8 @@ LedgerMaster::getFetchPack (
 
     fetch_packs_.del (hash, false);
 
-    return hash == sha512Half(makeSlice(data));
+    // The entries were checked against their hashes when added
+    return true;
 }
 
 void
@@ -154,7 +154,9 @@ void TransactionAcquire::trigger (std::shared_ptr<Peer> const& peer)
     else
     {
         ConsensusTransSetSF sf (app_, app_.getTempNodeCache ());
-        auto nodes = mMap->getMissingNodes (256, &sf);
+        // Consensus is waiting on this set
+        auto nodes = mMap->getMissingNodes (256, &sf,
+            NodeStore::FetchPriority::high);
 
         if (nodes.empty ())
         {
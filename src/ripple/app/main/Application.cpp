@@ -129,13 +129,18 @@ public:
             CollectorManager& collectorManager)
         : app_ (app)
         , treecache_ ("TreeNodeCache", 65536, 60, stopwatch(),
-            app.journal("TaggedCache"))
+            app.journal("TaggedCache"), beast::insight::NullCollector::New (),
+                treeCachePartitions)
         , fullbelow_ ("full_below", stopwatch(),
             collectorManager.collector(),
                 fullBelowTargetSize, fullBelowExpirationSeconds)
         , db_ (db)
         , j_ (app.journal("SHAMap"))
     {
+        treecache_.setCostFunction ([](SHAMapAbstractNode const& node)
+            {
+                return node.getMemoryUsage ();
+            });
     }
 
     beast::Journal const&
@@ -224,6 +229,14 @@ public:
     {
         acquire (hash, 0);
     }
+
+    void
+    parallelFor (std::size_t count, int jobs,
+        std::function <void(std::size_t)> const& f) override
+    {
+        app_.getJobQueue ().parallelFor (
+            jtACCEPT, "SHAMap::flush", count, jobs, f);
+    }
 };
 
 
@@ -317,6 +330,9 @@ public:
     beast::Journal m_journal;
     Application::MutexType m_masterMutex;
 
+    // Shared by the caches below, so it must outlive them
+    CacheBudget cacheBudget_;
+
     // Required by the SHAMapStore
     TransactionMaster m_txMaster;
 
@@ -665,6 +681,12 @@ public:
         return cachedSLEs_;
     }
 
+    CacheBudget&
+    getCacheBudget () override
+    {
+        return cacheBudget_;
+    }
+
     AmendmentTable& getAmendmentTable() override
     {
         return *m_amendmentTable;
@@ -766,6 +788,9 @@ public:
                 TxnDBInit, TxnDBCount);
         mLedgerDB = std::make_unique <DatabaseCon> (setup, "ledger.db",
                 LedgerDBInit, LedgerDBCount);
+
+        // The wallet database is only read at startup.
+        setup.readers = 0;
         mWalletDB = std::make_unique <DatabaseCon> (setup, "wallet.db",
                 WalletDBInit, WalletDBCount);
 
@@ -897,6 +922,14 @@ public:
         // VFALCO TODO fix the dependency inversion using an observer,
         //         have listeners register for "onSweep ()" notification.
 
+        // Measure the caches first so that they all sweep
+        // against the same memory pressure.
+        auto const cacheBytes = cacheBudget_.update ();
+        JLOG(m_journal.debug()) <<
+            "Caches hold " << cacheBytes << " of " <<
+            cacheBudget_.getBudget () << " bytes, age scale " <<
+            cacheBudget_.getScale ();
+
         family().fullbelow().sweep ();
         getMasterTransaction().sweep();
         getNodeStore().sweep();
@@ -1070,11 +1103,24 @@ bool ApplicationImp::setup()
         JLOG(m_journal.warn()) << "No validators are configured.";
     }
 
-    m_nodeStore->tune (config_->getSize (siNodeCacheSize), config_->getSize (siNodeCacheAge));
+    // An explicit memory budget replaces the entry limits of the
+    // node and tree caches. The ages still come from node_size.
+    bool const budgeted = config_->CACHE_BUDGET != 0;
+    cacheBudget_.setBudget ((budgeted ? config_->CACHE_BUDGET :
+        config_->getSize (siCacheBudget)) * 1024 * 1024);
+
+    m_nodeStore->tune (budgeted ? 0 : config_->getSize (siNodeCacheSize),
+        config_->getSize (siNodeCacheAge));
     m_ledgerMaster->tune (config_->getSize (siLedgerSize), config_->getSize (siLedgerAge));
-    family().treecache().setTargetSize (config_->getSize (siTreeCacheSize));
+    family().treecache().setTargetSize (budgeted ? 0 : config_->getSize (siTreeCacheSize));
     family().treecache().setTargetAge (config_->getSize (siTreeCacheAge));
 
+    m_nodeStore->setCacheBudget (cacheBudget_);
+    m_ledgerMaster->setCacheBudget (cacheBudget_);
+    family().treecache().setBudget (cacheBudget_);
+    family().fullbelow().setBudget (cacheBudget_);
+    cachedSLEs_.setBudget (cacheBudget_);
+
     //----------------------------------------------------------------------
     //
     // Server
@@ -113,6 +113,7 @@ public:
     virtual JobQueue&               getJobQueue () = 0;
     virtual NodeCache&              getTempNodeCache () = 0;
     virtual CachedSLEs&             cachedSLEs() = 0;
+    virtual CacheBudget&            getCacheBudget () = 0;
     virtual AmendmentTable&         getAmendmentTable() = 0;
     virtual HashRouter&             getHashRouter () = 0;
     virtual LoadFeeTrack&           getFeeTrack () = 0;
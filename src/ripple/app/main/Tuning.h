@@ -26,6 +26,9 @@ enum
 {
      fullBelowTargetSize = 524288
     ,fullBelowExpirationSeconds = 600
+
+    // Number of independently locked partitions in the TreeNodeCache
+    ,treeCachePartitions = 16
 };
 
 }
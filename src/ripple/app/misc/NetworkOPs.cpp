@@ -38,6 +38,7 @@
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/Transaction.h>
+#include <ripple/app/misc/SHAMapStore.h>
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/misc/Validations.h>
 #include <ripple/app/misc/ValidatorList.h>
@@ -507,6 +508,11 @@ private:
     using SubInfoMapType = hash_map <AccountID, SubMapType>;
     using subRpcMapType = hash_map<std::string, InfoSub::pointer>;
 
+    // Append the live subscribers in the map to `subs`, removing any
+    // which have gone away. The caller must hold mSubLock.
+    static void collectSubscribers (
+        SubMapType& subMap, std::vector<InfoSub::pointer>& subs);
+
     // XXX Split into more locks.
     using ScopedLockType = std::lock_guard <std::recursive_mutex>;
 
@@ -1787,15 +1793,20 @@ NetworkOPsImp::transactionsSQL (
             % beast::lexicalCastThrow <std::string> (numberOfResults)
         );
     else
+        // Skip to the page within AcctTxIndex alone, which covers the
+        // inner query, and only join the rows that are returned.
         sql =
             boost::str (boost::format (
                 "SELECT %s FROM "
-                "AccountTransactions INNER JOIN Transactions "
-                "ON Transactions.TransID = AccountTransactions.TransID "
+                "(SELECT LedgerSeq, TxnSeq, TransID "
+                "FROM AccountTransactions INDEXED BY AcctTxIndex "
                 "WHERE Account = '%s' %s %s "
+                "ORDER BY LedgerSeq %s, TxnSeq %s, TransID %s "
+                "LIMIT %u, %u) AS AccountTransactions "
+                "INNER JOIN Transactions "
+                "ON Transactions.TransID = AccountTransactions.TransID "
                 "ORDER BY AccountTransactions.LedgerSeq %s, "
-                "AccountTransactions.TxnSeq %s, AccountTransactions.TransID %s "
-                "LIMIT %u, %u;")
+                "AccountTransactions.TxnSeq %s, AccountTransactions.TransID %s;")
                     % selection
                     % app_.accountIDCache().toBase58(account)
                     % maxClause
@@ -1805,6 +1816,9 @@ NetworkOPsImp::transactionsSQL (
                     % (descending ? "DESC" : "ASC")
                     % beast::lexicalCastThrow <std::string> (offset)
                     % beast::lexicalCastThrow <std::string> (numberOfResults)
+                    % (descending ? "DESC" : "ASC")
+                    % (descending ? "DESC" : "ASC")
+                    % (descending ? "DESC" : "ASC")
                    );
     JLOG(m_journal.trace()) << "txSQL query: " << sql;
     return sql;
@@ -1824,7 +1838,7 @@ NetworkOPs::AccountTxs NetworkOPsImp::getAccountTxs (
         bUnlimited);
 
     {
-        auto db = app_.getTxnDB ().checkoutDb ();
+        auto db = app_.getTxnDB ().checkoutReadDb ();
 
         boost::optional<std::uint64_t> ledgerSeq;
         boost::optional<std::string> status;
@@ -1892,7 +1906,7 @@ std::vector<NetworkOPsImp::txnMetaLedgerType> NetworkOPsImp::getAccountTxsB (
         bUnlimited);
 
     {
-        auto db = app_.getTxnDB ().checkoutDb ();
+        auto db = app_.getTxnDB ().checkoutReadDb ();
 
         boost::optional<std::uint64_t> ledgerSeq;
         boost::optional<std::string> status;
@@ -2093,8 +2107,14 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin)
     //  info[jss::consensus] = mLedgerConsensus->getJson();
 
     if (admin)
+    {
         info[jss::load] = m_job_queue.getJson ();
 
+        auto rotation = app_.getSHAMapStore ().getJson ();
+        if (! rotation.isNull ())
+            info[jss::rotation] = std::move (rotation);
+    }
+
     auto const escalationMetrics = app_.getTxQ().getMetrics(
         app_.config(), *app_.openLedger().current());
 
@@ -2260,31 +2280,43 @@ Json::Value NetworkOPsImp::getLedgerFetchInfo ()
     return app_.getInboundLedgers().getInfo();
 }
 
+void NetworkOPsImp::collectSubscribers (
+    SubMapType& subMap, std::vector<InfoSub::pointer>& subs)
+{
+    auto it = subMap.begin ();
+    while (it != subMap.end ())
+    {
+        if (auto p = it->second.lock ())
+        {
+            subs.push_back (std::move (p));
+            ++it;
+        }
+        else
+        {
+            it = subMap.erase (it);
+        }
+    }
+}
+
 void NetworkOPsImp::pubProposedTransaction (
     std::shared_ptr<ReadView const> const& lpCurrent,
     std::shared_ptr<STTx const> const& stTxn, TER terResult)
 {
-    Json::Value jvObj   = transJson (*stTxn, terResult, false, lpCurrent);
-
+    std::vector<InfoSub::pointer> subs;
     {
         ScopedLockType sl (mSubLock);
+        collectSubscribers (mSubRTTransactions, subs);
+    }
 
-        auto it = mSubRTTransactions.begin ();
-        while (it != mSubRTTransactions.end ())
-        {
-            InfoSub::pointer p = it->second.lock ();
+    if (! subs.empty ())
+    {
+        auto const message = std::make_shared<InfoSub::Message const> (
+            transJson (*stTxn, terResult, false, lpCurrent));
 
-            if (p)
-            {
-                p->send (jvObj, true);
-                ++it;
-            }
-            else
-            {
-                it = mSubRTTransactions.erase (it);
-            }
-        }
+        for (auto const& p : subs)
+            p->send (message, true);
     }
+
     AcceptedLedgerTx alt (lpCurrent, stTxn, terResult,
         app_.accountIDCache(), app_.logs());
     JLOG(m_journal.trace()) << "pubProposed: " << alt.getJson ();
@@ -2307,46 +2339,43 @@ void NetworkOPsImp::pubLedger (
             lpAccepted->info().hash, alpAccepted);
     }
 
+    app_.getOrderBookDB ().processLedger (*alpAccepted);
+
+    std::vector<InfoSub::pointer> subs;
     {
         ScopedLockType sl (mSubLock);
+        collectSubscribers (mSubLedger, subs);
+    }
 
-        if (!mSubLedger.empty ())
-        {
-            Json::Value jvObj (Json::objectValue);
-
-            jvObj[jss::type] = "ledgerClosed";
-            jvObj[jss::ledger_index] = lpAccepted->info().seq;
-            jvObj[jss::ledger_hash] = to_string (lpAccepted->info().hash);
-            jvObj[jss::ledger_time]
-                    = Json::Value::UInt (lpAccepted->info().closeTime.time_since_epoch().count());
+    if (! subs.empty ())
+    {
+        Json::Value jvObj (Json::objectValue);
 
-            jvObj[jss::fee_ref]
-                    = Json::UInt (lpAccepted->fees().units);
-            jvObj[jss::fee_base] = Json::UInt (lpAccepted->fees().base);
-            jvObj[jss::reserve_base] = Json::UInt (lpAccepted->fees().accountReserve(0).drops());
-            jvObj[jss::reserve_inc] = Json::UInt (lpAccepted->fees().increment);
+        jvObj[jss::type] = "ledgerClosed";
+        jvObj[jss::ledger_index] = lpAccepted->info().seq;
+        jvObj[jss::ledger_hash] = to_string (lpAccepted->info().hash);
+        jvObj[jss::ledger_time]
+                = Json::Value::UInt (lpAccepted->info().closeTime.time_since_epoch().count());
 
-            jvObj[jss::txn_count] = Json::UInt (alpAccepted->getTxnCount ());
+        jvObj[jss::fee_ref]
+                = Json::UInt (lpAccepted->fees().units);
+        jvObj[jss::fee_base] = Json::UInt (lpAccepted->fees().base);
+        jvObj[jss::reserve_base] = Json::UInt (lpAccepted->fees().accountReserve(0).drops());
+        jvObj[jss::reserve_inc] = Json::UInt (lpAccepted->fees().increment);
 
-            if (mMode >= omSYNCING)
-            {
-                jvObj[jss::validated_ledgers]
-                        = app_.getLedgerMaster ().getCompleteLedgers ();
-            }
+        jvObj[jss::txn_count] = Json::UInt (alpAccepted->getTxnCount ());
 
-            auto it = mSubLedger.begin ();
-            while (it != mSubLedger.end ())
-            {
-                InfoSub::pointer p = it->second.lock ();
-                if (p)
-                {
-                    p->send (jvObj, true);
-                    ++it;
-                }
-                else
-                    it = mSubLedger.erase (it);
-            }
+        if (mMode >= omSYNCING)
+        {
+            jvObj[jss::validated_ledgers]
+                    = app_.getLedgerMaster ().getCompleteLedgers ();
         }
+
+        auto const message = std::make_shared<InfoSub::Message const> (
+            std::move (jvObj));
+
+        for (auto const& p : subs)
+            p->send (message, true);
     }
 
     // Don't lock since pubAcceptedTransaction is locking.
@@ -2431,39 +2460,21 @@ void NetworkOPsImp::pubValidatedTransaction (
         *alTx.getTxn (), alTx.getResult (), true, alAccepted);
     jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
 
+    // Rendered once, outside the lock, for all the streams
+    auto const message = std::make_shared<InfoSub::Message const> (
+        std::move (jvObj));
+
+    std::vector<InfoSub::pointer> subs;
     {
         ScopedLockType sl (mSubLock);
+        collectSubscribers (mSubTransactions, subs);
+        collectSubscribers (mSubRTTransactions, subs);
+    }
 
-        auto it = mSubTransactions.begin ();
-        while (it != mSubTransactions.end ())
-        {
-            InfoSub::pointer p = it->second.lock ();
-
-            if (p)
-            {
-                p->send (jvObj, true);
-                ++it;
-            }
-            else
-                it = mSubTransactions.erase (it);
-        }
-
-        it = mSubRTTransactions.begin ();
-
-        while (it != mSubRTTransactions.end ())
-        {
-            InfoSub::pointer p = it->second.lock ();
+    for (auto const& p : subs)
+        p->send (message, true);
 
-            if (p)
-            {
-                p->send (jvObj, true);
-                ++it;
-            }
-            else
-                it = mSubRTTransactions.erase (it);
-        }
-    }
-    app_.getOrderBookDB ().processTxn (alAccepted, alTx, jvObj);
+    app_.getOrderBookDB ().processTxn (alAccepted, alTx, message);
     pubAccountTransaction (alAccepted, alTx, true);
 }
 
@@ -2543,8 +2554,11 @@ void NetworkOPsImp::pubAccountTransaction (
         if (alTx.isApplied ())
             jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
 
+        auto const message = std::make_shared<InfoSub::Message const> (
+            std::move (jvObj));
+
         for (InfoSub::ref isrListener : notify)
-            isrListener->send (jvObj, true);
+            isrListener->send (message, true);
     }
 }
 
@@ -22,6 +22,7 @@
 
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/core/Config.h>
+#include <ripple/json/json_value.h>
 #include <ripple/nodestore/Manager.h>
 #include <ripple/nodestore/Scheduler.h>
 #include <ripple/protocol/ErrorCodes.h>
@@ -78,6 +79,11 @@ public:
 
     /** The number of files that are needed. */
     virtual int fdlimit() const = 0;
+
+    /** Progress of the state copy made by the latest rotation.
+        Null if no rotation has started.
+    */
+    virtual Json::Value getJson() const = 0;
 };
 
 //------------------------------------------------------------------------------
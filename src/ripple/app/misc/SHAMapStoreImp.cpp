@@ -26,6 +26,7 @@
 #include <ripple/basics/contract.h>
 #include <ripple/core/ConfigSections.h>
 #include <ripple/core/ThreadEntry.h>
+#include <ripple/protocol/JsonFields.h>
 #include <boost/format.hpp>
 #include <boost/format.hpp>
 #include <boost/optional.hpp>
@@ -280,19 +281,210 @@ SHAMapStoreImp::fdlimit () const
     return fdlimit_;
 }
 
+Json::Value
+SHAMapStoreImp::getJson() const
+{
+    std::lock_guard <std::mutex> lock (copyMutex_);
+    if (copyState_ == copyNone)
+        return Json::nullValue;
+
+    auto const elapsed = std::chrono::duration_cast<
+        std::chrono::microseconds> (copyState_ == copyRunning ?
+            std::chrono::steady_clock::now() - copyStart_ : copyElapsed_);
+    auto const present = nodesPresent_.load();
+    auto const written = nodesWritten_.load();
+
+    Json::Value ret (Json::objectValue);
+    ret[jss::ledger_index] = copySeq_;
+    switch (copyState_)
+    {
+        case copyRunning:
+            ret[jss::state] = "copying";
+            break;
+        case copyDone:
+            ret[jss::state] = "complete";
+            break;
+        default:
+            ret[jss::state] = "abandoned";
+    }
+    ret[jss::nodes_present] = Json::UInt (present);
+    ret[jss::nodes_written] = Json::UInt (written);
+    ret[jss::duration_us] = std::to_string (elapsed.count());
+    if (elapsed.count() > 0)
+        ret[jss::nodes_per_second] = Json::UInt (
+            (present + written) * 1000000 / elapsed.count());
+    return ret;
+}
+
 bool
-SHAMapStoreImp::copyNode (std::uint64_t& nodeCount,
-        SHAMapAbstractNode const& node)
+SHAMapStoreImp::copyState (Ledger const& ledger)
 {
-    // Copy a single record from node to database_
-    database_->fetchNode (node.getNodeHash().as_uint256());
-    if (! (++nodeCount % checkHealthInterval_))
     {
-        if (health())
-            return true;
+        std::lock_guard <std::mutex> lock (copyMutex_);
+        copySeq_ = ledger.info().seq;
+        copyState_ = copyRunning;
+        copyStart_ = std::chrono::steady_clock::now();
+    }
+    nodesPresent_ = 0;
+    nodesWritten_ = 0;
+
+    // Copy the root here, then hand its branches out
+    NodeStore::Batch batch;
+    std::vector<uint256> branches;
+    std::atomic<bool> abandon {false};
+    bool copied = true;
+
+    try
+    {
+        if (ledger.info().accountHash.isNonZero())
+            copied = copyNodes ({ledger.info().accountHash},
+                batch, branches);
+        writeBatch (batch);
+
+        if (copied && ! branches.empty())
+        {
+            app_.getJobQueue().parallelFor (jtSWEEP, "SHAMapStore::copy",
+                branches.size(), copyJobs_,
+                [&](std::size_t i)
+                {
+                    if (! copyBranch (branches[i], abandon))
+                        abandon = true;
+                });
+            copied = ! abandon;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(journal_.error()) << "copying ledger " << ledger.info().seq
+            << ": " << e.what();
+        copied = false;
     }
 
-    return false;
+    std::lock_guard <std::mutex> lock (copyMutex_);
+    copyState_ = copied ? copyDone : copyAbandoned;
+    copyElapsed_ = std::chrono::steady_clock::now() - copyStart_;
+    return copied;
+}
+
+bool
+SHAMapStoreImp::copyBranch (uint256 const& hash, std::atomic<bool>& abandon)
+{
+    NodeStore::Batch batch;
+    batch.reserve (copyBatch_);
+    std::vector<uint256> pending {hash};
+    std::vector<uint256> hashes;
+    std::uint64_t nodeCount = 0;
+
+    // Depth first, a group of nodes at a time, to bound the pending list
+    while (! pending.empty())
+    {
+        if (abandon)
+            return false;
+
+        auto const n = std::min (pending.size(), copyBatch_);
+        hashes.assign (pending.end() - n, pending.end());
+        pending.resize (pending.size() - n);
+
+        if (! copyNodes (hashes, batch, pending))
+            return false;
+
+        if (batch.size() >= copyBatch_)
+            writeBatch (batch);
+
+        if ((nodeCount + n) / checkHealthInterval_ !=
+                nodeCount / checkHealthInterval_ && health())
+            return false;
+        nodeCount += n;
+    }
+
+    writeBatch (batch);
+    return true;
+}
+
+bool
+SHAMapStoreImp::copyNodes (std::vector<uint256> const& hashes,
+    NodeStore::Batch& batch, std::vector<uint256>& children)
+{
+    auto const& writable = database_->getWritableBackend();
+    auto const& archive = database_->getArchiveBackend();
+
+    std::vector<void const*> keys;
+    keys.reserve (hashes.size());
+    for (auto const& hash : hashes)
+        keys.push_back (hash.begin());
+    auto objects = writable->fetchBatch (keys.size(), keys.data());
+
+    std::vector<std::size_t> missing;
+    for (std::size_t i = 0; i < objects.size(); ++i)
+    {
+        if (objects[i])
+            ++nodesPresent_;
+        else
+            missing.push_back (i);
+    }
+
+    if (! missing.empty())
+    {
+        keys.clear();
+        for (auto const i : missing)
+            keys.push_back (hashes[i].begin());
+        auto archived = archive->fetchBatch (keys.size(), keys.data());
+
+        for (std::size_t j = 0; j < missing.size(); ++j)
+        {
+            auto& object = objects[missing[j]];
+            if (archived[j])
+            {
+                object = std::move (archived[j]);
+                batch.push_back (object);
+                ++nodesWritten_;
+                continue;
+            }
+
+            // Recently stored nodes may still be waiting to be written
+            object = database_->getPositiveCache().fetch (
+                hashes[missing[j]]);
+            if (! object)
+            {
+                JLOG(journal_.warn()) << "copy missing node "
+                    << hashes[missing[j]];
+                return false;
+            }
+            ++nodesPresent_;
+        }
+    }
+
+    for (std::size_t i = 0; i < objects.size(); ++i)
+    {
+        auto const node = SHAMapAbstractNode::make (
+            makeSlice (objects[i]->getData()), 0, snfPREFIX,
+                SHAMapHash {hashes[i]}, true, journal_);
+        if (! node->isInner())
+            continue;
+
+        auto const& inner = static_cast<SHAMapInnerNode const&> (*node);
+        for (int branch = 0; branch < 16; ++branch)
+        {
+            if (! inner.isEmptyBranch (branch))
+                children.push_back (
+                    inner.getChildHash (branch).as_uint256());
+        }
+    }
+
+    return true;
+}
+
+void
+SHAMapStoreImp::writeBatch (NodeStore::Batch& batch)
+{
+    if (batch.empty())
+        return;
+
+    {
+        std::lock_guard <std::mutex> lock (writeMutex_);
+        database_->getWritableBackend()->storeBatch (batch);
+    }
+    batch.clear();
 }
 
 void
@@ -379,13 +571,11 @@ SHAMapStoreImp::runImpl()
                     ;
             }
 
-            std::uint64_t nodeCount = 0;
-            validatedLedger->stateMap().snapShot (
-                    false)->visitNodes (
-                    std::bind (&SHAMapStoreImp::copyNode, this,
-                    std::ref(nodeCount), std::placeholders::_1));
+            if (! copyState (*validatedLedger))
+                healthy_ = false;
             JLOG(journal_.debug()) << "copied ledger " << validatedSeq
-                    << " nodecount " << nodeCount;
+                    << " nodes written " << nodesWritten_.load()
+                    << " present " << nodesPresent_.load();
             switch (health())
             {
                 case Health::stopping:
@@ -27,6 +27,8 @@
 #include <ripple/nodestore/impl/Tuning.h>
 #include <ripple/nodestore/DatabaseRotating.h>
 #include <iostream>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <thread>
 
@@ -50,6 +52,14 @@ private:
         unhealthy
     };
 
+    enum CopyState : std::uint8_t
+    {
+        copyNone = 0,
+        copyRunning,
+        copyDone,
+        copyAbandoned
+    };
+
     class SavedStateDB
     {
     public:
@@ -79,6 +89,10 @@ private:
     std::string const dbPrefix_ = "rippledb";
     // check health/stop status as records are copied
     std::uint64_t const checkHealthInterval_ = 1000;
+    // most threads, this one included, copying the state map
+    int const copyJobs_ = 4;
+    // nodes read from, and written to, a backend at once while copying
+    std::size_t const copyBatch_ = 256;
     // minimum # of ledgers to maintain for health of network
     static std::uint32_t const minimumDeletionInterval_ = 256;
     // minimum # of ledgers required for standalone mode.
@@ -92,7 +106,7 @@ private:
     SavedStateDB state_db_;
     std::thread thread_;
     bool stop_ = false;
-    bool healthy_ = true;
+    std::atomic<bool> healthy_ {true};
     mutable std::condition_variable cond_;
     mutable std::condition_variable rendezvous_;
     mutable std::mutex mutex_;
@@ -110,6 +124,16 @@ private:
     DatabaseCon* ledgerDb_ = nullptr;
     int fdlimit_ = 0;
 
+    // progress of the latest state copy
+    mutable std::mutex copyMutex_;
+    std::mutex writeMutex_;
+    LedgerIndex copySeq_ = 0;
+    CopyState copyState_ = copyNone;
+    std::chrono::steady_clock::time_point copyStart_;
+    std::chrono::steady_clock::duration copyElapsed_ {};
+    std::atomic<std::uint64_t> nodesPresent_ {0};
+    std::atomic<std::uint64_t> nodesWritten_ {0};
+
 public:
     SHAMapStoreImp (Application& app,
             Setup const& setup,
@@ -170,10 +194,25 @@ public:
 
     void rendezvous() const override;
     int fdlimit() const override;
+    Json::Value getJson() const override;
 
 private:
-    // callback for visitNodes
-    bool copyNode (std::uint64_t& nodeCount, SHAMapAbstractNode const &node);
+    /** Copy the state map of a ledger into the writable backend.
+
+        The branches of the root are copied in parallel. Nodes already
+        in the writable backend are not written again, but their
+        children are still visited: a node written by a later ledger
+        says nothing about the subtree below it, which may still be
+        held only by the archive.
+
+        @return `false` if the copy was abandoned.
+    */
+    bool copyState (Ledger const& ledger);
+    bool copyBranch (uint256 const& hash, std::atomic<bool>& abandon);
+    // copy a group of nodes, adding the hashes of their children
+    bool copyNodes (std::vector<uint256> const& hashes,
+        NodeStore::Batch& batch, std::vector<uint256>& children);
+    void writeBatch (NodeStore::Batch& batch);
     void run();
     void runImpl();
     void dbPaths();
@@ -23,13 +23,17 @@
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/LedgerTiming.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/app/main/CollectorManager.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/ValidatorList.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/basics/chrono.h>
+#include <ripple/core/ConfigSections.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/core/TimeKeeper.h>
+#include <boost/optional.hpp>
+#include <algorithm>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -50,6 +54,33 @@ private:
     ValidationSet mCurrentValidations;
     std::vector<STValidation::pointer> mStaleValidations;
 
+    // Stale validations are written when this many are waiting,
+    // or when this long has passed since the last write.
+    std::size_t writeBatch_ = 256;
+    std::chrono::seconds writeInterval_ {10};
+    Stopwatch::time_point lastWrite_;
+
+    // The statements used to write validations, prepared on the
+    // ledger database once and rebound for each row.
+    struct Writer : DatabaseCon::Prepared
+    {
+        std::string ledgerHash;
+        boost::optional<std::uint64_t> ledgerSeq;
+        std::uint64_t initialSeq = 0;
+        std::string nodePubKey;
+        std::uint64_t signTime = 0;
+        soci::blob rawData;
+
+        soci::statement findSeq;
+        soci::statement insert;
+
+        explicit
+        Writer (soci::session& session);
+    };
+
+    beast::insight::Counter mWritten;
+    beast::insight::Event mWriteTime;
+
     bool mWriting;
     beast::Journal j_;
 
@@ -78,10 +109,23 @@ public:
         : app_ (app)
         , mValidations ("Validations", 4096, 600, stopwatch(),
             app.journal("TaggedCache"))
+        , lastWrite_ (stopwatch().now())
         , mWriting (false)
         , j_ (app.journal ("Validations"))
     {
-        mStaleValidations.reserve (512);
+        auto const& section = app.config().section (SECTION_VALIDATION_WRITE);
+        get_if_exists (section, "batch_size", writeBatch_);
+        writeBatch_ = std::max<std::size_t> (writeBatch_, 1);
+
+        std::uint32_t interval;
+        if (get_if_exists (section, "flush_interval", interval))
+            writeInterval_ = std::chrono::seconds (interval);
+
+        auto const& collector = app.getCollectorManager ().collector ();
+        mWritten = collector->make_counter ("validations_written");
+        mWriteTime = collector->make_event ("validations_write");
+
+        mStaleValidations.reserve (writeBatch_);
     }
 
 private:
@@ -376,8 +420,8 @@ private:
         }
         mCurrentValidations.clear ();
 
-        if (anyNew)
-            condWrite ();
+        if (anyNew || ! mStaleValidations.empty ())
+            condWrite (true);
 
         while (mWriting)
         {
@@ -388,12 +432,21 @@ private:
         JLOG (j_.debug()) << "Validations flushed";
     }
 
-    void condWrite ()
+    // Start writing stale validations if a full batch is waiting,
+    // if the flush interval has passed, or if forced to.
+    void condWrite (bool force = false)
     {
-        if (mWriting)
+        if (mWriting || mStaleValidations.empty ())
+            return;
+
+        auto const now = stopwatch().now();
+        if (! force &&
+            mStaleValidations.size () < writeBatch_ &&
+            now - lastWrite_ < writeInterval_)
             return;
 
         mWriting = true;
+        lastWrite_ = now;
         app_.getJobQueue ().addJob (
             jtWRITE, "Validations::doWrite",
             [this] (Job&) { doWrite(); });
@@ -402,10 +455,6 @@ private:
     void doWrite ()
     {
         LoadEvent::autoptr event (app_.getJobQueue ().getLoadEventAP (jtDISK, "ValidationWrite"));
-        std::string insVal ("INSERT INTO Validations "
-            "(InitialSeq, LedgerSeq, LedgerHash,NodePubKey,SignTime,RawData) "
-            "VALUES (:initialSeq, :ledgerSeq, :ledgerHash,:nodePubKey,:signTime,:rawData);");
-        std::string findSeq("SELECT LedgerSeq FROM Ledgers WHERE Ledgerhash=:ledgerHash;");
 
         ScopedLockType sl (mLock);
         assert (mWriting);
@@ -413,51 +462,79 @@ private:
         while (!mStaleValidations.empty ())
         {
             std::vector<STValidation::pointer> vector;
-            vector.reserve (512);
+            vector.reserve (writeBatch_);
             mStaleValidations.swap (vector);
 
             {
                 ScopedUnlockType sul (mLock);
+
+                // Many validations are for the same ledger
+                hash_map<uint256, boost::optional<std::uint64_t>> seqs;
+
+                // Each batch is one transaction, so that the ledger
+                // database is free between batches.
+                for (auto it = vector.cbegin (); it != vector.cend ();)
                 {
-                    auto db = app_.getLedgerDB ().checkoutDb ();
+                    auto const end = it + std::min<std::size_t> (
+                        writeBatch_, vector.cend () - it);
+                    auto const rows = end - it;
+                    auto const start = std::chrono::steady_clock::now ();
 
-                    Serializer s (1024);
-                    soci::transaction tr(*db);
-                    for (auto it: vector)
                     {
-                        s.erase ();
-                        it->add (s);
-
-                        auto const ledgerHash = to_string(it->getLedgerHash());
-
-                        boost::optional<std::uint64_t> ledgerSeq;
-                        *db << findSeq, soci::use(ledgerHash),
-                            soci::into(ledgerSeq);
-
-                        auto const initialSeq = ledgerSeq.value_or(
-                            app_.getLedgerMaster().getCurrentLedgerIndex());
-                        auto const nodePubKey = toBase58(
-                            TokenType::TOKEN_NODE_PUBLIC,
-                            it->getSignerPublic());
-                        auto const signTime =
-                            it->getSignTime().time_since_epoch().count();
-
-                        soci::blob rawData(*db);
-                        rawData.append(reinterpret_cast<const char*>(
-                            s.peekData().data()), s.peekData().size());
-                        assert(rawData.get_len() == s.peekData().size());
-
-                        *db <<
-                            insVal,
-                            soci::use(initialSeq),
-                            soci::use(ledgerSeq),
-                            soci::use(ledgerHash),
-                            soci::use(nodePubKey),
-                            soci::use(signTime),
-                            soci::use(rawData);
+                        auto db = app_.getLedgerDB ().checkoutDb ();
+
+                        auto& w = app_.getLedgerDB ().getPrepared<Writer> ();
+
+                        Serializer s (1024);
+                        soci::transaction tr (*db);
+                        for (; it != end; ++it)
+                        {
+                            auto const& val = *it;
+
+                            s.erase ();
+                            val->add (s);
+
+                            w.ledgerHash = to_string (val->getLedgerHash ());
+
+                            auto seq = seqs.find (val->getLedgerHash ());
+                            if (seq == seqs.end ())
+                            {
+                                w.ledgerSeq.reset ();
+                                w.findSeq.execute (true);
+                                seq = seqs.emplace (
+                                    val->getLedgerHash (), w.ledgerSeq).first;
+                            }
+
+                            w.ledgerSeq = seq->second;
+                            w.initialSeq = w.ledgerSeq.value_or (
+                                app_.getLedgerMaster ().getCurrentLedgerIndex ());
+                            w.nodePubKey = toBase58 (
+                                TokenType::TOKEN_NODE_PUBLIC,
+                                val->getSignerPublic ());
+                            w.signTime =
+                                val->getSignTime ().time_since_epoch ().count ();
+
+                            w.rawData.trim (0);
+                            w.rawData.append (reinterpret_cast<const char*>(
+                                s.peekData ().data ()), s.peekData ().size ());
+                            assert (w.rawData.get_len () == s.peekData ().size ());
+
+                            w.insert.execute (true);
+                        }
+
+                        tr.commit ();
                     }
 
-                    tr.commit ();
+                    auto const elapsed = std::chrono::duration_cast<
+                        std::chrono::milliseconds> (
+                            std::chrono::steady_clock::now () - start);
+
+                    mWritten.increment (rows);
+                    mWriteTime.notify (elapsed);
+
+                    JLOG (j_.debug()) <<
+                        "Wrote " << rows << " validations in " <<
+                        elapsed.count () << "ms";
                 }
             }
         }
@@ -469,9 +546,33 @@ private:
     {
         ScopedLockType sl (mLock);
         mValidations.sweep ();
+
+        // Write out validations which have waited past the interval
+        condWrite ();
     }
 };
 
+ValidationsImp::Writer::Writer (soci::session& session)
+    : rawData (session)
+    , findSeq ((session.prepare <<
+        "SELECT LedgerSeq FROM Ledgers WHERE LedgerHash = :ledgerHash;",
+        soci::into (ledgerSeq),
+        soci::use (ledgerHash)))
+    , insert ((session.prepare <<
+        R"sql(INSERT INTO Validations
+            (InitialSeq, LedgerSeq, LedgerHash, NodePubKey, SignTime, RawData)
+        VALUES
+            (:initialSeq, :ledgerSeq, :ledgerHash, :nodePubKey, :signTime,
+             :rawData);)sql",
+        soci::use (initialSeq),
+        soci::use (ledgerSeq),
+        soci::use (ledgerHash),
+        soci::use (nodePubKey),
+        soci::use (signTime),
+        soci::use (rawData)))
+{
+}
+
 std::unique_ptr <Validations> make_Validations (Application& app)
 {
     return std::make_unique <ValidationsImp> (app);
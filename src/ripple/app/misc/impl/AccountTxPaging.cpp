@@ -25,7 +25,7 @@
 #include <ripple/app/misc/impl/AccountTxPaging.h>
 #include <ripple/protocol/Serializer.h>
 #include <ripple/protocol/types.h>
-#include <boost/format.hpp>
+#include <limits>
 #include <memory>
 
 namespace ripple {
@@ -79,8 +79,6 @@ accountTxPage (
     bool bAdmin,
     std::uint32_t page_length)
 {
-    bool lookingForMarker =  !token.isNull() && token.isObject();
-
     std::uint32_t numberOfResults;
 
     if (limit <= 0 || (limit > page_length && !bAdmin))
@@ -94,16 +92,21 @@ accountTxPage (
     // than the limit), then we return an opaque marker that can be supplied in
     // a subsequent query.
     std::uint32_t queryLimit = numberOfResults + 1;
-    std::uint32_t findLedger = 0, findSeq = 0;
 
-    if (lookingForMarker)
+    // The position to start from, inclusive. Without a marker
+    // that is the first (or last) transaction in the range.
+    std::uint32_t startLedger = forward ? minLedger : maxLedger;
+    std::uint32_t startSeq = forward ?
+        0 : std::numeric_limits<std::uint32_t>::max ();
+
+    if (!token.isNull() && token.isObject())
     {
         try
         {
             if (!token.isMember(jss::ledger) || !token.isMember(jss::seq))
                 return;
-            findLedger = token[jss::ledger].asInt();
-            findSeq = token[jss::seq].asInt();
+            startLedger = token[jss::ledger].asUInt();
+            startSeq = token[jss::seq].asUInt();
         }
         catch (std::exception const&)
         {
@@ -115,89 +118,45 @@ accountTxPage (
     // we need to clear it in between.
     token = Json::nullValue;
 
+    // AcctTxIndex orders each account's transactions by ledger and
+    // position, so the query seeks straight to the start however deep
+    // the page is: the range of ledgers bounds the index search, and
+    // only the start ledger's own entries are filtered by TxnSeq.
     static std::string const prefix (
         R"(SELECT AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,
           Status,RawTxn,TxnMeta
-          FROM AccountTransactions INNER JOIN Transactions
+          FROM AccountTransactions INDEXED BY AcctTxIndex
+          INNER JOIN Transactions
           ON Transactions.TransID = AccountTransactions.TransID
-          AND AccountTransactions.Account = '%s' WHERE
+          WHERE AccountTransactions.Account = :account AND
+          AccountTransactions.LedgerSeq BETWEEN :from AND :to AND
           )");
 
-    std::string sql;
-
-    // SQL's BETWEEN uses a closed interval ([a,b])
-
-    if (forward && (findLedger == 0))
-    {
-        sql = boost::str (boost::format(
-            prefix +
-            (R"(AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u'
-             ORDER BY AccountTransactions.LedgerSeq ASC,
-             AccountTransactions.TxnSeq ASC
-             LIMIT %u;)"))
-            % idCache.toBase58(account)
-            % minLedger
-            % maxLedger
-            % queryLimit);
-    }
-    else if (forward && (findLedger != 0))
-    {
-        sql = boost::str (boost::format(
-            prefix +
-            (R"(
-            AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u' OR
-            ( AccountTransactions.LedgerSeq = '%u' AND
-              AccountTransactions.TxnSeq >= '%u' )
-            ORDER BY AccountTransactions.LedgerSeq ASC,
-            AccountTransactions.TxnSeq ASC
-            LIMIT %u;
-            )"))
-        % idCache.toBase58(account)
-        % (findLedger + 1)
-        % maxLedger
-        % findLedger
-        % findSeq
-        % queryLimit);
-    }
-    else if (!forward && (findLedger == 0))
-    {
-        sql = boost::str (boost::format(
-            prefix +
-            (R"(AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u'
-             ORDER BY AccountTransactions.LedgerSeq DESC,
-             AccountTransactions.TxnSeq DESC
-             LIMIT %u;)"))
-            % idCache.toBase58(account)
-            % minLedger
-            % maxLedger
-            % queryLimit);
-    }
-    else if (!forward && (findLedger != 0))
-    {
-        sql = boost::str (boost::format(
-            prefix +
-            (R"(AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u' OR
-             (AccountTransactions.LedgerSeq = '%u' AND
-              AccountTransactions.TxnSeq <= '%u')
-             ORDER BY AccountTransactions.LedgerSeq DESC,
-             AccountTransactions.TxnSeq DESC
-             LIMIT %u;)"))
-            % idCache.toBase58(account)
-            % minLedger
-            % (findLedger - 1)
-            % findLedger
-            % findSeq
-            % queryLimit);
-    }
-    else
-    {
-        assert (false);
-        // sql is empty
-        return;
-    }
+    static std::string const forwardSql (prefix +
+        R"((AccountTransactions.LedgerSeq > :ledger OR
+          AccountTransactions.TxnSeq >= :seq)
+          ORDER BY AccountTransactions.LedgerSeq ASC,
+          AccountTransactions.TxnSeq ASC
+          LIMIT :limit;)");
+
+    static std::string const backwardSql (prefix +
+        R"((AccountTransactions.LedgerSeq < :ledger OR
+          AccountTransactions.TxnSeq <= :seq)
+          ORDER BY AccountTransactions.LedgerSeq DESC,
+          AccountTransactions.TxnSeq DESC
+          LIMIT :limit;)");
+
+    std::string const accountID (idCache.toBase58(account));
+
+    // soci binds 32-bit unsigned values as signed ones, which would
+    // turn the largest position into -1, so bind 64-bit values.
+    std::int64_t const fromLedger = forward ? startLedger : minLedger;
+    std::int64_t const toLedger = forward ? maxLedger : startLedger;
+    std::int64_t const ledger = startLedger;
+    std::int64_t const seq = startSeq;
 
     {
-        auto db (connection.checkoutDb());
+        auto db (connection.checkoutReadDb());
 
         Blob rawData;
         Blob rawMeta;
@@ -209,26 +168,25 @@ accountTxPage (
         soci::blob txnMeta (*db);
         soci::indicator dataPresent, metaPresent;
 
-        soci::statement st = (db->prepare << sql,
+        soci::statement st = (db->prepare <<
+            (forward ? forwardSql : backwardSql),
             soci::into (ledgerSeq),
             soci::into (txnSeq),
             soci::into (status),
             soci::into (txnData, dataPresent),
-            soci::into (txnMeta, metaPresent));
+            soci::into (txnMeta, metaPresent),
+            soci::use (accountID),
+            soci::use (fromLedger),
+            soci::use (toLedger),
+            soci::use (ledger),
+            soci::use (seq),
+            soci::use (queryLimit));
 
         st.execute ();
 
         while (st.fetch ())
         {
-            if (lookingForMarker)
-            {
-                if (findLedger == ledgerSeq.value_or (0) &&
-                    findSeq == txnSeq.value_or (0))
-                {
-                    lookingForMarker = false;
-                }
-            }
-            else if (numberOfResults == 0)
+            if (numberOfResults == 0)
             {
                 token = Json::objectValue;
                 token[jss::ledger] = rangeCheckedCast<std::uint32_t>(ledgerSeq.value_or (0));
@@ -236,26 +194,23 @@ accountTxPage (
                 break;
             }
 
-            if (!lookingForMarker)
-            {
-                if (dataPresent == soci::i_ok)
-                    convert (txnData, rawData);
-                else
-                    rawData.clear ();
-
-                if (metaPresent == soci::i_ok)
-                    convert (txnMeta, rawMeta);
-                else
-                    rawMeta.clear ();
-
-                // Work around a bug that could leave the metadata missing
-                if (rawMeta.size() == 0)
-                    onUnsavedLedger(ledgerSeq.value_or (0));
-
-                onTransaction(rangeCheckedCast<std::uint32_t>(ledgerSeq.value_or (0)),
-                    *status, rawData, rawMeta);
-                --numberOfResults;
-            }
+            if (dataPresent == soci::i_ok)
+                convert (txnData, rawData);
+            else
+                rawData.clear ();
+
+            if (metaPresent == soci::i_ok)
+                convert (txnMeta, rawMeta);
+            else
+                rawMeta.clear ();
+
+            // Work around a bug that could leave the metadata missing
+            if (rawMeta.size() == 0)
+                onUnsavedLedger(ledgerSeq.value_or (0));
+
+            onTransaction(rangeCheckedCast<std::uint32_t>(ledgerSeq.value_or (0)),
+                *status, rawData, rawMeta);
+            --numberOfResults;
         }
     }
 
@@ -29,6 +29,7 @@
 #include <ripple/core/Config.h>
 #include <ripple/net/RPCErr.h>
 #include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/Serializer.h>
 #include <ripple/protocol/UintTypes.h>
 #include <ripple/rpc/impl/Tuning.h>
 #include <ripple/beast/core/LexicalCast.h>
@@ -687,6 +688,8 @@ Json::Value PathRequest::doUpdate(
     JLOG(m_journal.debug()) << iIdentifier
         << " processing at level " << iLevel;
 
+    auto const start = steady_clock::now();
+
     Json::Value jvArray = Json::arrayValue;
     if (findPaths(cache, iLevel, jvArray))
     {
@@ -699,6 +702,83 @@ Json::Value PathRequest::doUpdate(
         newStatus = rpcError(rpcINTERNAL);
     }
 
+    mOwner.reportUpdate (duration_cast<milliseconds>(
+        steady_clock::now() - start));
+    replied (fast);
+
+    {
+        ScopedLockType sl(mLock);
+        jvStatus = newStatus;
+    }
+
+    return newStatus;
+}
+
+Json::Value PathRequest::doCopyUpdate (
+    PathRequest const& leader, Json::Value const& status)
+{
+    JLOG(m_journal.debug()) << iIdentifier
+        << " update from " << leader.iIdentifier;
+
+    iLevel = leader.iLevel;
+    bLastSuccess = leader.bLastSuccess;
+    mContext = leader.mContext;
+
+    Json::Value newStatus = status;
+    if (jvId)
+        newStatus["id"] = jvId;
+    else
+        newStatus.removeMember ("id");
+
+    replied (false);
+
+    {
+        ScopedLockType sl(mLock);
+        jvStatus = newStatus;
+    }
+
+    return newStatus;
+}
+
+uint256 PathRequest::getSearchKey ()
+{
+    ScopedLockType sl (mLock);
+
+    Serializer s;
+    if (! raSrcAccount || ! raDstAccount)
+    {
+        // Never shared
+        s.add8 (0);
+        s.add32 (iIdentifier);
+        return s.getSHA512Half ();
+    }
+
+    // The old API adds destination currencies to the reply
+    s.add8 (hasCompletion () ? 2 : 1);
+    s.add160 (*raSrcAccount);
+    s.add160 (*raDstAccount);
+    saDstAmount.add (s);
+    s.add8 (convert_all_ ? 1 : 0);
+    if (saSendMax)
+    {
+        s.add8 (1);
+        saSendMax->add (s);
+    }
+    else
+    {
+        s.add8 (0);
+    }
+    for (auto const& issue : sciSourceCurrencies)
+    {
+        s.add160 (issue.currency);
+        s.add160 (issue.account);
+    }
+    return s.getSHA512Half ();
+}
+
+void PathRequest::replied (bool fast)
+{
+    using namespace std::chrono;
     if (fast && quick_reply_ == steady_clock::time_point{})
     {
         quick_reply_ = steady_clock::now();
@@ -709,13 +789,6 @@ Json::Value PathRequest::doUpdate(
         full_reply_ = steady_clock::now();
         mOwner.reportFull(duration_cast<milliseconds>(full_reply_ - created_));
     }
-
-    {
-        ScopedLockType sl(mLock);
-        jvStatus = newStatus;
-    }
-
-    return newStatus;
 }
 
 InfoSub::pointer PathRequest::getSubscriber ()
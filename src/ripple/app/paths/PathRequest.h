@@ -95,6 +95,23 @@ public:
     // update jvStatus
     Json::Value doUpdate (
         std::shared_ptr<RippleLineCache> const&, bool fast);
+
+    /** Update jvStatus from another request for the same search.
+
+        @param leader A request with the same search key, whose full
+                      update has just completed on this thread.
+        @param status The status that update returned.
+    */
+    Json::Value doCopyUpdate (
+        PathRequest const& leader, Json::Value const& status);
+
+    /** Identifies the search this request performs.
+
+        Requests with equal keys find the same paths, so one
+        can be updated from the other.
+    */
+    uint256 getSearchKey ();
+
     InfoSub::pointer getSubscriber ();
     bool hasCompletion ();
 
@@ -117,6 +134,9 @@ private:
 
     int parseJson (Json::Value const&);
 
+    // Record the time to the first fast or full reply
+    void replied (bool fast);
+
     Application& app_;
     beast::Journal m_journal;
 
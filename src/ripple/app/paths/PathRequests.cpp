@@ -19,13 +19,17 @@
 
 #include <BeastConfig.h>
 #include <ripple/app/paths/PathRequests.h>
+#include <ripple/app/paths/Tuning.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/resource/Fees.h>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 
 namespace ripple {
 
@@ -47,11 +51,46 @@ PathRequests::getLineCache (
          (authoritative && ((lgrSeq + 8)  < lineSeq)) ||   // we jumped way back for some reason
          (lgrSeq > (lineSeq + 8)))                         // we jumped way forward for some reason
     {
-        mLineCache = std::make_shared<RippleLineCache> (ledger);
+        auto const parent = mLineCache ?
+            mLineCache->getLedger() : nullptr;
+
+        if (parent && ! parent->open() && ! ledger->open() &&
+            ledger->info().parentHash == parent->info().hash)
+        {
+            mLineCache = std::make_shared<RippleLineCache> (
+                ledger, *mLineCache, mJournal);
+            warmLineCache (mLineCache);
+        }
+        else
+        {
+            mLineCache = std::make_shared<RippleLineCache> (ledger);
+        }
     }
     return mLineCache;
 }
 
+// Load the lines of busy accounts which changed in the new
+// ledger before the path requests need them.
+void
+PathRequests::warmLineCache (std::shared_ptr<RippleLineCache> const& cache)
+{
+    if (cache->getStaleHubs().empty() ||
+            app_.getJobQueue().isStopping())
+        return;
+
+    std::weak_ptr<RippleLineCache> wp = cache;
+    app_.getJobQueue().addJob (jtUPDATE_PF, "RippleLineCache::warm",
+        [wp] (Job&)
+        {
+            auto cache = wp.lock();
+            if (! cache)
+                return;
+
+            for (auto const& account : cache->getStaleHubs())
+                cache->getRippleLines (account);
+        });
+}
+
 void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
                               Job::CancelCallback shouldCancel)
 {
@@ -76,75 +115,116 @@ void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
         "updateAll seq=" << cache->getLedger()->seq() <<
         ", " << requests.size() << " requests";
 
-    int processed = 0, removed = 0;
+    std::atomic<int> processed {0};
+    int removed = 0;
 
     do
     {
-        for (auto const& wr : requests)
+        // Requests for the same search are updated together, the
+        // first one needing an update doing the work for the rest.
+        std::vector<std::vector<PathRequest::pointer>> searches;
+        bool dangling = false;
         {
-            if (shouldCancel())
-                break;
+            hash_map<uint256, std::size_t> index;
+            for (auto const& wr : requests)
+            {
+                auto request = wr.lock ();
+                if (! request)
+                {
+                    dangling = true;
+                    continue;
+                }
+
+                auto const result = index.emplace (
+                    request->getSearchKey (), searches.size ());
+                if (result.second)
+                    searches.emplace_back ();
+                searches[result.first->second].push_back (
+                    std::move (request));
+            }
+        }
 
-            auto request = wr.lock ();
-            bool remove = true;
+        auto const seq = cache->getLedger()->seq();
+        std::atomic<bool> abandon {false};
+        std::mutex removeLock;
+        std::vector<PathRequest::pointer> removals;
 
-            if (request)
+        auto update = [&](std::size_t i)
+        {
+            if (abandon || shouldCancel())
+                return;
+
+            PathRequest::pointer leader;
+            Json::Value status;
+
+            for (auto const& request : searches[i])
             {
-                if (!request->needsUpdate (newRequests, cache->getLedger()->seq()))
-                    remove = false;
-                else
+                if (!request->needsUpdate (newRequests, seq))
+                    continue;
+
+                bool done = false;
+                auto ipSub = request->getSubscriber ();
+                if (ipSub ? !ipSub->getConsumer ().warn ()
+                    : request->hasCompletion ())
                 {
-                    if (auto ipSub = request->getSubscriber ())
+                    // One-shot requests with a completion
+                    // function have no subscriber
+                    Json::Value update = leader ?
+                        request->doCopyUpdate (*leader, status) :
+                        request->doUpdate (cache, false);
+                    if (! leader)
                     {
-                        if (!ipSub->getConsumer ().warn ())
-                        {
-                            Json::Value update = request->doUpdate (cache, false);
-                            request->updateComplete ();
-                            update[jss::type] = "path_find";
-                            ipSub->send (update, false);
-                            remove = false;
-                            ++processed;
-                        }
+                        leader = request;
+                        status = update;
                     }
-                    else if (request->hasCompletion ())
+                    request->updateComplete ();
+                    if (ipSub)
                     {
-                        // One-shot request with completion function
-                        request->doUpdate (cache, false);
-                        request->updateComplete();
-                        ++processed;
+                        update[jss::type] = "path_find";
+                        ipSub->send (update, false);
                     }
+                    ++processed;
+                    done = true;
+                }
+
+                if (! done)
+                {
+                    std::lock_guard<std::mutex> sl (removeLock);
+                    removals.push_back (request);
                 }
             }
 
-            if (remove)
-            {
-                ScopedLockType sl (mLock);
+            // We weren't handling new requests and then
+            // there was a new request
+            if (!newRequests && app_.getLedgerMaster().isNewPathRequest())
+                abandon = true;
+        };
 
-                // Remove any dangling weak pointers or weak
-                // pointers that refer to this path request.
-                auto ret = std::remove_if (
-                    requests_.begin(), requests_.end(),
-                    [&removed,&request](auto const& wl)
-                    {
-                        auto r = wl.lock();
+        app_.getJobQueue().parallelFor (jtUPDATE_PF, "PathRequest::update",
+            searches.size(), PATHFINDER_UPDATE_JOBS, update);
 
-                        if (r && r != request)
-                            return false;
-                        ++removed;
-                        return true;
-                    });
+        mustBreak = abandon;
 
-                requests_.erase (ret, requests_.end());
-            }
+        if (dangling || !removals.empty())
+        {
+            ScopedLockType sl (mLock);
 
-            mustBreak = !newRequests &&
-                app_.getLedgerMaster().isNewPathRequest();
+            // Remove any dangling weak pointers or weak
+            // pointers that refer to removed path requests.
+            auto ret = std::remove_if (
+                requests_.begin(), requests_.end(),
+                [&removed,&removals](auto const& wl)
+                {
+                    auto r = wl.lock();
 
-            // We weren't handling new requests and then
-            // there was a new request
-            if (mustBreak)
-                break;
+                    if (r && std::find (removals.begin(),
+                            removals.end(), r) == removals.end())
+                        return false;
+                    ++removed;
+                    return true;
+                });
 
+            requests_.erase (ret, requests_.end());
         }
 
         if (mustBreak)
@@ -175,7 +255,7 @@ void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
     while (!shouldCancel ());
 
     JLOG (mJournal.debug()) <<
-        "updateAll complete: " << processed << " processed and " <<
+        "updateAll complete: " << processed.load () << " processed and " <<
         removed << " removed";
 }
 
@@ -41,6 +41,7 @@ public:
     {
         mFast = collector->make_event ("pathfind_fast");
         mFull = collector->make_event ("pathfind_full");
+        mUpdate = collector->make_event ("pathfind_update");
     }
 
     void updateAll (std::shared_ptr<ReadView const> const& ledger,
@@ -83,14 +84,23 @@ public:
         mFull.notify (ms);
     }
 
+    // The time taken to compute one update of one request
+    void reportUpdate (std::chrono::milliseconds ms)
+    {
+        mUpdate.notify (ms);
+    }
+
 private:
     void insertPathRequest (PathRequest::pointer const&);
 
+    void warmLineCache (std::shared_ptr<RippleLineCache> const&);
+
     Application& app_;
     beast::Journal                   mJournal;
 
     beast::insight::Event            mFast;
     beast::insight::Event            mFull;
+    beast::insight::Event            mUpdate;
 
     // Track all requests
     std::vector<PathRequest::wptr> requests_;
@@ -19,7 +19,11 @@
 
 #include <BeastConfig.h>
 #include <ripple/app/paths/RippleLineCache.h>
+#include <ripple/app/paths/Tuning.h>
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/ledger/OpenView.h>
+#include <ripple/ledger/TxMeta.h>
+#include <cassert>
 
 namespace ripple {
 
@@ -32,21 +36,75 @@ RippleLineCache::RippleLineCache(
     mLedger = std::make_shared<OpenView>(&*ledger, ledger);
 }
 
+RippleLineCache::RippleLineCache (
+    std::shared_ptr <ReadView const> const& ledger,
+    RippleLineCache& parent,
+    beast::Journal journal)
+    : RippleLineCache (ledger)
+{
+    assert (ledger->info().parentHash ==
+        parent.mLedger->info().hash);
+
+    hash_set <AccountID> affected;
+    for (auto const& tx : ledger->txs)
+    {
+        // Without metadata nothing can be carried forward
+        if (! tx.second)
+            return;
+
+        TxMeta const meta (tx.first->getTransactionID (),
+            ledger->info().seq, *tx.second, journal);
+        for (auto const& account : meta.getAffectedAccounts ())
+            affected.insert (account);
+    }
+
+    std::lock_guard <std::mutex> sl (parent.mLock);
+    for (auto const& entry : parent.lines_)
+    {
+        auto const& lines = entry.second;
+        if (! lines->loaded.load (std::memory_order_acquire))
+            continue;
+
+        auto const& account = entry.first.account_;
+        if (affected.count (account) == 0)
+        {
+            // The hasher is seeded per cache
+            lines_.emplace (AccountKey (account, hasher_ (account)), lines);
+        }
+        else if (lines->items.size () >= PATHFINDER_HUB_LINES)
+        {
+            staleHubs_.push_back (account);
+        }
+    }
+}
+
 std::vector<RippleState::pointer> const&
 RippleLineCache::getRippleLines (AccountID const& accountID)
 {
     AccountKey key (accountID, hasher_ (accountID));
 
-    std::lock_guard <std::mutex> sl (mLock);
+    std::shared_ptr <Lines> lines;
+    {
+        std::lock_guard <std::mutex> sl (mLock);
+
+        auto& entry = lines_[key];
+        if (! entry)
+            entry = std::make_shared <Lines> ();
+        lines = entry;
+    }
 
-    auto it = lines_.emplace (key,
-        std::vector<RippleState::pointer>());
+    if (! lines->loaded.load (std::memory_order_acquire))
+    {
+        std::lock_guard <std::mutex> sl (lines->mutex);
 
-    if (it.second)
-        it.first->second = getRippleStateItems (
-            accountID, *mLedger);
+        if (! lines->loaded.load (std::memory_order_relaxed))
+        {
+            lines->items = getRippleStateItems (accountID, *mLedger);
+            lines->loaded.store (true, std::memory_order_release);
+        }
+    }
 
-    return it.first->second;
+    return lines->items;
 }
 
 } // ripple
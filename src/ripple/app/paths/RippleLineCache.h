@@ -23,6 +23,8 @@
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/paths/RippleState.h>
 #include <ripple/basics/hardened_hash.h>
+#include <ripple/beast/utility/Journal.h>
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <mutex>
@@ -31,6 +33,9 @@
 namespace ripple {
 
 // Used by Pathfinder
+//
+// The lines of each account are loaded once, by the first thread to
+// ask for them. Threads asking for other accounts do not wait.
 class RippleLineCache
 {
 public:
@@ -38,6 +43,16 @@ public:
     RippleLineCache (
         std::shared_ptr <ReadView const> const& l);
 
+    /** Create a cache for the ledger which follows that of another.
+
+        The lines of accounts which no transaction in the new ledger
+        affected are carried forward from the other cache.
+    */
+    RippleLineCache (
+        std::shared_ptr <ReadView const> const& l,
+        RippleLineCache& parent,
+        beast::Journal journal);
+
     std::shared_ptr <ReadView const> const&
     getLedger () const
     {
@@ -47,7 +62,24 @@ public:
     std::vector<RippleState::pointer> const&
     getRippleLines (AccountID const& accountID);
 
+    /** Accounts with many lines which were not carried forward.
+        Loading them early spares the pathfinder the wait.
+    */
+    std::vector<AccountID> const&
+    getStaleHubs () const
+    {
+        return staleHubs_;
+    }
+
 private:
+    struct Lines
+    {
+        std::mutex mutex;
+        std::atomic<bool> loaded {false};
+        std::vector<RippleState::pointer> items;
+    };
+
+    // Guards lines_, not the loading of the lines
     std::mutex mLock;
 
     ripple::hardened_hash<> hasher_;
@@ -91,8 +123,10 @@ private:
 
     hash_map <
         AccountKey,
-        std::vector <RippleState::pointer>,
+        std::shared_ptr <Lines>,
         AccountKey::Hash> lines_;
+
+    std::vector <AccountID> staleHubs_;
 };
 
 } // ripple
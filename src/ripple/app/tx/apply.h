@@ -27,6 +27,7 @@
 #include <ripple/beast/utility/Journal.h>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -54,6 +55,16 @@ checkValidity(HashRouter& router,
     STTx const& tx, Rules const& rules,
         Config const& config);
 
+/** Checks the signatures of a group of transactions and
+    caches the results, so a later checkValidity on any of
+    them skips the signature check. Transactions whose
+    signature state is already cached are not checked again.
+*/
+void
+checkSignatures(HashRouter& router,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+        Rules const& rules, Config const& config);
+
 
 /** Sets the validity of a given transaction in the cache.
     Use with extreme care.
@@ -83,6 +83,30 @@ checkValidity(HashRouter& router,
     return {Validity::Valid, ""};
 }
 
+void
+checkSignatures(HashRouter& router,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+        Rules const& rules, Config const& config)
+{
+    auto const allowMultiSign =
+        rules.enabled(featureMultiSign,
+            config.features);
+
+    std::vector<std::shared_ptr<STTx const>> unknown;
+    unknown.reserve(txs.size());
+    for (auto const& tx : txs)
+    {
+        auto const flags = router.getFlags(tx->getTransactionID());
+        if (!(flags & (SF_SIGBAD | SF_SIGGOOD)))
+            unknown.push_back(tx);
+    }
+
+    auto const results = checkSign(unknown, allowMultiSign);
+    for (std::size_t i = 0; i < unknown.size(); ++i)
+        router.setFlags(unknown[i]->getTransactionID(),
+            results[i].first ? SF_SIGGOOD : SF_SIGBAD);
+}
+
 void
 forceValidity(HashRouter& router, uint256 const& txid,
     Validity validity)
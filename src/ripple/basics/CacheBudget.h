@@ -0,0 +1,136 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_BASICS_CACHEBUDGET_H_INCLUDED
+#define RIPPLE_BASICS_CACHEBUDGET_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+/** A memory budget shared by several caches.
+
+    Each cache registers a function returning the number of bytes it
+    currently holds. Periodically, before the caches are swept, @ref update
+    adds up their footprints and adjusts a scale factor which every cache
+    applies to its target age. While the caches together exceed the budget
+    the factor shrinks in proportion to the overshoot, so entries are
+    evicted oldest first across all caches and the largest caches give up
+    the most memory. Once usage drops back below the budget the factor
+    recovers gradually.
+
+    A budget of zero places no limit on the caches.
+*/
+class CacheBudget
+{
+public:
+    using bytes_function = std::function <std::size_t ()>;
+
+    explicit
+    CacheBudget (std::uint64_t budget = 0);
+
+    CacheBudget (CacheBudget const&) = delete;
+    CacheBudget& operator= (CacheBudget const&) = delete;
+
+    /** Set the number of bytes the caches may hold together. */
+    void
+    setBudget (std::uint64_t budget);
+
+    std::uint64_t
+    getBudget () const
+    {
+        return budget_;
+    }
+
+    /** Register a cache.
+
+        @param owner Identifies the cache for a later call to erase.
+        @param name Used to report the cache's usage.
+        @param bytes Returns the cache's current footprint. It is only
+                     called from update.
+    */
+    void
+    insert (void const* owner, std::string const& name, bytes_function bytes);
+
+    /** Unregister a cache. */
+    void
+    erase (void const* owner);
+
+    /** Measure the caches and recompute the scale factor.
+
+        @return The total number of bytes held.
+    */
+    std::uint64_t
+    update ();
+
+    /** Return the factor, between 0 and 1, applied to target ages. */
+    double
+    getScale () const
+    {
+        return scale_;
+    }
+
+    /** Return a target age shortened according to the scale factor.
+
+        The result is never less than one second.
+    */
+    template <class Rep, class Period>
+    std::chrono::duration <Rep, Period>
+    scale (std::chrono::duration <Rep, Period> const& age) const
+    {
+        using duration = std::chrono::duration <Rep, Period>;
+        duration const minimumAge = std::chrono::duration_cast <duration> (
+            std::chrono::seconds (1));
+        auto const scaled = duration (static_cast <Rep> (
+            age.count () * getScale ()));
+        return std::min (age, std::max (scaled, minimumAge));
+    }
+
+    /** Return each cache's footprint as of the last update. */
+    std::vector <std::pair <std::string, std::uint64_t>>
+    getUsage () const;
+
+private:
+    struct Source
+    {
+        void const* owner;
+        std::string name;
+        bytes_function bytes;
+        std::uint64_t used;
+    };
+
+    std::atomic <std::uint64_t> budget_;
+    std::atomic <double> scale_;
+
+    std::mutex mutable mutex_;
+    std::vector <Source> sources_;
+};
+
+}
+
+#endif
@@ -20,8 +20,12 @@
 #ifndef RIPPLE_BASICS_DECAYINGSAMPLE_H_INCLUDED
 #define RIPPLE_BASICS_DECAYINGSAMPLE_H_INCLUDED
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 
 namespace ripple {
 
@@ -103,6 +107,108 @@ private:
 
 //------------------------------------------------------------------------------
 
+/** A DecayingSample which may be added to and read concurrently.
+
+    The value and the second it was last aged at are packed into one
+    word, so adding is a compare-and-swap loop and reading is a load.
+    Time is kept in whole seconds from construction, and the value
+    saturates instead of overflowing.
+
+    @tparam The number of seconds in the decay window.
+*/
+template <int Window, typename Clock>
+class AtomicDecayingSample
+{
+public:
+    using time_point = typename Clock::time_point;
+
+    AtomicDecayingSample () = delete;
+
+    /**
+        @param now Start time of AtomicDecayingSample.
+    */
+    explicit AtomicDecayingSample (time_point now)
+        : m_start (now)
+        , m_bits (0)
+    {
+    }
+
+    /** Add a new sample.
+        The value is first aged according to the specified time.
+        @return The new value in normalized units.
+    */
+    int add (int value, time_point now)
+    {
+        std::uint32_t const when = seconds (now);
+        std::uint64_t bits = m_bits.load (std::memory_order_relaxed);
+        std::uint64_t next;
+        std::uint32_t sample;
+        do
+        {
+            auto const sum = std::int64_t (decay (bits, when)) + value;
+            sample = static_cast<std::uint32_t> (std::min<std::int64_t> (
+                std::max<std::int64_t> (sum, 0),
+                    std::numeric_limits<std::uint32_t>::max ()));
+            next = (std::uint64_t (std::max (when, since (bits))) << 32) |
+                sample;
+        }
+        while (! m_bits.compare_exchange_weak (bits, next));
+        return sample / Window;
+    }
+
+    /** Retrieve the current value in normalized units.
+        The samples are aged according to the specified time.
+    */
+    int value (time_point now) const
+    {
+        return decay (m_bits.load (), seconds (now)) / Window;
+    }
+
+private:
+    std::uint32_t seconds (time_point now) const
+    {
+        if (now <= m_start)
+            return 0;
+        return static_cast<std::uint32_t> (std::chrono::duration_cast<
+            std::chrono::seconds>(now - m_start).count());
+    }
+
+    static std::uint32_t since (std::uint64_t bits)
+    {
+        return static_cast<std::uint32_t> (bits >> 32);
+    }
+
+    // Age a packed sample to the specified second.
+    static std::uint32_t decay (std::uint64_t bits, std::uint32_t when)
+    {
+        std::uint32_t sample = static_cast<std::uint32_t> (bits);
+        if (sample == 0 || when <= since (bits))
+            return sample;
+
+        std::uint32_t elapsed = when - since (bits);
+
+        // A span larger than four times the window decays the
+        // value to an insignificant amount so just reset it.
+        //
+        if (elapsed > 4 * Window)
+            return 0;
+
+        while (elapsed--)
+            sample -= static_cast<std::uint32_t> (
+                (std::uint64_t (sample) + Window - 1) / Window);
+        return sample;
+    }
+
+    // Time of construction, from which seconds are counted
+    time_point const m_start;
+
+    // Second last aged at, in the high half, and the
+    // current value in exponential units, in the low half
+    std::atomic<std::uint64_t> m_bits;
+};
+
+//------------------------------------------------------------------------------
+
 /** Sampling function using exponential decay to provide a continuous value.
     @tparam HalfLife The half life of a sample, in seconds.
 */
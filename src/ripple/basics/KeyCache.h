@@ -20,10 +20,12 @@
 #ifndef RIPPLE_BASICS_KEYCACHE_H_INCLUDED
 #define RIPPLE_BASICS_KEYCACHE_H_INCLUDED
 
+#include <ripple/basics/CacheBudget.h>
 #include <ripple/basics/hardened_hash.h>
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/beast/clock/abstract_clock.h>
 #include <ripple/beast/insight/Insight.h>
+#include <cassert>
 #include <mutex>
 
 namespace ripple {
@@ -32,7 +34,8 @@ namespace ripple {
 
     The cache has a target size and an expiration time. When cached items become
     older than the maximum age they are eligible for removal during a
-    call to @ref sweep.
+    call to @ref sweep. A cache attached to a CacheBudget shortens its
+    expiration time while the caches sharing the budget hold too much memory.
 */
 // VFALCO TODO Figure out how to pass through the allocator
 template <
@@ -94,6 +97,11 @@ private:
     std::string const m_name;
     size_type m_target_size;
     clock_type::duration m_target_age;
+    CacheBudget* m_budget = nullptr;
+
+    // Approximate bytes held for each key: the map node and its links
+    static std::size_t const entryOverhead =
+        sizeof (typename map_type::value_type) + 2 * sizeof (void*);
 
 public:
     /** Construct with the specified name.
@@ -127,6 +135,12 @@ public:
     {
     }
 
+    ~KeyCache ()
+    {
+        if (m_budget)
+            m_budget->erase (this);
+    }
+
     //--------------------------------------------------------------------------
 
     /** Retrieve the name of this object. */
@@ -148,6 +162,22 @@ public:
         return m_map.size ();
     }
 
+    /** Returns the estimated bytes held by the container. */
+    std::size_t bytes () const
+    {
+        return size () * entryOverhead;
+    }
+
+    /** Share a memory budget with other caches.
+        @note The budget must outlive the cache.
+    */
+    void setBudget (CacheBudget& budget)
+    {
+        assert (m_budget == nullptr);
+        m_budget = &budget;
+        budget.insert (this, m_name, [this]{ return bytes (); });
+    }
+
     /** Empty the cache */
     void clear ()
     {
@@ -245,15 +275,19 @@ public:
 
         lock_guard lock (m_mutex);
 
+        clock_type::duration target_age = m_target_age;
+        if (m_budget)
+            target_age = m_budget->scale (target_age);
+
         if (m_target_size == 0 ||
             (m_map.size () <= m_target_size))
         {
-            when_expire = now - m_target_age;
+            when_expire = now - target_age;
         }
         else
         {
             when_expire = now - clock_type::duration (
-                m_target_age.count() * m_target_size / m_map.size ());
+                target_age.count() * m_target_size / m_map.size ());
 
             clock_type::duration const minimumAge (
                 std::chrono::seconds (1));
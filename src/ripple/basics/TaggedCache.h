@@ -20,11 +20,15 @@
 #ifndef RIPPLE_BASICS_TAGGEDCACHE_H_INCLUDED
 #define RIPPLE_BASICS_TAGGEDCACHE_H_INCLUDED
 
+#include <ripple/basics/CacheBudget.h>
 #include <ripple/basics/hardened_hash.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/beast/clock/abstract_clock.h>
 #include <ripple/beast/insight/Insight.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <functional>
 #include <mutex>
 #include <vector>
@@ -34,6 +38,25 @@ namespace ripple {
 // VFALCO NOTE Deprecated
 struct TaggedCacheLog;
 
+/** Activity counters for one partition of a TaggedCache. */
+struct TaggedCachePartitionStats
+{
+    // Number of keys tracked, cached or not
+    std::size_t trackSize = 0;
+
+    // Number of items strongly cached
+    int cacheSize = 0;
+
+    // Estimated bytes held by the strongly cached items
+    std::size_t cacheBytes = 0;
+
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+
+    // Number of lock acquisitions which had to wait
+    std::uint64_t contended = 0;
+};
+
 /** Map/cache combination.
     This class implements a cache and a map. The cache keeps objects alive
     in the map. The map allows multiple code paths that reference objects
@@ -43,6 +66,16 @@ struct TaggedCacheLog;
     If it stays in memory even after it is ejected from the cache,
     the map will track it.
 
+    The cache keeps an estimate of the bytes its strongly cached objects
+    occupy, using a cost function which defaults to the size of the
+    object itself. A cache attached to a CacheBudget shortens its target
+    age whenever the caches sharing the budget hold too much memory.
+
+    The map may be split into partitions chosen by the hash of the key.
+    Each partition has its own lock, so threads working with unrelated
+    keys do not wait on each other, and a sweep only holds the lock of
+    the partition it is currently visiting.
+
     @note Callers must not modify data objects that are stored in the cache
           unless they hold their own lock over all cache operations.
 */
@@ -68,12 +101,14 @@ public:
     using weak_mapped_ptr = std::weak_ptr <mapped_type>;
     using mapped_ptr = std::shared_ptr <mapped_type>;
     using clock_type = beast::abstract_clock <std::chrono::steady_clock>;
+    using cost_function = std::function <std::size_t (T const&)>;
 
 public:
     // VFALCO TODO Change expiration_seconds to clock_type::duration
     TaggedCache (std::string const& name, int size,
         clock_type::rep expiration_seconds, clock_type& clock, beast::Journal journal,
-            beast::insight::Collector::ptr const& collector = beast::insight::NullCollector::New ())
+            beast::insight::Collector::ptr const& collector = beast::insight::NullCollector::New (),
+                std::size_t partitions = 1)
         : m_journal (journal)
         , m_clock (clock)
         , m_stats (name,
@@ -82,10 +117,16 @@ public:
         , m_name (name)
         , m_target_size (size)
         , m_target_age (std::chrono::seconds (expiration_seconds))
-        , m_cache_count (0)
-        , m_hits (0)
-        , m_misses (0)
+        , m_partitions (std::max <std::size_t> (partitions, 1))
+        , m_cost ([](T const&) { return sizeof (T); })
+        , m_budget (nullptr)
+    {
+    }
+
+    ~TaggedCache ()
     {
+        if (m_budget)
+            m_budget->erase (this);
     }
 
 public:
@@ -97,67 +138,162 @@ public:
 
     int getTargetSize () const
     {
-        lock_guard lock (m_mutex);
         return m_target_size;
     }
 
     void setTargetSize (int s)
     {
-        lock_guard lock (m_mutex);
         m_target_size = s;
 
         if (s > 0)
-            m_cache.rehash (static_cast<std::size_t> ((s + (s >> 2)) / m_cache.max_load_factor () + 1));
+        {
+            int const ps = partitionTargetSize (s);
+
+            for (auto& p : m_partitions)
+            {
+                lock_guard lock (p.mutex);
+                p.map.rehash (static_cast<std::size_t> ((ps + (ps >> 2)) / p.map.max_load_factor () + 1));
+            }
+        }
 
         JLOG(m_journal.debug()) <<
             m_name << " target size set to " << s;
     }
 
+    /** Set the function which estimates the bytes held by an object.
+        @note This must be called before any objects are inserted.
+    */
+    void setCostFunction (cost_function cost)
+    {
+        m_cost = std::move (cost);
+    }
+
+    /** Share a memory budget with other caches.
+        @note The budget must outlive the cache.
+    */
+    void setBudget (CacheBudget& budget)
+    {
+        assert (m_budget == nullptr);
+        m_budget = &budget;
+        budget.insert (this, m_name, [this]{ return getCacheBytes (); });
+    }
+
     clock_type::rep getTargetAge () const
     {
-        lock_guard lock (m_mutex);
-        return m_target_age.count();
+        return m_target_age.load ().count();
     }
 
     void setTargetAge (clock_type::rep s)
     {
-        lock_guard lock (m_mutex);
         m_target_age = std::chrono::seconds (s);
         JLOG(m_journal.debug()) <<
-            m_name << " target age set to " << m_target_age.count();
+            m_name << " target age set to " << s;
     }
 
     int getCacheSize () const
     {
-        lock_guard lock (m_mutex);
-        return m_cache_count;
+        int ret = 0;
+
+        for (auto& p : m_partitions)
+        {
+            lock_guard lock (p.mutex);
+            ret += p.cache_count;
+        }
+
+        return ret;
+    }
+
+    /** Return the estimated bytes held by the cache. */
+    std::size_t getCacheBytes () const
+    {
+        std::size_t ret = 0;
+
+        for (auto& p : m_partitions)
+        {
+            lock_guard lock (p.mutex);
+            ret += p.cache_bytes + p.map.size () * entryOverhead;
+        }
+
+        return ret;
     }
 
     int getTrackSize () const
     {
-        lock_guard lock (m_mutex);
-        return m_cache.size ();
+        std::size_t ret = 0;
+
+        for (auto& p : m_partitions)
+        {
+            lock_guard lock (p.mutex);
+            ret += p.map.size ();
+        }
+
+        return ret;
     }
 
     float getHitRate ()
     {
-        lock_guard lock (m_mutex);
-        auto const total = static_cast<float> (m_hits + m_misses);
-        return m_hits * (100.0f / std::max (1.0f, total));
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+
+        for (auto& p : m_partitions)
+        {
+            lock_guard lock (p.mutex);
+            hits += p.hits;
+            misses += p.misses;
+        }
+
+        auto const total = static_cast<float> (hits + misses);
+        return hits * (100.0f / std::max (1.0f, total));
     }
 
     void clearStats ()
     {
-        lock_guard lock (m_mutex);
-        m_hits = 0;
-        m_misses = 0;
+        for (auto& p : m_partitions)
+        {
+            lock_guard lock (p.mutex);
+            p.hits = 0;
+            p.misses = 0;
+            p.contended = 0;
+        }
     }
 
     void clear ()
     {
-        lock_guard lock (m_mutex);
-        m_cache.clear ();
-        m_cache_count = 0;
+        for (auto& p : m_partitions)
+        {
+            lock_guard lock (p.mutex);
+            p.map.clear ();
+            p.cache_count = 0;
+            p.cache_bytes = 0;
+        }
+    }
+
+    /** Return the number of independently locked partitions. */
+    std::size_t getPartitionCount () const
+    {
+        return m_partitions.size ();
+    }
+
+    /** Return the activity counters of each partition. */
+    std::vector <TaggedCachePartitionStats> getPartitionStats () const
+    {
+        std::vector <TaggedCachePartitionStats> v;
+        v.reserve (m_partitions.size ());
+
+        for (auto& p : m_partitions)
+        {
+            lock_guard lock (p.mutex);
+            TaggedCachePartitionStats s;
+            s.trackSize = p.map.size ();
+            s.cacheSize = p.cache_count;
+            s.cacheBytes = p.cache_bytes;
+            s.hits = p.hits;
+            s.misses = p.misses;
+            s.contended = p.contended;
+            v.push_back (s);
+        }
+
+        return v;
     }
 
     void sweep ()
@@ -165,103 +301,118 @@ public:
         int cacheRemovals = 0;
         int mapRemovals = 0;
         int cc = 0;
+        std::size_t tracked = 0;
 
-        // Keep references to all the stuff we sweep
-        // so that we can destroy them outside the lock.
-        //
-        std::vector <mapped_ptr> stuffToSweep;
+        clock_type::time_point const now (m_clock.now());
+        int const target_size = partitionTargetSize (m_target_size);
+        clock_type::duration target_age = m_target_age;
+        if (m_budget)
+            target_age = m_budget->scale (target_age);
 
+        // Sweep one partition at a time so that the others
+        // remain available while we work.
+        //
+        for (auto& p : m_partitions)
         {
-            clock_type::time_point const now (m_clock.now());
-            clock_type::time_point when_expire;
+            // Keep references to all the stuff we sweep
+            // so that we can destroy them outside the lock.
+            //
+            std::vector <mapped_ptr> stuffToSweep;
 
-            lock_guard lock (m_mutex);
-
-            if (m_target_size == 0 ||
-                (static_cast<int> (m_cache.size ()) <= m_target_size))
-            {
-                when_expire = now - m_target_age;
-            }
-            else
             {
-                when_expire = now - clock_type::duration (
-                    m_target_age.count() * m_target_size / m_cache.size ());
+                clock_type::time_point when_expire;
 
-                clock_type::duration const minimumAge (
-                    std::chrono::seconds (1));
-                if (when_expire > (now - minimumAge))
-                    when_expire = now - minimumAge;
+                ScopedLockType lock (lockPartition (p));
 
-                JLOG(m_journal.trace()) <<
-                    m_name << " is growing fast " << m_cache.size () << " of " << m_target_size <<
-                        " aging at " << (now - when_expire).count() << " of " << m_target_age.count();
-            }
+                if (target_size == 0 ||
+                    (static_cast<int> (p.map.size ()) <= target_size))
+                {
+                    when_expire = now - target_age;
+                }
+                else
+                {
+                    when_expire = now - clock_type::duration (
+                        target_age.count() * target_size / p.map.size ());
+
+                    clock_type::duration const minimumAge (
+                        std::chrono::seconds (1));
+                    if (when_expire > (now - minimumAge))
+                        when_expire = now - minimumAge;
 
-            stuffToSweep.reserve (m_cache.size ());
+                    JLOG(m_journal.trace()) <<
+                        m_name << " is growing fast " << p.map.size () << " of " << target_size <<
+                            " aging at " << (now - when_expire).count() << " of " << target_age.count();
+                }
 
-            cache_iterator cit = m_cache.begin ();
+                stuffToSweep.reserve (p.map.size ());
 
-            while (cit != m_cache.end ())
-            {
-                if (cit->second.isWeak ())
+                cache_iterator cit = p.map.begin ();
+
+                while (cit != p.map.end ())
                 {
-                    // weak
-                    if (cit->second.isExpired ())
+                    if (cit->second.isWeak ())
                     {
-                        ++mapRemovals;
-                        cit = m_cache.erase (cit);
+                        // weak
+                        if (cit->second.isExpired ())
+                        {
+                            ++mapRemovals;
+                            cit = p.map.erase (cit);
+                        }
+                        else
+                        {
+                            ++cit;
+                        }
                     }
-                    else
+                    else if (cit->second.last_access <= when_expire)
                     {
-                        ++cit;
-                    }
-                }
-                else if (cit->second.last_access <= when_expire)
-                {
-                    // strong, expired
-                    --m_cache_count;
-                    ++cacheRemovals;
-                    if (cit->second.ptr.unique ())
-                    {
-                        stuffToSweep.push_back (cit->second.ptr);
-                        ++mapRemovals;
-                        cit = m_cache.erase (cit);
+                        // strong, expired
+                        release (p, cit->second);
+                        ++cacheRemovals;
+                        if (cit->second.ptr.unique ())
+                        {
+                            stuffToSweep.push_back (cit->second.ptr);
+                            ++mapRemovals;
+                            cit = p.map.erase (cit);
+                        }
+                        else
+                        {
+                            // remains weakly cached
+                            cit->second.ptr.reset ();
+                            ++cit;
+                        }
                     }
                     else
                     {
-                        // remains weakly cached
-                        cit->second.ptr.reset ();
+                        // strong, not expired
+                        ++cc;
                         ++cit;
                     }
                 }
-                else
-                {
-                    // strong, not expired
-                    ++cc;
-                    ++cit;
-                }
+
+                tracked += p.map.size ();
             }
+
+            // At this point stuffToSweep will go out of scope outside the lock
+            // and decrement the reference count on each strong pointer.
         }
 
         if (mapRemovals || cacheRemovals)
         {
             JLOG(m_journal.trace()) <<
-                m_name << ": cache = " << m_cache.size () <<
+                m_name << ": cache = " << tracked <<
                 "-" << cacheRemovals << ", map-=" << mapRemovals;
         }
-
-        // At this point stuffToSweep will go out of scope outside the lock
-        // and decrement the reference count on each strong pointer.
     }
 
     bool del (const key_type& key, bool valid)
     {
         // Remove from cache, if !valid, remove from map too. Returns true if removed from cache
-        lock_guard lock (m_mutex);
+        Partition& p = partition (key);
+        ScopedLockType lock (lockPartition (p));
 
-        cache_iterator cit = m_cache.find (key);
+        cache_iterator cit = p.map.find (key);
 
-        if (cit == m_cache.end ())
+        if (cit == p.map.end ())
             return false;
 
         Entry& entry = cit->second;
@@ -270,13 +421,13 @@ public:
 
         if (entry.isCached ())
         {
-            --m_cache_count;
+            release (p, entry);
             entry.ptr.reset ();
             ret = true;
         }
 
         if (!valid || entry.isExpired ())
-            m_cache.erase (cit);
+            p.map.erase (cit);
 
         return ret;
     }
@@ -298,16 +449,17 @@ public:
     {
         // Return canonical value, store if needed, refresh in cache
         // Return values: true=we had the data already
-        lock_guard lock (m_mutex);
+        Partition& p = partition (key);
+        ScopedLockType lock (lockPartition (p));
 
-        cache_iterator cit = m_cache.find (key);
+        cache_iterator cit = p.map.find (key);
 
-        if (cit == m_cache.end ())
+        if (cit == p.map.end ())
         {
-            m_cache.emplace (std::piecewise_construct,
+            auto const result = p.map.emplace (std::piecewise_construct,
                 std::forward_as_tuple(key),
                 std::forward_as_tuple(m_clock.now(), data));
-            ++m_cache_count;
+            hold (p, result.first->second);
             return false;
         }
 
@@ -318,8 +470,10 @@ public:
         {
             if (replace)
             {
+                release (p, entry);
                 entry.ptr = data;
                 entry.weak_ptr = data;
+                hold (p, entry);
             }
             else
             {
@@ -344,13 +498,13 @@ public:
                 data = cachedData;
             }
 
-            ++m_cache_count;
+            hold (p, entry);
             return true;
         }
 
         entry.ptr = data;
         entry.weak_ptr = data;
-        ++m_cache_count;
+        hold (p, entry);
 
         return false;
     }
@@ -358,13 +512,14 @@ public:
     std::shared_ptr<T> fetch (const key_type& key)
     {
         // fetch us a shared pointer to the stored data object
-        lock_guard lock (m_mutex);
+        Partition& p = partition (key);
+        ScopedLockType lock (lockPartition (p));
 
-        cache_iterator cit = m_cache.find (key);
+        cache_iterator cit = p.map.find (key);
 
-        if (cit == m_cache.end ())
+        if (cit == p.map.end ())
         {
-            ++m_misses;
+            ++p.misses;
             return mapped_ptr ();
         }
 
@@ -373,7 +528,7 @@ public:
 
         if (entry.isCached ())
         {
-            ++m_hits;
+            ++p.hits;
             return entry.ptr;
         }
 
@@ -382,12 +537,12 @@ public:
         if (entry.isCached ())
         {
             // independent of cache size, so not counted as a hit
-            ++m_cache_count;
+            hold (p, entry);
             return entry.ptr;
         }
 
-        m_cache.erase (cit);
-        ++m_misses;
+        p.map.erase (cit);
+        ++p.misses;
         return mapped_ptr ();
     }
 
@@ -429,11 +584,12 @@ public:
         bool found = false;
 
         // If present, make current in cache
-        lock_guard lock (m_mutex);
+        Partition& p = partition (key);
+        ScopedLockType lock (lockPartition (p));
 
-        cache_iterator cit = m_cache.find (key);
+        cache_iterator cit = p.map.find (key);
 
-        if (cit != m_cache.end ())
+        if (cit != p.map.end ())
         {
             Entry& entry = cit->second;
 
@@ -445,7 +601,7 @@ public:
                 if (entry.isCached ())
                 {
                     // We just put the object back in cache
-                    ++m_cache_count;
+                    hold (p, entry);
                     entry.touch (m_clock.now());
                     found = true;
                 }
@@ -453,7 +609,7 @@ public:
                 {
                     // Couldn't get strong pointer,
                     // object fell out of the cache so remove the entry.
-                    m_cache.erase (cit);
+                    p.map.erase (cit);
                 }
             }
             else
@@ -471,19 +627,24 @@ public:
         return found;
     }
 
+    /** Return the mutex which guards the cache.
+        @note This is only meaningful when the cache has a single partition.
+    */
     mutex_type& peekMutex ()
     {
-        return m_mutex;
+        assert (m_partitions.size () == 1);
+        return m_partitions.front ().mutex;
     }
 
     std::vector <key_type> getKeys ()
     {
         std::vector <key_type> v;
 
+        for (auto& p : m_partitions)
         {
-            lock_guard lock (m_mutex);
-            v.reserve (m_cache.size());
-            for (auto const& _ : m_cache)
+            lock_guard lock (p.mutex);
+            v.reserve (v.size () + p.map.size());
+            for (auto const& _ : p.map)
                 v.push_back (_.first);
         }
 
@@ -498,10 +659,17 @@ private:
         {
             beast::insight::Gauge::value_type hit_rate (0);
             {
-                lock_guard lock (m_mutex);
-                auto const total (m_hits + m_misses);
+                std::uint64_t hits = 0;
+                std::uint64_t misses = 0;
+                for (auto& p : m_partitions)
+                {
+                    lock_guard lock (p.mutex);
+                    hits += p.hits;
+                    misses += p.misses;
+                }
+                auto const total (hits + misses);
                 if (total != 0)
-                    hit_rate = (m_hits * 100) / total;
+                    hit_rate = (hits * 100) / total;
             }
             m_stats.hit_rate.set (hit_rate);
         }
@@ -530,11 +698,15 @@ private:
         weak_mapped_ptr weak_ptr;
         clock_type::time_point last_access;
 
+        // Bytes charged while the object is strongly cached
+        std::size_t cost;
+
         Entry (clock_type::time_point const& last_access_,
             mapped_ptr const& ptr_)
             : ptr (ptr_)
             , weak_ptr (ptr_)
             , last_access (last_access_)
+            , cost (0)
         {
         }
 
@@ -548,26 +720,97 @@ private:
     using cache_type = hardened_hash_map <key_type, Entry, Hash, KeyEqual>;
     using cache_iterator = typename cache_type::iterator;
 
+    // A slice of the key space with its own lock and counters
+    struct Partition
+    {
+        mutex_type mutable mutex;
+
+        // Hold strong reference to recent objects
+        cache_type map;
+
+        // Number of items cached
+        int cache_count = 0;
+
+        // Estimated bytes held by the cached items
+        std::size_t cache_bytes = 0;
+
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+
+        // Number of lock acquisitions which had to wait
+        std::uint64_t contended = 0;
+    };
+
+    Partition& partition (key_type const& key)
+    {
+        if (m_partitions.size () == 1)
+            return m_partitions.front ();
+        return m_partitions[m_hash (key) % m_partitions.size ()];
+    }
+
+    // Lock a partition, noting whether another thread held it
+    static ScopedLockType lockPartition (Partition& p)
+    {
+        ScopedLockType lock (p.mutex, std::try_to_lock);
+        if (! lock.owns_lock ())
+        {
+            lock.lock ();
+            ++p.contended;
+        }
+        return lock;
+    }
+
+    // Account for an entry which just became strongly cached
+    void hold (Partition& p, Entry& entry)
+    {
+        entry.cost = m_cost (*entry.ptr);
+        p.cache_bytes += entry.cost;
+        ++p.cache_count;
+    }
+
+    // Account for an entry which is about to lose its strong reference
+    void release (Partition& p, Entry& entry)
+    {
+        p.cache_bytes -= entry.cost;
+        entry.cost = 0;
+        --p.cache_count;
+    }
+
+    // Approximate bytes of bookkeeping for each tracked key: the map
+    // node and its links, plus the shared_ptr control block
+    static std::size_t const entryOverhead =
+        sizeof (typename cache_type::value_type) + 4 * sizeof (void*);
+
+    // The share of the target size given to each partition
+    int partitionTargetSize (int size) const
+    {
+        int const n = static_cast<int> (m_partitions.size ());
+        return (size + n - 1) / n;
+    }
+
     beast::Journal m_journal;
     clock_type& m_clock;
     Stats m_stats;
 
-    mutex_type mutable m_mutex;
-
     // Used for logging
     std::string m_name;
 
     // Desired number of cache entries (0 = ignore)
-    int m_target_size;
+    std::atomic <int> m_target_size;
 
     // Desired maximum cache age
-    clock_type::duration m_target_age;
+    std::atomic <clock_type::duration> m_target_age;
+
+    // Selects the partition for a key
+    Hash m_hash;
+
+    std::vector <Partition> m_partitions;
+
+    // Estimates the bytes held by an object
+    cost_function m_cost;
 
-    // Number of items cached
-    int m_cache_count;
-    cache_type m_cache;  // Hold strong reference to recent objects
-    std::uint64_t m_hits;
-    std::uint64_t m_misses;
+    // Shared memory budget, if any
+    CacheBudget* m_budget;
 };
 
 }
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/basics/CacheBudget.h>
+
+namespace ripple {
+
+// Below this fraction of the budget the scale factor recovers
+static double const recoverBelow = 0.9;
+
+// Fraction of the remaining distance to 1 recovered on each update
+static double const recoverRate = 0.25;
+
+// The scale factor never drops below this
+static double const minimumScale = 0.01;
+
+CacheBudget::CacheBudget (std::uint64_t budget)
+    : budget_ (budget)
+    , scale_ (1.0)
+{
+}
+
+void
+CacheBudget::setBudget (std::uint64_t budget)
+{
+    budget_ = budget;
+    if (budget == 0)
+        scale_ = 1.0;
+}
+
+void
+CacheBudget::insert (void const* owner, std::string const& name,
+    bytes_function bytes)
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    sources_.push_back ({owner, name, std::move (bytes), 0});
+}
+
+void
+CacheBudget::erase (void const* owner)
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    sources_.erase (std::remove_if (sources_.begin (), sources_.end (),
+        [owner](Source const& s)
+        {
+            return s.owner == owner;
+        }), sources_.end ());
+}
+
+std::uint64_t
+CacheBudget::update ()
+{
+    std::uint64_t total = 0;
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        for (auto& s : sources_)
+        {
+            s.used = s.bytes ();
+            total += s.used;
+        }
+    }
+
+    auto const budget = budget_.load ();
+    if (budget == 0)
+        return total;
+
+    double scale = scale_;
+    if (total > budget)
+    {
+        scale = std::max (minimumScale,
+            scale * static_cast <double> (budget) / total);
+    }
+    else if (total < budget * recoverBelow)
+    {
+        scale = std::min (1.0, scale + (1.0 - scale) * recoverRate);
+    }
+    scale_ = scale;
+
+    return total;
+}
+
+std::vector <std::pair <std::string, std::uint64_t>>
+CacheBudget::getUsage () const
+{
+    std::vector <std::pair <std::string, std::uint64_t>> v;
+    std::lock_guard <std::mutex> lock (mutex_);
+    v.reserve (sources_.size ());
+    for (auto const& s : sources_)
+        v.emplace_back (s.name, s.used);
+    return v;
+}
+
+}
@@ -0,0 +1,158 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_BASICS_SPINLOCK_H_INCLUDED
+#define RIPPLE_BASICS_SPINLOCK_H_INCLUDED
+
+#include <atomic>
+#include <cassert>
+#include <limits>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace ripple {
+
+namespace detail {
+
+/** Inform the processor that we are in a tight spin-wait loop. */
+inline
+void
+spin_pause () noexcept
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#endif
+}
+
+}
+
+/** Locks packed into the bits of a single atomic integer.
+
+    Each bit of the integer is an independent lock, which makes it
+    possible to give every element of a small fixed-size array its own
+    lock at the cost of a few bytes. A `packed_spinlock` acquires one
+    of the bits, while a `spinlock` acquires all of them at once.
+
+    These meet the requirements of Lockable, so they can be used with
+    `std::lock_guard` and `std::unique_lock`. They should only guard
+    very short critical sections: a waiting thread spins instead of
+    sleeping.
+*/
+template <class T>
+class packed_spinlock
+{
+    static_assert (std::is_unsigned <T>::value,
+        "The lock must be an unsigned integer");
+
+    std::atomic <T>& bits_;
+    T const mask_;
+
+public:
+    packed_spinlock (packed_spinlock const&) = delete;
+    packed_spinlock& operator= (packed_spinlock const&) = delete;
+
+    /** Refer to one bit of a packed lock.
+
+        @param lock The integer holding the locks.
+        @param index The bit to use, counting from the least significant.
+    */
+    packed_spinlock (std::atomic <T>& lock, int index)
+        : bits_ (lock)
+        , mask_ (static_cast <T> (1) << index)
+    {
+        assert (index >= 0 && index < std::numeric_limits <T>::digits);
+    }
+
+    bool
+    try_lock ()
+    {
+        return (bits_.fetch_or (mask_, std::memory_order_acquire) & mask_) == 0;
+    }
+
+    void
+    lock ()
+    {
+        while (! try_lock ())
+        {
+            while ((bits_.load (std::memory_order_relaxed) & mask_) != 0)
+                detail::spin_pause ();
+        }
+    }
+
+    void
+    unlock ()
+    {
+        bits_.fetch_and (static_cast <T> (~mask_), std::memory_order_release);
+    }
+};
+
+/** A lock over every bit of a packed lock.
+    @see packed_spinlock
+*/
+template <class T>
+class spinlock
+{
+    static_assert (std::is_unsigned <T>::value,
+        "The lock must be an unsigned integer");
+
+    std::atomic <T>& lock_;
+
+public:
+    spinlock (spinlock const&) = delete;
+    spinlock& operator= (spinlock const&) = delete;
+
+    explicit
+    spinlock (std::atomic <T>& lock)
+        : lock_ (lock)
+    {
+    }
+
+    bool
+    try_lock ()
+    {
+        T expected = 0;
+        return lock_.compare_exchange_weak (expected,
+            std::numeric_limits <T>::max (),
+                std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void
+    lock ()
+    {
+        while (! try_lock ())
+        {
+            while (lock_.load (std::memory_order_relaxed) != 0)
+                detail::spin_pause ();
+        }
+    }
+
+    void
+    unlock ()
+    {
+        lock_.store (0, std::memory_order_release);
+    }
+};
+
+}
+
+#endif
@@ -253,6 +253,14 @@ public:
     bool
     fetch (void const* key, Handler&& handler);
 
+    /** Return the index of the key file bucket for a key.
+
+        Fetching a group of keys in bucket order turns
+        scattered key file reads into a forward scan.
+    */
+    std::size_t
+    bucket_of (void const* key);
+
     /** Insert a value.
 
         Returns:
@@ -459,6 +467,18 @@ next:
     return fetch(h, key, b, handler);
 }
 
+template <class Hasher, class Codec, class File>
+std::size_t
+store<Hasher, Codec, File>::bucket_of (void const* key)
+{
+    using namespace detail;
+    auto const h = hash<Hasher>(
+        key, s_->kh.key_size, s_->kh.salt);
+    shared_lock_type m (m_);
+    return bucket_index(
+        h, buckets_, modulus_);
+}
+
 template <class Hasher, class Codec, class File>
 bool
 store<Hasher, Codec, File>::insert (
@@ -50,6 +50,7 @@ class Rules;
 enum SizedItemName
 {
     siSweepInterval,
+    siCacheBudget,
     siNodeCacheSize,
     siNodeCacheAge,
     siTreeCacheSize,
@@ -143,6 +144,7 @@ public:
 
     // Peer networking parameters
     bool                        PEER_PRIVATE = false;           // True to ask peers not to relay current IP.
+    bool                        COMPRESSION = false;            // True to exchange compressed messages with peers which accept them.
     int                         PEERS_MAX = 0;
 
     std::chrono::seconds        WEBSOCKET_PING_FREQ = 5min;
@@ -169,6 +171,7 @@ public:
     std::uint32_t                      LEDGER_HISTORY = 256;
     std::uint32_t                      FETCH_DEPTH = 1000000000;
     int                         NODE_SIZE = 0;
+    std::uint64_t               CACHE_BUDGET = 0;           // Megabytes, 0 = use the node_size default
 
     bool                        SSL_VERIFY = true;
     std::string                 SSL_VERIFY_FILE;
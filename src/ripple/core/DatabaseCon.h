@@ -22,9 +22,17 @@
 
 #include <ripple/core/Config.h>
 #include <ripple/core/SociDB.h>
+#include <ripple/json/json_value.h>
 #include <boost/filesystem/path.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <typeindex>
+#include <vector>
 
 
 namespace soci {
@@ -46,6 +54,10 @@ public:
     LockedPointer (T* it, mutex& m) : it_ (it), lock_ (m)
     {
     }
+    LockedPointer (T* it, std::unique_lock<mutex>&& lock)
+        : it_ (it), lock_ (std::move (lock))
+    {
+    }
     LockedPointer (LockedPointer&& rhs) noexcept
         : it_ (rhs.it_), lock_ (std::move (rhs.lock_))
     {
@@ -82,6 +94,10 @@ public:
         Config::StartUpType startUp = Config::NORMAL;
         bool standAlone = false;
         boost::filesystem::path dataDir;
+
+        // Number of read-only sessions opened next to the writer.
+        // Databases kept in temporary files never have readers.
+        std::size_t readers = 4;
     };
 
     DatabaseCon (Setup const& setup,
@@ -94,18 +110,82 @@ public:
         return session_;
     }
 
-    LockedSociSession checkoutDb ()
+    /** Check out the writer session.
+
+        Every statement which changes the database, and every read
+        which must see the caller's own uncommitted writes, uses
+        this session.
+    */
+    LockedSociSession checkoutDb ();
+
+    /** Check out a read-only session.
+
+        Queries run on one of a pool of reader sessions, so that
+        they proceed while the writer is saving a ledger. Waits
+        when every reader is busy. Without a pool this is the
+        writer session.
+    */
+    LockedSociSession checkoutReadDb ();
+
+    /** Statements prepared once on the writer session.
+
+        A user derives its statements, and the variables they are
+        bound to, from Prepared. They are constructed from the writer
+        session the first time they are asked for, and destroyed
+        before the session closes.
+
+        @note Only call this with the writer session checked out.
+    */
+    struct Prepared
+    {
+        virtual ~Prepared () = default;
+    };
+
+    template <class T>
+    T& getPrepared ()
     {
-        return LockedSociSession (&session_, lock_);
+        auto& p = prepared_[std::type_index (typeid (T))];
+        if (! p)
+            p = std::make_unique<T> (session_);
+        return static_cast<T&> (*p);
     }
 
     void setupCheckpointing (JobQueue*, Logs&);
 
+    /** Checkout counts and the time spent waiting for sessions. */
+    Json::Value getJson () const;
+
 private:
+    using clock_type = std::chrono::steady_clock;
+
+    struct Reader
+    {
+        LockedSociSession::mutex lock;
+        soci::session session;
+    };
+
+    struct Waits
+    {
+        std::atomic <std::uint64_t> checkouts {0};
+        std::atomic <std::uint64_t> waits {0};
+        std::atomic <std::uint64_t> waitUs {0};
+        std::atomic <std::uint64_t> maxWaitUs {0};
+
+        void record (clock_type::time_point start);
+        Json::Value getJson () const;
+    };
+
     LockedSociSession::mutex lock_;
 
     soci::session session_;
     std::unique_ptr<Checkpointer> checkpointer_;
+    std::map <std::type_index, std::unique_ptr <Prepared>> prepared_;
+
+    std::vector <std::unique_ptr <Reader>> readers_;
+    std::atomic <std::size_t> nextReader_ {0};
+
+    Waits writeWaits_;
+    Waits readWaits_;
 };
 
 DatabaseCon::Setup
@@ -28,9 +28,10 @@
 #include <ripple/beast/insight/Collector.h>
 #include <ripple/core/Stoppable.h>
 #include <boost/function.hpp>
+#include <atomic>
 #include <condition_variable>
-#include <set>
 #include <thread>
+#include <vector>
 
 namespace ripple {
 
@@ -45,6 +46,11 @@ class Logs;
 
     When the JobQueue stops, it waits for all jobs
     and coroutines to finish.
+
+    Each job type has its own queue and lock, so threads adding or
+    taking jobs of different types do not contend. A worker takes the
+    oldest job of the highest priority type which is below its limit.
+    The job counts are atomic and may be read without locking.
 */
 class JobQueue
     : public Stoppable
@@ -68,6 +74,25 @@ public:
     template <class F>
     void postCoro (JobType t, std::string const& name, F&& f);
 
+    /** Calls a function for each index in [0, count), spread over
+        the calling thread and up to `jobs - 1` jobs of the given type.
+
+        The caller takes part, so the call completes even when no job
+        thread is free to help; helper jobs which start after the work
+        is done return at once. No helpers are added once the queue is
+        stopping. If `f` throws, the remaining indexes are abandoned
+        and the first exception is rethrown once all calls finish.
+
+        @param t The type of the helper jobs.
+        @param name Name of the helper jobs.
+        @param count The number of indexes.
+        @param jobs The most threads, the caller included, to use.
+        @param f Has a signature of void(std::size_t).
+    */
+    void parallelFor (JobType t, std::string const& name,
+        std::size_t count, int jobs,
+            std::function <void(std::size_t)> const& f);
+
     /** Jobs waiting at this priority.
     */
     int getJobCount (JobType t) const;
@@ -116,14 +141,22 @@ private:
     using JobDataMap = std::map <JobType, JobTypeData>;
 
     beast::Journal m_journal;
+
+    // Guards stopping, rendezvous and the suspended coroutine count.
+    // Jobs are queued under the lock of their type in m_jobData.
     mutable std::mutex m_mutex;
-    std::uint64_t m_lastJob;
-    std::set <Job> m_jobSet;
+    std::atomic <std::uint64_t> m_lastJob;
     JobDataMap m_jobData;
     JobTypeData m_invalidJobData;
 
+    // The dispatched job types, highest priority first
+    std::vector <JobTypeData*> m_priority;
+
+    // The number of jobs waiting, of all types
+    std::atomic <int> m_jobCount;
+
     // The number of jobs currently in processTask()
-    int m_processCount;
+    std::atomic <int> m_processCount;
 
     // The number of suspended coroutines
     int nSuspend_ = 0;
@@ -138,6 +171,13 @@ private:
 
     std::condition_variable cv_;
 
+    // Lets a task whose job is held back by a type's limit wait
+    // for a running job to finish, rather than spin.
+    std::mutex m_finishMutex;
+    std::condition_variable m_finishCond;
+    std::uint64_t m_finishCount = 0;
+    std::atomic <int> m_finishWaiters {0};
+
     static JobTypes const& getJobTypes()
     {
         static JobTypes types;
@@ -152,11 +192,10 @@ private:
     // Signals the service stopped if the stopped condition is met.
     void checkStopped (std::lock_guard <std::mutex> const& lock);
 
-    // Signals an added Job for processing.
+    // Adds a Job to the queue of its type and signals it for processing.
     //
     // Pre-conditions:
     //  The JobType must be valid.
-    //  The Job must exist in mJobSet.
     //  The Job must not have previously been queued.
     //
     // Post-conditions:
@@ -164,40 +203,44 @@ private:
     //  If JobQueue exists, and has at least one thread, Job will eventually run.
     //
     // Invariants:
-    //  The calling thread owns the JobLock
-    void queueJob (Job const& job, std::lock_guard <std::mutex> const& lock);
+    //  Takes the lock of the job's type
+    void queueJob (Job&& job, JobTypeData& data);
 
     // Returns the next Job we should run now.
     //
     // RunnableJob:
-    //  A Job in the JobSet whose slots count for its type is greater than zero.
+    //  A queued Job whose type is running below its limit.
     //
     // Pre-conditions:
-    //  mJobSet must not be empty.
-    //  mJobSet holds at least one RunnableJob
+    //  A task was signaled, so at least one RunnableJob exists
+    //  or will exist once a finishing job releases its slot.
     //
     // Post-conditions:
     //  job is a valid Job object.
-    //  job is removed from mJobQueue.
+    //  job is removed from the queue of its type.
     //  Waiting job count of its type is decremented
     //  Running job count of its type is incremented
     //
     // Invariants:
-    //  The calling thread owns the JobLock
+    //  Takes the lock of each type it removes a job from
+    //  Blocks until a running job finishes if none is runnable
     void getNextJob (Job& job);
 
+    // Takes the highest priority RunnableJob, if there is one.
+    bool takeNextJob (Job& job);
+
     // Indicates that a running Job has completed its task.
     //
     // Pre-conditions:
-    //  Job must not exist in mJobSet.
     //  The JobType must not be invalid.
     //
     // Post-conditions:
     //  The running count of that JobType is decremented
     //  A new task is signaled if there are more waiting Jobs than the limit, if any.
+    //  Tasks blocked in getNextJob are woken to look again.
     //
     // Invariants:
-    //  <none>
+    //  Takes the lock of the job's type
     void finishJob (JobType type);
 
     template <class Rep, class Period>
@@ -21,8 +21,12 @@
 #define RIPPLE_CORE_JOBTYPEDATA_H_INCLUDED
 
 #include <ripple/basics/Log.h>
+#include <ripple/core/Job.h>
 #include <ripple/core/JobTypeInfo.h>
 #include <ripple/beast/insight/Collector.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
 
 namespace ripple
 {
@@ -39,14 +43,21 @@ public:
     /* The job category which we represent */
     JobTypeInfo const& info;
 
+    /* Guards the queue and changes to the counts below. The counts
+       may be read without it. */
+    std::mutex mutex;
+
+    /* The jobs waiting to run, oldest first */
+    std::deque <Job> queue;
+
     /* The number of jobs waiting */
-    int waiting;
+    std::atomic <int> waiting;
 
     /* The number presently running */
-    int running;
+    std::atomic <int> running;
 
     /* And the number we deferred executing because of job limits */
-    int deferred;
+    std::atomic <int> deferred;
 
     /* Notification callbacks */
     beast::insight::Event dequeue;
@@ -44,7 +44,7 @@ add(    jtVALIDATION_ut, "untrustedValidation",     maxLimit, false, 2000,  5000
 add(    jtTRANSACTION_l, "localTransaction",        maxLimit, false, 100,   500);
 add(    jtLEDGER_REQ,    "ledgerRequest",           2,        false, 0,     0);
 add(    jtPROPOSAL_ut,   "untrustedProposal",       maxLimit, false, 500,   1250);
-add(    jtLEDGER_DATA,   "ledgerData",              2,        false, 0,     0);
+add(    jtLEDGER_DATA,   "ledgerData",              4,        false, 0,     0);
 add(    jtCLIENT,        "clientCommand",           maxLimit, false, 2000,  5000);
 add(    jtRPC,           "RPC",                     maxLimit, false, 0,     0);
 add(    jtUPDATE_PF,     "updatePaths",             maxLimit, false, 0,     0);
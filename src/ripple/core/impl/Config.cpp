@@ -317,6 +317,9 @@ void Config::loadFromString (std::string const& fileContents)
     if (getSingleSection (secConfig, SECTION_PEER_PRIVATE, strTemp, j_))
         PEER_PRIVATE        = beast::lexicalCastThrow <bool> (strTemp);
 
+    if (getSingleSection (secConfig, SECTION_COMPRESSION, strTemp, j_))
+        COMPRESSION         = beast::lexicalCastThrow <bool> (strTemp);
+
     if (getSingleSection (secConfig, SECTION_PEERS_MAX, strTemp, j_))
         PEERS_MAX = std::max (0, beast::lexicalCastThrow <int> (strTemp));
 
@@ -343,6 +346,9 @@ void Config::loadFromString (std::string const& fileContents)
         }
     }
 
+    if (getSingleSection (secConfig, SECTION_CACHE_BUDGET, strTemp, j_))
+        CACHE_BUDGET = beast::lexicalCastThrow <std::uint64_t> (strTemp);
+
     if (getSingleSection (secConfig, SECTION_ELB_SUPPORT, strTemp, j_))
         ELB_SUPPORT         = beast::lexicalCastThrow <bool> (strTemp);
 
@@ -537,6 +543,8 @@ int Config::getSize (SizedItemName item) const
 
         { siSweepInterval,      {   10,     30,     60,     90,         120     } },
 
+        { siCacheBudget,        {   256,    512,    1024,   4096,       16384   } },
+
         { siLedgerFetch,        {   2,      2,      3,      3,          3       } },
 
         { siNodeCacheSize,      {   16384,  32768,  131072, 262144,     524288  } },
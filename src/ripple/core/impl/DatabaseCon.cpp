@@ -22,10 +22,40 @@
 #include <ripple/core/SociDB.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
+#include <ripple/core/ConfigSections.h>
+#include <ripple/protocol/JsonFields.h>
+#include <cstring>
 #include <memory>
 
 namespace ripple {
 
+// Run initialization statements, ignoring any which fail
+static
+void
+runInit (soci::session& session,
+    const char* initStrings[], int initCount, bool pragmasOnly)
+{
+    for (int i = 0; i < initCount; ++i)
+    {
+        if (pragmasOnly &&
+            std::strncmp (initStrings[i], "PRAGMA ", 7) != 0)
+        {
+            continue;
+        }
+
+        try
+        {
+            soci::statement st = session.prepare <<
+                initStrings[i];
+            st.execute(true);
+        }
+        catch (soci::soci_error&)
+        {
+            // ignore errors
+        }
+    }
+}
+
 DatabaseCon::DatabaseCon (
     Setup const& setup,
     std::string const& strName,
@@ -41,20 +71,102 @@ DatabaseCon::DatabaseCon (
         ? "" : (setup.dataDir / strName);
 
     open (session_, "sqlite", pPath.string());
+    runInit (session_, initStrings, initCount, false);
 
-    for (int i = 0; i < initCount; ++i)
+    // Readers are opened after the writer has created the schema.
+    // A temporary database is private to its connection, so it
+    // cannot be shared with readers.
+    if (useTempFiles)
+        return;
+
+    readers_.reserve (setup.readers);
+    for (std::size_t i = 0; i < setup.readers; ++i)
     {
-        try
-        {
-            soci::statement st = session_.prepare <<
-                initStrings[i];
-            st.execute(true);
-        }
-        catch (soci::soci_error&)
+        auto reader = std::make_unique <Reader> ();
+        open (reader->session, "sqlite", pPath.string());
+
+        // The schema is the writer's to create, but settings such
+        // as mmap_size belong to each connection.
+        runInit (reader->session, initStrings, initCount, true);
+        reader->session << "PRAGMA query_only=1;";
+        reader->session << "PRAGMA busy_timeout=1000;";
+        readers_.push_back (std::move (reader));
+    }
+}
+
+LockedSociSession DatabaseCon::checkoutDb ()
+{
+    std::unique_lock <LockedSociSession::mutex> lock (
+        lock_, std::try_to_lock);
+    if (! lock.owns_lock ())
+    {
+        auto const start = clock_type::now ();
+        lock.lock ();
+        writeWaits_.record (start);
+    }
+    ++writeWaits_.checkouts;
+    return LockedSociSession (&session_, std::move (lock));
+}
+
+LockedSociSession DatabaseCon::checkoutReadDb ()
+{
+    if (readers_.empty ())
+        return checkoutDb ();
+
+    auto const first = nextReader_++;
+    for (std::size_t i = 0; i < readers_.size (); ++i)
+    {
+        auto& reader = *readers_[(first + i) % readers_.size ()];
+        std::unique_lock <LockedSociSession::mutex> lock (
+            reader.lock, std::try_to_lock);
+        if (lock.owns_lock ())
         {
-            // ignore errors
+            ++readWaits_.checkouts;
+            return LockedSociSession (&reader.session, std::move (lock));
         }
     }
+
+    // Every reader is busy: wait for the one this checkout started at.
+    auto const start = clock_type::now ();
+    auto& reader = *readers_[first % readers_.size ()];
+    std::unique_lock <LockedSociSession::mutex> lock (reader.lock);
+    readWaits_.record (start);
+    ++readWaits_.checkouts;
+    return LockedSociSession (&reader.session, std::move (lock));
+}
+
+Json::Value DatabaseCon::getJson () const
+{
+    Json::Value ret (Json::objectValue);
+    ret[jss::read_connections] = static_cast<Json::UInt> (readers_.size ());
+    ret[jss::reads] = readWaits_.getJson ();
+    ret[jss::writes] = writeWaits_.getJson ();
+    return ret;
+}
+
+void DatabaseCon::Waits::record (clock_type::time_point start)
+{
+    auto const us = std::chrono::duration_cast <
+        std::chrono::microseconds> (clock_type::now () - start).count ();
+
+    ++waits;
+    waitUs += us;
+
+    auto max = maxWaitUs.load ();
+    while (static_cast <std::uint64_t> (us) > max &&
+        ! maxWaitUs.compare_exchange_weak (max, us))
+    {
+    }
+}
+
+Json::Value DatabaseCon::Waits::getJson () const
+{
+    Json::Value ret (Json::objectValue);
+    ret[jss::checkouts] = static_cast<Json::UInt> (checkouts.load ());
+    ret[jss::waits] = static_cast<Json::UInt> (waits.load ());
+    ret[jss::wait_us] = static_cast<Json::UInt> (waitUs.load ());
+    ret[jss::max_wait_us] = static_cast<Json::UInt> (maxWaitUs.load ());
+    return ret;
 }
 
 DatabaseCon::Setup setup_DatabaseCon (Config const& c)
@@ -70,6 +182,9 @@ DatabaseCon::Setup setup_DatabaseCon (Config const& c)
             "database_path must be set.");
     }
 
+    get_if_exists (c.section (SECTION_SQLITE),
+        "read_connections", setup.readers);
+
     return setup;
 }
 
@@ -23,10 +23,11 @@
 #include <ripple/core/JobTypeInfo.h>
 #include <ripple/core/JobTypeData.h>
 #include <ripple/beast/clock/chrono_util.h>
+#include <algorithm>
 #include <chrono>
+#include <exception>
 #include <memory>
 #include <mutex>
-#include <set>
 #include <thread>
 
 namespace ripple {
@@ -37,6 +38,7 @@ JobQueue::JobQueue (beast::insight::Collector::ptr const& collector,
     , m_journal (journal)
     , m_lastJob (0)
     , m_invalidJobData (getJobTypes ().getInvalid (), collector, logs)
+    , m_jobCount (0)
     , m_processCount (0)
     , m_workers (*this, "JobQueue", 0)
     , m_cancelCallback (std::bind (&Stoppable::isStopping, this))
@@ -45,20 +47,23 @@ JobQueue::JobQueue (beast::insight::Collector::ptr const& collector,
     hook = m_collector->make_hook (std::bind (&JobQueue::collect, this));
     job_count = m_collector->make_gauge ("job_count");
 
+    for (auto const& x : getJobTypes ())
     {
-        std::lock_guard <std::mutex> lock (m_mutex);
+        JobTypeInfo const& jt = x.second;
+
+        // And create dynamic information for all jobs
+        auto const result (m_jobData.emplace (std::piecewise_construct,
+            std::forward_as_tuple (jt.type ()),
+            std::forward_as_tuple (jt, m_collector, logs)));
+        assert (result.second == true);
+        (void) result.second;
+    }
 
-        for (auto const& x : getJobTypes ())
-        {
-            JobTypeInfo const& jt = x.second;
-
-            // And create dynamic information for all jobs
-            auto const result (m_jobData.emplace (std::piecewise_construct,
-                std::forward_as_tuple (jt.type ()),
-                std::forward_as_tuple (jt, m_collector, logs)));
-            assert (result.second == true);
-            (void) result.second;
-        }
+    // Later job types have higher priority
+    for (auto iter = m_jobData.rbegin (); iter != m_jobData.rend (); ++iter)
+    {
+        if (! iter->second.info.special ())
+            m_priority.push_back (&iter->second);
     }
 }
 
@@ -71,8 +76,7 @@ JobQueue::~JobQueue ()
 void
 JobQueue::collect ()
 {
-    std::lock_guard <std::mutex> lock (m_mutex);
-    job_count = m_jobSet.size ();
+    job_count = m_jobCount.load ();
 }
 
 void
@@ -104,40 +108,105 @@ JobQueue::addJob (JobType type, std::string const& name,
         //          OR
         //      * Not all children are stopped
         //
-        std::lock_guard <std::mutex> lock (m_mutex);
         assert (! isStopped() && (
             m_processCount>0 ||
-            ! m_jobSet.empty () ||
+            m_jobCount>0 ||
             ! areChildrenStopped()));
     }
 
+    queueJob (Job (type, name, ++m_lastJob,
+        data.load (), func, m_cancelCallback), data);
+}
+
+void
+JobQueue::parallelFor (JobType t, std::string const& name,
+    std::size_t count, int jobs,
+        std::function <void(std::size_t)> const& f)
+{
+    struct State
+    {
+        std::function <void(std::size_t)> const* f;
+        std::size_t count;
+        std::atomic <std::size_t> next {0};
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        int helpers = 0;
+        bool done = false;
+        std::exception_ptr error;
+
+        void run ()
+        {
+            for (std::size_t i; (i = next++) < count;)
+            {
+                try
+                {
+                    (*f) (i);
+                }
+                catch (...)
+                {
+                    std::lock_guard <std::mutex> lock (mutex);
+                    if (! error)
+                        error = std::current_exception ();
+                    next = count;
+                }
+            }
+        }
+    };
+
+    auto state = std::make_shared <State> ();
+    state->f = &f;
+    state->count = count;
+
+    if (! isStopping ())
     {
-        std::lock_guard <std::mutex> lock (m_mutex);
+        auto const helpers = std::min <std::size_t> (
+            std::max (jobs, 1) - 1, count > 0 ? count - 1 : 0);
 
-        std::pair <std::set <Job>::iterator, bool> result (
-            m_jobSet.insert (Job (type, name, ++m_lastJob,
-                data.load (), func, m_cancelCallback)));
-        queueJob (*result.first, lock);
+        for (std::size_t i = 0; i < helpers; ++i)
+        {
+            addJob (t, name,
+                [state] (Job&)
+                {
+                    {
+                        std::lock_guard <std::mutex> lock (state->mutex);
+                        if (state->done)
+                            return;
+                        ++state->helpers;
+                    }
+
+                    state->run ();
+
+                    std::lock_guard <std::mutex> lock (state->mutex);
+                    if (--state->helpers == 0)
+                        state->cv.notify_all ();
+                });
+        }
     }
+
+    state->run ();
+
+    std::unique_lock <std::mutex> lock (state->mutex);
+    state->done = true;
+    state->cv.wait (lock, [&state] { return state->helpers == 0; });
+
+    if (state->error)
+        std::rethrow_exception (state->error);
 }
 
 int
 JobQueue::getJobCount (JobType t) const
 {
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     JobDataMap::const_iterator c = m_jobData.find (t);
 
     return (c == m_jobData.end ())
         ? 0
-        : c->second.waiting;
+        : c->second.waiting.load ();
 }
 
 int
 JobQueue::getJobCountTotal (JobType t) const
 {
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     JobDataMap::const_iterator c = m_jobData.find (t);
 
     return (c == m_jobData.end ())
@@ -151,8 +220,6 @@ JobQueue::getJobCountGE (JobType t) const
     // return the number of jobs at this priority level or greater
     int ret = 0;
 
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     for (auto const& x : m_jobData)
     {
         if (x.first >= t)
@@ -246,8 +313,6 @@ JobQueue::getJson (int c)
 
     Json::Value priorities = Json::arrayValue;
 
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     for (auto& x : m_jobData)
     {
         assert (x.first != jtINVALID);
@@ -301,7 +366,7 @@ JobQueue::rendezvous()
     cv_.wait(lock, [&]
     {
         return m_processCount == 0 &&
-            m_jobSet.empty();
+            m_jobCount == 0;
     });
 }
 
@@ -340,7 +405,7 @@ JobQueue::checkStopped (std::lock_guard <std::mutex> const& lock)
     if (isStopping() &&
         areChildrenStopped() &&
         (m_processCount == 0) &&
-        m_jobSet.empty() &&
+        (m_jobCount == 0) &&
         nSuspend_ == 0)
     {
         stopped();
@@ -348,59 +413,94 @@ JobQueue::checkStopped (std::lock_guard <std::mutex> const& lock)
 }
 
 void
-JobQueue::queueJob (Job const& job, std::lock_guard <std::mutex> const& lock)
+JobQueue::queueJob (Job&& job, JobTypeData& data)
 {
     JobType const type (job.getType ());
     assert (type != jtINVALID);
-    assert (m_jobSet.find (job) != m_jobSet.end ());
-
-    JobTypeData& data (getJobTypeData (type));
+    assert (type == data.type ());
 
-    if (data.waiting + data.running < getJobLimit (type))
-    {
-        m_workers.addTask ();
-    }
-    else
+    bool signal;
     {
-        // defer the task until we go below the limit
-        //
-        ++data.deferred;
+        std::lock_guard <std::mutex> lock (data.mutex);
+
+        data.queue.push_back (std::move (job));
+
+        signal = data.waiting + data.running < getJobLimit (type);
+        if (! signal)
+        {
+            // defer the task until we go below the limit
+            //
+            ++data.deferred;
+        }
+        ++data.waiting;
+        ++m_jobCount;
     }
-    ++data.waiting;
+
+    if (signal)
+        m_workers.addTask ();
 }
 
-void
-JobQueue::getNextJob (Job& job)
+bool
+JobQueue::takeNextJob (Job& job)
 {
-    assert (! m_jobSet.empty ());
-
-    std::set <Job>::const_iterator iter;
-    for (iter = m_jobSet.begin (); iter != m_jobSet.end (); ++iter)
+    for (auto const data : m_priority)
     {
-        JobTypeData& data (getJobTypeData (iter->getType ()));
+        int const limit = getJobLimit (data->type ());
 
-        assert (data.running <= getJobLimit (data.type ()));
+        // Skip types with nothing we may run without taking their lock
+        if (data->waiting == 0 || data->running >= limit)
+            continue;
+
+        std::lock_guard <std::mutex> lock (data->mutex);
+
+        assert (data->running <= limit);
 
         // Run this job if we're running below the limit.
-        if (data.running < getJobLimit (data.type ()))
-        {
-            assert (data.waiting > 0);
-            break;
-        }
+        if (data->queue.empty () || data->running >= limit)
+            continue;
+
+        assert (data->waiting > 0);
+
+        job = std::move (data->queue.front ());
+        data->queue.pop_front ();
+
+        --data->waiting;
+        ++data->running;
+        --m_jobCount;
+        return true;
     }
 
-    assert (iter != m_jobSet.end ());
+    return false;
+}
 
-    JobType const type = iter->getType ();
-    JobTypeData& data (getJobTypeData (type));
+void
+JobQueue::getNextJob (Job& job)
+{
+    if (takeNextJob (job))
+        return;
 
-    assert (type != jtINVALID);
+    // Our task was signaled for a job which another worker took, and
+    // the job we may take instead is held back by a finishing job
+    // which has not yet released its slot. Wait for it to finish.
+    // Registering before looking again means a job which finishes
+    // in between is either seen by the search or wakes us.
+    ++m_finishWaiters;
+    while (true)
+    {
+        std::uint64_t finished;
+        {
+            std::lock_guard <std::mutex> lock (m_finishMutex);
+            finished = m_finishCount;
+        }
 
-    job = *iter;
-    m_jobSet.erase (iter);
+        if (takeNextJob (job))
+            break;
 
-    --data.waiting;
-    ++data.running;
+        std::unique_lock <std::mutex> lock (m_finishMutex);
+        m_finishCond.wait (lock,
+            [this, finished] { return m_finishCount != finished; });
+    }
+    --m_finishWaiters;
 }
 
 void
@@ -410,16 +510,33 @@ JobQueue::finishJob (JobType type)
 
     JobTypeData& data = getJobTypeData (type);
 
-    // Queue a deferred task if possible
-    if (data.deferred > 0)
+    bool signal = false;
     {
-        assert (data.running + data.waiting >= getJobLimit (type));
+        std::lock_guard <std::mutex> lock (data.mutex);
 
-        --data.deferred;
-        m_workers.addTask ();
+        // Queue a deferred task if possible
+        if (data.deferred > 0)
+        {
+            assert (data.running + data.waiting >= getJobLimit (type));
+
+            --data.deferred;
+            signal = true;
+        }
+
+        --data.running;
     }
 
-    --data.running;
+    if (signal)
+        m_workers.addTask ();
+
+    if (m_finishWaiters != 0)
+    {
+        {
+            std::lock_guard <std::mutex> lock (m_finishMutex);
+            ++m_finishCount;
+        }
+        m_finishCond.notify_all ();
+    }
 }
 
 template <class Rep, class Period>
@@ -454,11 +571,12 @@ JobQueue::processTask ()
             Job::clock_type::now());
         {
             Job job;
-            {
-                std::lock_guard <std::mutex> lock (m_mutex);
-                getNextJob (job);
-                ++m_processCount;
-            }
+
+            // Count the task before taking its job, so that the
+            // queue never appears idle while a job is in hand.
+            ++m_processCount;
+            getNextJob (job);
+
             type = job.getType();
             JobTypeData& data(getJobTypeData(type));
             beast::Thread::setCurrentThreadName (data.name ());
@@ -469,13 +587,16 @@ JobQueue::processTask ()
         on_execute(type, Job::clock_type::now() - start_time);
     }
 
+    // Job should be destroyed before calling checkStopped
+    // otherwise destructors with side effects can access
+    // parent objects that are already destroyed.
+    finishJob (type);
+
+    // Only the last task to finish can find the queue idle or stopped
+    if (--m_processCount == 0)
     {
         std::lock_guard <std::mutex> lock (m_mutex);
-        // Job should be destroyed before calling checkStopped
-        // otherwise destructors with side effects can access
-        // parent objects that are already destroyed.
-        finishJob (type);
-        if(--m_processCount == 0 && m_jobSet.empty())
+        if (m_jobCount == 0)
             cv_.notify_all();
         checkStopped (lock);
     }
@@ -20,6 +20,7 @@
 #ifndef RIPPLE_LEDGER_CACHEDSLES_H_INCLUDED
 #define RIPPLE_LEDGER_CACHEDSLES_H_INCLUDED
 
+#include <ripple/basics/CacheBudget.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/protocol/STLedgerEntry.h>
 #include <ripple/beast/container/aged_unordered_map.h>
@@ -28,7 +29,11 @@
 
 namespace ripple {
 
-/** Caches SLEs by their digest. */
+/** Caches SLEs by their digest.
+
+    When attached to a CacheBudget the time to live is shortened
+    while the caches sharing the budget hold too much memory.
+*/
 class CachedSLEs
 {
 public:
@@ -49,6 +54,18 @@ public:
     {
     }
 
+    ~CachedSLEs ();
+
+    /** Share a memory budget with other caches.
+        @note The budget must outlive the cache.
+    */
+    void
+    setBudget (CacheBudget& budget);
+
+    /** Returns the estimated bytes held by the cache. */
+    std::size_t
+    bytes() const;
+
     /** Discard expired entries.
 
         Needs to be called periodically.
@@ -91,6 +108,8 @@ public:
                 digest, std::move(sle));
         if (! result.second)
             map_.touch(result.first);
+        else
+            bytes_ += cost(*result.first->second);
         return  result.first->second;
     }
 
@@ -99,8 +118,14 @@ public:
     rate() const;
 
 private:
+    static
+    std::size_t
+    cost (SLE const& sle);
+
     std::size_t hit_ = 0;
     std::size_t miss_ = 0;
+    std::size_t bytes_ = 0;
+    CacheBudget* budget_ = nullptr;
     std::mutex mutable mutex_;
     Stopwatch::duration timeToLive_;
     beast::aged_unordered_map <digest_type,
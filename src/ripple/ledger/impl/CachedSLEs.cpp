@@ -19,18 +19,54 @@
 
 #include <BeastConfig.h>
 #include <ripple/ledger/CachedSLEs.h>
+#include <cassert>
 #include <vector>
 
 namespace ripple {
 
+CachedSLEs::~CachedSLEs()
+{
+    if (budget_)
+        budget_->erase(this);
+}
+
+void
+CachedSLEs::setBudget (CacheBudget& budget)
+{
+    assert(budget_ == nullptr);
+    budget_ = &budget;
+    budget.insert(this, "CachedSLEs",
+        [this]{ return bytes(); });
+}
+
+std::size_t
+CachedSLEs::bytes() const
+{
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+std::size_t
+CachedSLEs::cost (SLE const& sle)
+{
+    // The object, its fields and the map node holding it
+    return sizeof(SLE) +
+        sle.getCount() * sizeof(detail::STVar) +
+            sizeof(decltype(map_)::value_type) + 4 * sizeof(void*);
+}
+
 void
 CachedSLEs::expire()
 {
     std::vector<
         std::shared_ptr<void const>> trash;
     {
+        auto timeToLive = timeToLive_;
+        if (budget_)
+            timeToLive = budget_->scale(timeToLive);
         auto const expireTime =
-            map_.clock().now() - timeToLive_;
+            map_.clock().now() - timeToLive;
         std::lock_guard<
             std::mutex> lock(mutex_);
         for (auto iter = map_.chronological.begin();
@@ -40,6 +76,7 @@ CachedSLEs::expire()
                 break;
             if (iter->second.unique())
             {
+                bytes_ -= cost(*iter->second);
                 trash.emplace_back(
                     std::move(iter->second));
                 iter = map_.erase(iter);
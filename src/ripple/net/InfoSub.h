@@ -26,7 +26,9 @@
 #include <ripple/resource/Consumer.h>
 #include <ripple/protocol/Book.h>
 #include <ripple/core/Stoppable.h>
+#include <memory>
 #include <mutex>
+#include <string>
 
 namespace ripple {
 
@@ -52,6 +54,38 @@ public:
 
     using Consumer = Resource::Consumer;
 
+    /** A message published to many subscribers.
+
+        The JSON is rendered to text at most once, the first time a
+        subscriber asks for it, and every subscriber shares that copy.
+    */
+    class Message
+    {
+    public:
+        explicit
+        Message (Json::Value json)
+            : json_ (std::move (json))
+        {
+        }
+
+        Message (Message const&) = delete;
+        Message& operator= (Message const&) = delete;
+
+        Json::Value const&
+        json () const
+        {
+            return json_;
+        }
+
+        std::shared_ptr<std::string const> const&
+        text () const;
+
+    private:
+        Json::Value const json_;
+        mutable std::once_flag rendered_;
+        mutable std::shared_ptr<std::string const> text_;
+    };
+
 public:
     /** Abstracts the source of subscription data.
     */
@@ -127,6 +161,12 @@ public:
 
     virtual void send (Json::Value const& jvObj, bool broadcast) = 0;
 
+    /** Send a message shared with other subscribers.
+        Subscribers which can use the rendered text should override this.
+    */
+    virtual void send (std::shared_ptr<Message const> const& message,
+        bool broadcast);
+
     std::uint64_t getSeq ();
 
     void onSendEmpty ();
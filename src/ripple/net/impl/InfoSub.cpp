@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <ripple/net/InfoSub.h>
+#include <ripple/json/to_string.h>
 #include <atomic>
 
 namespace ripple {
@@ -43,6 +44,18 @@ InfoSub::Source::Source (char const* name, Stoppable& parent)
 
 //------------------------------------------------------------------------------
 
+std::shared_ptr<std::string const> const&
+InfoSub::Message::text () const
+{
+    std::call_once (rendered_, [this]
+    {
+        text_ = std::make_shared<std::string const> (to_string (json_));
+    });
+    return text_;
+}
+
+//------------------------------------------------------------------------------
+
 InfoSub::InfoSub(Source& source)
     : m_source(source)
     , mSeq(assign_id())
@@ -82,6 +95,12 @@ Resource::Consumer& InfoSub::getConsumer()
     return m_consumer;
 }
 
+void InfoSub::send (std::shared_ptr<Message const> const& message,
+    bool broadcast)
+{
+    send (message->json (), broadcast);
+}
+
 std::uint64_t InfoSub::getSeq ()
 {
     return mSeq;
@@ -72,6 +72,8 @@ public:
     {
     }
 
+    using InfoSub::send;
+
     void send (Json::Value const& jvObj, bool broadcast)
     {
         ScopedLockType sl (mLock);
@@ -77,12 +77,17 @@ public:
         to refer to the object, or `nullptr` if the object is not present.
         If I/O is required, the I/O is scheduled.
 
+        Scheduled reads are serviced in order of priority, and are
+        batched together when the backend supports it.
+
         @note This can be called concurrently.
         @param hash The key of the object to retrieve
         @param object The object retrieved
+        @param priority The urgency of the read, if one is scheduled
         @return Whether the operation completed
     */
-    virtual bool asyncFetch (uint256 const& hash, std::shared_ptr<NodeObject>& object) = 0;
+    virtual bool asyncFetch (uint256 const& hash, std::shared_ptr<NodeObject>& object,
+        FetchPriority priority = FetchPriority::normal) = 0;
 
     /** Wait for all currently pending async reads to complete.
     */
@@ -129,6 +134,10 @@ public:
     /** Get the positive cache hits to total attempts ratio. */
     virtual float getCacheHitRate () = 0;
 
+    /** Get the activity counters of each positive cache partition. */
+    virtual std::vector <TaggedCachePartitionStats>
+    getCachePartitionStats () const = 0;
+
     /** Set the maximum number of entries and maximum cache age for both caches.
 
         @param size Number of cache entries (0 = ignore)
@@ -136,6 +145,12 @@ public:
     */
     virtual void tune (int size, int age) = 0;
 
+    /** Charge both caches against a memory budget shared with other caches.
+
+        @note The budget must outlive the database.
+    */
+    virtual void setCacheBudget (CacheBudget& budget) = 0;
+
     /** Remove expired entries from the positive and negative caches. */
     virtual void sweep () = 0;
 
@@ -145,6 +160,7 @@ public:
     virtual std::uint32_t getStoreCount () const = 0;
     virtual std::uint32_t getFetchTotalCount () const = 0;
     virtual std::uint32_t getFetchHitCount () const = 0;
+    virtual std::uint32_t getFetchErrorCount () const = 0;
     virtual std::uint32_t getStoreSize () const = 0;
     virtual std::uint32_t getFetchSize () const = 0;
 
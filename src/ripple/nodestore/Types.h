@@ -46,6 +46,16 @@ enum Status
     customCode = 100
 };
 
+/** The urgency of an asynchronous fetch.
+    Pending reads are serviced in priority order.
+*/
+enum class FetchPriority
+{
+    high,       // Needed to make progress on the current ledger
+    normal,
+    low         // Backfilling history
+};
+
 /** A batch of NodeObjects to write at once. */
 using Batch = std::vector <std::shared_ptr<NodeObject>>;
 }
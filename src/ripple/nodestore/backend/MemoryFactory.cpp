@@ -132,14 +132,22 @@ public:
     bool
     canFetchBatch() override
     {
-        return false;
+        return true;
     }
 
     std::vector<std::shared_ptr<NodeObject>>
     fetchBatch (std::size_t n, void const* const* keys) override
     {
-        Throw<std::runtime_error> ("pure virtual called");
-        return {};
+        std::vector<std::shared_ptr<NodeObject>> results (n);
+        std::lock_guard<std::mutex> _(db_->mutex);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            uint256 const hash (uint256::fromVoid (keys[i]));
+            auto const iter = db_->table.find (hash);
+            if (iter != db_->table.end ())
+                results[i] = iter->second;
+        }
+        return results;
     }
 
     void
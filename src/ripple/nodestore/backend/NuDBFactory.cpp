@@ -28,13 +28,21 @@
 #include <ripple/beast/nudb.h>
 #include <ripple/beast/nudb/visit.h>
 #include <ripple/beast/hash/xxhasher.h>
+#include <ripple/beast/core/Thread.h>
 #include <boost/filesystem.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdint>
+#include <deque>
 #include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 namespace ripple {
 namespace NodeStore {
@@ -49,7 +57,11 @@ public:
         // distribution of data sizes.
         arena_alloc_size = 16 * 1024 * 1024,
 
-        currentType = 1
+        currentType = 1,
+
+        // Number of reads a batch fetch keeps
+        // outstanding, if not configured.
+        defaultQueueDepth = 4
     };
 
     using api = beast::nudb::api<
@@ -62,6 +74,16 @@ public:
     std::atomic <bool> deletePath_;
     Scheduler& scheduler_;
 
+    // Batch fetches spread their reads over the calling thread
+    // and these, so the device sees several requests at once.
+    std::size_t const queueDepth_;
+    std::mutex readMutex_;
+    std::condition_variable readCond_;
+    std::condition_variable readDoneCond_;
+    std::deque <std::function <void()>> readWork_;
+    std::vector <std::thread> readers_;
+    bool readStop_ = false;
+
     NuDBBackend (int keyBytes, Section const& keyValues,
         Scheduler& scheduler, beast::Journal journal)
         : journal_ (journal)
@@ -69,6 +91,8 @@ public:
         , name_ (get<std::string>(keyValues, "path"))
         , deletePath_(false)
         , scheduler_ (scheduler)
+        , queueDepth_ (std::max <std::size_t> (1, get <std::size_t> (
+            keyValues, "queue_depth", defaultQueueDepth)))
     {
         if (name_.empty())
             Throw<std::runtime_error> (
@@ -96,6 +120,9 @@ public:
             std::cerr << e.what();
             std::terminate();
         }
+
+        for (std::size_t i = 1; i < queueDepth_; ++i)
+            readers_.emplace_back (&NuDBBackend::readerEntry, this);
     }
 
     ~NuDBBackend ()
@@ -112,6 +139,8 @@ public:
     void
     close() override
     {
+        stopReaders();
+
         if (db_.is_open())
         {
             db_.close();
@@ -148,14 +177,123 @@ public:
     bool
     canFetchBatch() override
     {
-        return false;
+        return true;
     }
 
     std::vector<std::shared_ptr<NodeObject>>
     fetchBatch (std::size_t n, void const* const* keys) override
     {
-        Throw<std::runtime_error> ("pure virtual called");
-        return {};
+        // Visit the keys in key file bucket order, so that
+        // the reads sweep forward through the key file
+        // instead of seeking back and forth.
+        std::vector <std::pair <std::size_t, std::size_t>> order;
+        order.reserve (n);
+        for (std::size_t i = 0; i < n; ++i)
+            order.emplace_back (db_.bucket_of (keys[i]), i);
+        std::sort (order.begin (), order.end ());
+
+        std::vector<std::shared_ptr<NodeObject>> results (n);
+        std::atomic <std::size_t> next {0};
+        std::exception_ptr error;
+
+        // Each reader claims the next key in bucket order until
+        // none remain, so the sweep stays roughly sequential.
+        auto const drain = [&]()
+        {
+            try
+            {
+                for (std::size_t i; (i = next++) < n;)
+                {
+                    auto const index = order[i].second;
+                    if (fetch (keys[index], &results[index]) == dataCorrupt)
+                    {
+                        JLOG(journal_.error()) <<
+                            "Corrupt NodeObject in batch fetch";
+                    }
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard <std::mutex> lock (readMutex_);
+                if (! error)
+                    error = std::current_exception ();
+                next = n;
+            }
+        };
+
+        // Once the readers are stopped nothing would run queued
+        // work, so after close() the caller reads everything itself.
+        std::size_t pending = 0;
+        {
+            std::lock_guard <std::mutex> lock (readMutex_);
+            if (! readStop_ && n > 1)
+                pending = std::min (queueDepth_ - 1, n - 1);
+            for (std::size_t i = 0; i < pending; ++i)
+            {
+                readWork_.emplace_back ([&]()
+                {
+                    drain ();
+                    std::lock_guard <std::mutex> lock (readMutex_);
+                    if (--pending == 0)
+                        readDoneCond_.notify_all ();
+                });
+            }
+        }
+        if (pending != 0)
+            readCond_.notify_all ();
+
+        drain ();
+
+        {
+            // The helpers refer to our locals, wait for all of them
+            std::unique_lock <std::mutex> lock (readMutex_);
+            readDoneCond_.wait (lock, [&]{ return pending == 0; });
+        }
+
+        if (error)
+            std::rethrow_exception (error);
+
+        return results;
+    }
+
+    void
+    readerEntry ()
+    {
+        beast::Thread::setCurrentThreadName ("nudb read");
+
+        std::unique_lock <std::mutex> lock (readMutex_);
+        for (;;)
+        {
+            readCond_.wait (lock, [this]
+            {
+                return readStop_ || ! readWork_.empty ();
+            });
+
+            // Finish any queued work first, a batch may be waiting on it
+            if (readWork_.empty ())
+                break;
+
+            auto work = std::move (readWork_.front ());
+            readWork_.pop_front ();
+
+            lock.unlock ();
+            work ();
+            lock.lock ();
+        }
+    }
+
+    void
+    stopReaders ()
+    {
+        {
+            std::lock_guard <std::mutex> lock (readMutex_);
+            readStop_ = true;
+        }
+        readCond_.notify_all ();
+
+        for (auto& t : readers_)
+            t.join ();
+        readers_.clear ();
     }
 
     void
@@ -31,6 +31,8 @@
 #include <ripple/basics/Slice.h>
 #include <ripple/basics/TaggedCache.h>
 #include <ripple/beast/core/Thread.h>
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <condition_variable>
 #include <set>
@@ -54,11 +56,16 @@ protected:
     // Negative cache
     KeyCache <uint256> m_negCache;
 private:
+    // One queue of reads for each FetchPriority
+    static std::size_t constexpr readPriorities = 3;
+
     std::mutex                m_readLock;
     std::condition_variable   m_readCondVar;
     std::condition_variable   m_readGenCondVar;
-    std::set <uint256>        m_readSet;        // set of reads to do
-    uint256                   m_readLast;       // last hash read
+    std::array <std::set <uint256>, readPriorities>
+                              m_readSet;        // sets of reads to do
+    std::array <uint256, readPriorities>
+                              m_readLast;       // last hash read
     std::vector <std::thread> m_readThreads;
     bool                      m_readShut;
     uint64_t                  m_readGen;        // current read generation
@@ -74,7 +81,8 @@ public:
         , m_scheduler (scheduler)
         , m_backend (std::move (backend))
         , m_cache ("NodeStore", cacheTargetSize, cacheTargetSeconds,
-            stopwatch(), journal)
+            stopwatch(), journal, beast::insight::NullCollector::New (),
+                cachePartitions)
         , m_negCache ("NodeStore", stopwatch(),
             cacheTargetSize, cacheTargetSeconds)
         , m_readShut (false)
@@ -82,9 +90,15 @@ public:
         , m_storeCount (0)
         , m_fetchTotalCount (0)
         , m_fetchHitCount (0)
+        , m_fetchErrorCount (0)
         , m_storeSize (0)
         , m_fetchSize (0)
     {
+        m_cache.setCostFunction ([](NodeObject const& object)
+            {
+                return sizeof (NodeObject) + object.getData ().capacity ();
+            });
+
         for (int i = 0; i < readThreads; ++i)
             m_readThreads.emplace_back (&DatabaseImp::threadEntry, this);
 
@@ -123,7 +137,8 @@ public:
 
     //------------------------------------------------------------------------------
 
-    bool asyncFetch (uint256 const& hash, std::shared_ptr<NodeObject>& object) override
+    bool asyncFetch (uint256 const& hash, std::shared_ptr<NodeObject>& object,
+        FetchPriority priority) override
     {
         // See if the object is in cache
         object = m_cache.fetch (hash);
@@ -133,13 +148,43 @@ public:
         {
             // No. Post a read
             std::lock_guard <std::mutex> lock (m_readLock);
-            if (m_readSet.insert (hash).second)
+            if (queueRead (hash, static_cast <std::size_t> (priority)))
                 m_readCondVar.notify_one ();
         }
 
         return false;
     }
 
+    // Queue a read at the given priority, promoting it if it is
+    // already queued at a lower one. Returns `true` if queued.
+    // Must be called with m_readLock held.
+    bool queueRead (uint256 const& hash, std::size_t priority)
+    {
+        for (std::size_t i = 0; i < priority; ++i)
+        {
+            if (m_readSet[i].count (hash) != 0)
+                return false;
+        }
+
+        if (! m_readSet[priority].insert (hash).second)
+            return false;
+
+        for (std::size_t i = priority + 1; i < readPriorities; ++i)
+            m_readSet[i].erase (hash);
+
+        return true;
+    }
+
+    // Must be called with m_readLock held.
+    bool readsPending () const
+    {
+        return std::any_of (m_readSet.begin (), m_readSet.end (),
+            [](std::set <uint256> const& s)
+            {
+                return ! s.empty ();
+            });
+    }
+
     void waitReads() override
     {
         {
@@ -148,7 +193,7 @@ public:
             // Wake in two generations
             std::uint64_t const wakeGeneration = m_readGen + 2;
 
-            while (!m_readShut && !m_readSet.empty () && (m_readGen < wakeGeneration))
+            while (!m_readShut && readsPending () && (m_readGen < wakeGeneration))
                 m_readGenCondVar.wait (lock);
         }
 
@@ -159,7 +204,8 @@ public:
         // We prefer a client not fill our cache
         // We don't want to push data out of the cache
         // before it's retrieved
-        return m_cache.getTargetSize() / asyncDivider;
+        int const size = m_cache.getTargetSize ();
+        return (size != 0 ? size : cacheTargetSize) / asyncDivider;
     }
 
     std::shared_ptr<NodeObject> fetch (uint256 const& hash) override
@@ -238,11 +284,75 @@ public:
         return obj;
     }
 
+    /** Fetch a group of objects from disk and cache the results.
+        The hashes are known to have been missing from the caches.
+    */
+    void doTimedFetchBatch (std::vector <uint256> const& hashes)
+    {
+        // Skip anything which arrived while the read was queued
+        std::vector <uint256> wanted;
+        wanted.reserve (hashes.size ());
+        for (auto const& hash : hashes)
+        {
+            if (! m_cache.fetch (hash) && ! m_negCache.touch_if_exists (hash))
+                wanted.push_back (hash);
+        }
+
+        if (wanted.empty ())
+            return;
+
+        auto const before = std::chrono::steady_clock::now();
+        auto objects = fetchBatchFrom (wanted);
+        auto const elapsed = std::chrono::duration_cast <std::chrono::milliseconds>
+            (std::chrono::steady_clock::now() - before);
+        m_fetchTotalCount += wanted.size ();
+
+        FetchReport report;
+        report.isAsync = true;
+        report.wentToDisk = true;
+        // The batch cost is shared by its members
+        report.elapsed = elapsed / wanted.size ();
+
+        for (std::size_t i = 0; i < wanted.size (); ++i)
+        {
+            auto& obj = objects[i];
+            report.wasFound = (obj != nullptr);
+
+            if (obj)
+            {
+                // Ensure all threads get the same object
+                m_cache.canonicalize (wanted[i], obj);
+            }
+            else if (! m_cache.fetch (wanted[i]))
+            {
+                // We give up
+                m_negCache.insert (wanted[i]);
+            }
+
+            m_scheduler.onFetch (report);
+        }
+    }
+
     virtual std::shared_ptr<NodeObject> fetchFrom (uint256 const& hash)
     {
         return fetchInternal (*m_backend, hash);
     }
 
+    /** Return `true` if the backend is efficient at batch fetches. */
+    virtual bool canFetchBatch ()
+    {
+        return m_backend && m_backend->canFetchBatch ();
+    }
+
+    /** Fetch a group of objects from the backend.
+        The results correspond to the hashes, in order.
+    */
+    virtual std::vector <std::shared_ptr<NodeObject>>
+    fetchBatchFrom (std::vector <uint256> const& hashes)
+    {
+        return fetchBatchInternal (*m_backend, hashes);
+    }
+
     std::shared_ptr<NodeObject> fetchInternal (Backend& backend,
         uint256 const& hash)
     {
@@ -275,6 +385,60 @@ public:
         return object;
     }
 
+    std::vector <std::shared_ptr<NodeObject>>
+    fetchBatchInternal (Backend& backend,
+        std::vector <uint256> const& hashes)
+    {
+        std::vector <void const*> keys;
+        keys.reserve (hashes.size ());
+        for (auto const& hash : hashes)
+            keys.push_back (hash.begin ());
+
+        std::vector <std::shared_ptr<NodeObject>> objects;
+        try
+        {
+            objects = backend.fetchBatch (keys.size (), keys.data ());
+        }
+        catch (std::exception const& e)
+        {
+            // This runs on the read threads, so the error must not
+            // escape. Fall back to reading the objects one at a time.
+            ++m_fetchErrorCount;
+            JLOG(m_journal.error()) <<
+                "Batch fetch of " << hashes.size () <<
+                " objects failed: " << e.what ();
+
+            objects.clear ();
+            objects.reserve (hashes.size ());
+            for (auto const& hash : hashes)
+            {
+                try
+                {
+                    objects.push_back (fetchInternal (backend, hash));
+                }
+                catch (std::exception const& e)
+                {
+                    ++m_fetchErrorCount;
+                    JLOG(m_journal.error()) <<
+                        "Fetch of #" << hash << " failed: " << e.what ();
+                    objects.emplace_back ();
+                }
+            }
+            return objects;
+        }
+
+        for (auto const& object : objects)
+        {
+            if (object)
+            {
+                ++m_fetchHitCount;
+                m_fetchSize += object->getData().size();
+            }
+        }
+
+        return objects;
+    }
+
     //------------------------------------------------------------------------------
 
     void store (NodeObjectType type,
@@ -313,6 +477,12 @@ public:
         return m_cache.getHitRate ();
     }
 
+    std::vector <TaggedCachePartitionStats>
+    getCachePartitionStats () const override
+    {
+        return m_cache.getPartitionStats ();
+    }
+
     void tune (int size, int age) override
     {
         m_cache.setTargetSize (size);
@@ -321,6 +491,12 @@ public:
         m_negCache.setTargetAge (age);
     }
 
+    void setCacheBudget (CacheBudget& budget) override
+    {
+        m_cache.setBudget (budget);
+        m_negCache.setBudget (budget);
+    }
+
     void sweep () override
     {
         m_cache.sweep ();
@@ -345,14 +521,20 @@ public:
     void threadEntryImpl ()
     {
         beast::Thread::setCurrentThreadName ("prefetch");
+        std::vector <uint256> hashes;
+        hashes.reserve (asyncBatchSize);
+
         while (1)
         {
-            uint256 hash;
+            // Decided outside the lock, since asking a
+            // rotating database takes its rotation lock.
+            bool const batch = canFetchBatch ();
+            hashes.clear ();
 
             {
                 std::unique_lock <std::mutex> lock (m_readLock);
 
-                while (!m_readShut && m_readSet.empty ())
+                while (!m_readShut && !readsPending ())
                 {
                     // all work is done
                     m_readGenCondVar.notify_all ();
@@ -362,27 +544,56 @@ public:
                 if (m_readShut)
                     break;
 
-                // Read in key order to make the back end more efficient
-                std::set <uint256>::iterator it = m_readSet.lower_bound (m_readLast);
-                if (it == m_readSet.end ())
-                {
-                    it = m_readSet.begin ();
-
-                    // A generation has completed
-                    ++m_readGen;
-                    m_readGenCondVar.notify_all ();
-                }
-
-                hash = *it;
-                m_readSet.erase (it);
-                m_readLast = hash;
+                takeReads (hashes, batch ? asyncBatchSize : 1);
             }
 
-            // Perform the read
-            doTimedFetch (hash, true);
+            // Perform the reads
+            if (hashes.size () > 1)
+            {
+                doTimedFetchBatch (hashes);
+            }
+            else
+            {
+                for (auto const& hash : hashes)
+                    doTimedFetch (hash, true);
+            }
          }
      }
 
+    // Remove up to `limit` reads from the most urgent non-empty queue.
+    // Must be called with m_readLock held.
+    void takeReads (std::vector <uint256>& hashes, std::size_t limit)
+    {
+        auto const iter = std::find_if (m_readSet.begin (), m_readSet.end (),
+            [](std::set <uint256> const& s)
+            {
+                return ! s.empty ();
+            });
+        if (iter == m_readSet.end ())
+            return;
+
+        auto& readSet = *iter;
+        auto& readLast = m_readLast[iter - m_readSet.begin ()];
+
+        // Read in key order to make the back end more efficient
+        auto it = readSet.lower_bound (readLast);
+        while (hashes.size () < limit && ! readSet.empty ())
+        {
+            if (it == readSet.end ())
+            {
+                it = readSet.begin ();
+
+                // A generation has completed
+                ++m_readGen;
+                m_readGenCondVar.notify_all ();
+            }
+
+            hashes.push_back (*it);
+            readLast = *it;
+            it = readSet.erase (it);
+        }
+    }
+
     //------------------------------------------------------------------------------
 
     void for_each (std::function <void(std::shared_ptr<NodeObject>)> f) override
@@ -434,6 +645,11 @@ public:
         return m_fetchHitCount;
     }
 
+    std::uint32_t getFetchErrorCount () const override
+    {
+        return m_fetchErrorCount;
+    }
+
     std::uint32_t getStoreSize () const override
     {
         return m_storeSize;
@@ -453,6 +669,7 @@ private:
     std::atomic <std::uint32_t> m_storeCount;
     std::atomic <std::uint32_t> m_fetchTotalCount;
     std::atomic <std::uint32_t> m_fetchHitCount;
+    std::atomic <std::uint32_t> m_fetchErrorCount;
     std::atomic <std::uint32_t> m_storeSize;
     std::atomic <std::uint32_t> m_fetchSize;
 };
@@ -50,6 +50,40 @@ std::shared_ptr<NodeObject> DatabaseRotatingImp::fetchFrom (uint256 const& hash)
 
     return object;
 }
+
+std::vector <std::shared_ptr<NodeObject>>
+DatabaseRotatingImp::fetchBatchFrom (std::vector <uint256> const& hashes)
+{
+    Backends b = getBackends();
+    auto objects = fetchBatchInternal (*b.writableBackend, hashes);
+
+    std::vector <uint256> missing;
+    std::vector <std::size_t> index;
+    for (std::size_t i = 0; i < objects.size (); ++i)
+    {
+        if (! objects[i])
+        {
+            missing.push_back (hashes[i]);
+            index.push_back (i);
+        }
+    }
+
+    if (missing.empty ())
+        return objects;
+
+    auto archived = fetchBatchInternal (*b.archiveBackend, missing);
+    for (std::size_t i = 0; i < archived.size (); ++i)
+    {
+        if (archived[i])
+        {
+            b.writableBackend->store (archived[i]);
+            m_negCache.erase (missing[i]);
+            objects[index[i]] = std::move (archived[i]);
+        }
+    }
+
+    return objects;
+}
 }
 
 }
@@ -125,6 +125,17 @@ public:
     }
 
     std::shared_ptr<NodeObject> fetchFrom (uint256 const& hash) override;
+
+    bool canFetchBatch () override
+    {
+        Backends b = getBackends();
+        return b.writableBackend->canFetchBatch () &&
+            b.archiveBackend->canFetchBatch ();
+    }
+
+    std::vector <std::shared_ptr<NodeObject>>
+    fetchBatchFrom (std::vector <uint256> const& hashes) override;
+
     TaggedCache <uint256, NodeObject>& getPositiveCache() override
     {
         return m_cache;
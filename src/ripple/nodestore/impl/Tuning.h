@@ -33,6 +33,12 @@ enum
 
     // Fraction of the cache one query source can take
     ,asyncDivider = 8
+
+    // Number of independently locked partitions in the positive cache
+    ,cachePartitions = 16
+
+    // Largest number of async reads handed to the backend at once
+    ,asyncBatchSize = 64
 };
 
 }
@@ -27,7 +27,9 @@
 #include <ripple/beast/utility/rngfill.h>
 #include <ripple/beast/xor_shift_engine.h>
 #include <boost/algorithm/string.hpp>
+#include <chrono>
 #include <iomanip>
+#include <thread>
 
 namespace ripple {
 namespace NodeStore {
@@ -168,6 +170,27 @@ public:
         }
     }
 
+    // Get a copy of a batch in a backend, using a single batch fetch
+    void fetchBatchCopyOfBatch (Backend& backend, Batch* pCopy, Batch const& batch)
+    {
+        std::vector <void const*> keys;
+        keys.reserve (batch.size ());
+        for (auto const& object : batch)
+            keys.push_back (object->getHash ().cbegin ());
+
+        auto objects = backend.fetchBatch (keys.size (), keys.data ());
+        BEAST_EXPECT(objects.size () == batch.size ());
+
+        pCopy->clear ();
+        for (auto& object : objects)
+        {
+            BEAST_EXPECT(object != nullptr);
+
+            if (object != nullptr)
+                pCopy->push_back (std::move (object));
+        }
+    }
+
     void fetchMissing(Backend& backend, Batch const& batch)
     {
         for (int i = 0; i < batch.size (); ++i)
@@ -212,6 +235,37 @@ public:
                 pCopy->push_back (object);
         }
     }
+
+    // Queue asynchronous reads of all the hashes, at mixed
+    // priorities, then collect the results into another batch.
+    static void fetchAsyncCopyOfBatch (Database& db,
+                                       Batch* pCopy,
+                                       Batch const& batch)
+    {
+        std::shared_ptr<NodeObject> object;
+        for (int i = 0; i < batch.size (); ++i)
+            db.asyncFetch (batch [i]->getHash (), object,
+                static_cast <FetchPriority> (i % 3));
+
+        db.waitReads ();
+
+        pCopy->clear ();
+        pCopy->reserve (batch.size ());
+
+        for (int i = 0; i < batch.size (); ++i)
+        {
+            // The last reads may still be completing
+            int tries = 0;
+            while (! db.asyncFetch (batch [i]->getHash (), object) &&
+                ++tries < 100)
+            {
+                std::this_thread::sleep_for (std::chrono::milliseconds (10));
+            }
+
+            if (object != nullptr)
+                pCopy->push_back (object);
+        }
+    }
 };
 
 }
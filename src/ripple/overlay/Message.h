@@ -27,7 +27,9 @@
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <type_traits>
+#include <vector>
 
 namespace ripple {
 
@@ -43,6 +45,11 @@ namespace ripple {
 // a string prepended by a header specifying the message length.
 // MessageType should be a Message class generated by the protobuf compiler.
 //
+// For peers which accept it, a large message may instead be sent
+// compressed. The high bit of the length is set and the payload is the
+// four byte big-endian length of the packed message followed by the
+// message compressed as an LZ4 block.
+//
 
 class Message : public std::enable_shared_from_this <Message>
 {
@@ -54,6 +61,10 @@ public:
     */
     static size_t const kHeaderBytes = 6;
 
+    /** Set in the length of a compressed message.
+    */
+    static std::uint32_t const kCompressedBit = 0x80000000;
+
     Message (::google::protobuf::Message const& message, int type);
 
     /** Retrieve the packed message data. */
@@ -63,6 +74,16 @@ public:
         return mBuffer;
     }
 
+    /** Retrieve the data to send to a peer.
+
+        If the peer accepts compressed messages and the message is
+        large enough, the message is compressed by the first call and
+        the compressed data is returned to every caller after it.
+        Messages which do not shrink are sent as they are.
+    */
+    std::vector <uint8_t> const&
+    getBuffer (bool compressed) const;
+
     /** Get the traffic category */
     int
     getCategory () const
@@ -91,7 +112,7 @@ public:
         n += std::size_t{*first++} << 16;
         n += std::size_t{*first++} <<  8;
         n += std::size_t{*first};
-        return n;
+        return n & ~std::size_t{kCompressedBit};
     }
 
     template <class BufferSequence>
@@ -104,6 +125,23 @@ public:
     }
     /** @} */
 
+    /** Determine whether a packed message is compressed. */
+    template <class BufferSequence>
+    static
+    bool
+    compressed (BufferSequence const& buffers)
+    {
+        auto first = buffers_begin(buffers);
+        if (std::distance(first, buffers_end(buffers)) <
+                Message::kHeaderBytes)
+            return false;
+        return (*first & 0x80) != 0;
+    }
+
+    /** Encode a message header. */
+    static void encodeHeader (std::uint8_t* header,
+        std::uint32_t size, int type);
+
     /** Determine the type of a packed message. */
     /** @{ */
     static int getType (std::vector <uint8_t> const& buf);
@@ -150,12 +188,14 @@ private:
             BufferSequence, Value>::end (buffers);
     }
 
-        // Encodes the size and type into a header at the beginning of buf
-    //
-    void encodeHeader (unsigned size, int type);
+    void compress () const;
 
     std::vector <uint8_t> mBuffer;
 
+    // Filled once, by the first peer wanting it compressed
+    std::once_flag mutable mCompressOnce;
+    std::vector <uint8_t> mutable mCompressed;
+
     int mCategory;
 };
 
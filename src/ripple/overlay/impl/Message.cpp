@@ -20,6 +20,8 @@
 #include <BeastConfig.h>
 #include <ripple/overlay/Message.h>
 #include <ripple/overlay/impl/TrafficCount.h>
+#include <ripple/overlay/impl/Tuning.h>
+#include <lz4/lib/lz4.h>
 #include <cstdint>
 
 namespace ripple {
@@ -32,7 +34,7 @@ Message::Message (::google::protobuf::Message const& message, int type)
 
     mBuffer.resize (kHeaderBytes + messageBytes);
 
-    encodeHeader (messageBytes, type);
+    encodeHeader (mBuffer.data (), messageBytes, type);
 
     if (messageBytes != 0)
     {
@@ -43,6 +45,47 @@ Message::Message (::google::protobuf::Message const& message, int type)
         (message, type, false));
 }
 
+std::vector <uint8_t> const&
+Message::getBuffer (bool compressed) const
+{
+    if (! compressed ||
+            mBuffer.size () < kHeaderBytes + Tuning::minCompressBytes)
+        return mBuffer;
+
+    std::call_once (mCompressOnce, [this] { compress (); });
+
+    if (mCompressed.empty ())
+        return mBuffer;
+    return mCompressed;
+}
+
+void Message::compress () const
+{
+    auto const inSize = static_cast<int> (mBuffer.size () - kHeaderBytes);
+    auto const bound = LZ4_compressBound (inSize);
+    if (bound <= 0)
+        return;
+
+    std::vector <uint8_t> out (kHeaderBytes + 4 + bound);
+    auto const outSize = LZ4_compress_default (
+        reinterpret_cast<char const*> (&mBuffer[kHeaderBytes]),
+        reinterpret_cast<char*> (&out[kHeaderBytes + 4]),
+        inSize, bound);
+
+    // Not worth it
+    if (outSize <= 0 || 4 + outSize >= inSize)
+        return;
+
+    out.resize (kHeaderBytes + 4 + outSize);
+    encodeHeader (out.data (), (4 + outSize) | kCompressedBit,
+        getType (mBuffer));
+    out[kHeaderBytes + 0] = static_cast<std::uint8_t> ((inSize >> 24) & 0xFF);
+    out[kHeaderBytes + 1] = static_cast<std::uint8_t> ((inSize >> 16) & 0xFF);
+    out[kHeaderBytes + 2] = static_cast<std::uint8_t> ((inSize >> 8) & 0xFF);
+    out[kHeaderBytes + 3] = static_cast<std::uint8_t> (inSize & 0xFF);
+    mCompressed = std::move (out);
+}
+
 bool Message::operator== (Message const& other) const
 {
     return mBuffer == other.mBuffer;
@@ -61,6 +104,7 @@ unsigned Message::getLength (std::vector <uint8_t> const& buf)
         result |= buf [2];
         result <<= 8;
         result |= buf [3];
+        result &= ~kCompressedBit;
     }
     else
     {
@@ -81,15 +125,15 @@ int Message::getType (std::vector<uint8_t> const& buf)
     return ret;
 }
 
-void Message::encodeHeader (unsigned size, int type)
+void Message::encodeHeader (std::uint8_t* header,
+    std::uint32_t size, int type)
 {
-    assert (mBuffer.size () >= Message::kHeaderBytes);
-    mBuffer[0] = static_cast<std::uint8_t> ((size >> 24) & 0xFF);
-    mBuffer[1] = static_cast<std::uint8_t> ((size >> 16) & 0xFF);
-    mBuffer[2] = static_cast<std::uint8_t> ((size >> 8) & 0xFF);
-    mBuffer[3] = static_cast<std::uint8_t> (size & 0xFF);
-    mBuffer[4] = static_cast<std::uint8_t> ((type >> 8) & 0xFF);
-    mBuffer[5] = static_cast<std::uint8_t> (type & 0xFF);
+    header[0] = static_cast<std::uint8_t> ((size >> 24) & 0xFF);
+    header[1] = static_cast<std::uint8_t> ((size >> 16) & 0xFF);
+    header[2] = static_cast<std::uint8_t> ((size >> 8) & 0xFF);
+    header[3] = static_cast<std::uint8_t> (size & 0xFF);
+    header[4] = static_cast<std::uint8_t> ((type >> 8) & 0xFF);
+    header[5] = static_cast<std::uint8_t> (type & 0xFF);
 }
 
 }
@@ -154,6 +154,7 @@ OverlayImpl::OverlayImpl (
         stopwatch(), app_.journal("PeerFinder"), config))
     , m_resolver (resolver)
     , next_id_(1)
+    , txVerifier_ (app_, journal_)
     , timer_count_(0)
 {
     beast::PropertyStream::Source::add (m_peerFinder.get());
@@ -657,6 +658,18 @@ OverlayImpl::onWrite (beast::PropertyStream::Map& stream)
         item["messages_out"] =
             beast::lexicalCast<std::string>
                 (i.second.messagesOut.load());
+
+        // Uncompressed bytes per byte on the wire
+        auto const ratio = [](unsigned long raw, unsigned long wire)
+        {
+            return wire == 0 ? std::string ("1") :
+                beast::lexicalCast<std::string> (
+                    static_cast<double> (raw) / wire);
+        };
+        item["compression_in"] = ratio (
+            i.second.uncompressedBytesIn.load(), i.second.bytesIn.load());
+        item["compression_out"] = ratio (
+            i.second.uncompressedBytesOut.load(), i.second.bytesOut.load());
     }
 }
 
@@ -779,9 +792,10 @@ void
 OverlayImpl::reportTraffic (
     TrafficCount::category cat,
     bool isInbound,
-    int number)
+    int number,
+    int uncompressed)
 {
-    m_traffic.addCount (cat, isInbound, number);
+    m_traffic.addCount (cat, isInbound, number, uncompressed);
 }
 
 std::size_t
@@ -25,6 +25,7 @@
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/impl/Manifest.h>
 #include <ripple/overlay/impl/TrafficCount.h>
+#include <ripple/overlay/impl/TxVerifier.h>
 #include <ripple/server/Handoff.h>
 #include <ripple/rpc/ServerHandler.h>
 #include <ripple/basics/Resolver.h>
@@ -119,6 +120,7 @@ private:
     Resolver& m_resolver;
     std::atomic <Peer::id_t> next_id_;
     ManifestCache manifestCache_;
+    TxVerifier txVerifier_;
     int timer_count_;
 
     //--------------------------------------------------------------------------
@@ -164,6 +166,12 @@ public:
         return setup_;
     }
 
+    TxVerifier&
+    txVerifier()
+    {
+        return txVerifier_;
+    }
+
     Handoff
     onHandoff (std::unique_ptr <beast::asio::ssl_bundle>&& bundle,
         http_request_type&& request,
@@ -268,7 +276,8 @@ public:
     reportTraffic (
         TrafficCount::category cat,
         bool isInbound,
-        int bytes);
+        int bytes,
+        int uncompressedBytes);
 
 private:
     std::shared_ptr<Writer>
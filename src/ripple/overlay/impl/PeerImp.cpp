@@ -87,6 +87,7 @@ PeerImp::PeerImp (Application& app, id_t id, endpoint_type remote_endpoint,
     , publicKey_(publicKey)
     , creationTime_ (clock_type::now())
     , hello_(hello)
+    , compression_ (app_.config().COMPRESSION && hello.compression())
     , usage_(consumer)
     , fee_ (Resource::feeLightPeer)
     , slot_ (slot)
@@ -199,7 +200,8 @@ PeerImp::send (Message::pointer const& m)
 
     overlay_.reportTraffic (
         static_cast<TrafficCount::category>(m->getCategory()),
-        false, static_cast<int>(m->getBuffer().size()));
+        false, static_cast<int>(m->getBuffer(compression_).size()),
+            static_cast<int>(m->getBuffer().size()));
 
     auto sendq_size = send_queue_.size();
 
@@ -217,7 +219,7 @@ PeerImp::send (Message::pointer const& m)
         return;
 
     boost::asio::async_write (stream_, boost::asio::buffer(
-        send_queue_.front()->getBuffer()), strand_.wrap(std::bind(
+        send_queue_.front()->getBuffer(compression_)), strand_.wrap(std::bind(
             &PeerImp::onWriteMessage, shared_from_this(),
                 beast::asio::placeholders::error,
                     beast::asio::placeholders::bytes_transferred)));
@@ -792,7 +794,7 @@ PeerImp::onWriteMessage (error_code ec, std::size_t bytes_transferred)
     {
         // Timeout on writes only
         return boost::asio::async_write (stream_, boost::asio::buffer(
-            send_queue_.front()->getBuffer()), strand_.wrap(std::bind(
+            send_queue_.front()->getBuffer(compression_)), strand_.wrap(std::bind(
                 &PeerImp::onWriteMessage, shared_from_this(),
                     beast::asio::placeholders::error,
                         beast::asio::placeholders::bytes_transferred)));
@@ -823,13 +825,13 @@ PeerImp::onMessageUnknown (std::uint16_t type)
 PeerImp::error_code
 PeerImp::onMessageBegin (std::uint16_t type,
     std::shared_ptr <::google::protobuf::Message> const& m,
-    std::size_t size)
+    std::size_t size, std::size_t uncompressedSize)
 {
     load_event_ = app_.getJobQueue ().getLoadEventAP (
         jtPEER, protocolMessageName(type));
     fee_ = Resource::feeLightPeer;
     overlay_.reportTraffic (TrafficCount::categorize (*m, type, true),
-        true, static_cast<int>(size));
+        true, static_cast<int>(size), static_cast<int>(uncompressedSize));
     return error_code{};
 }
 
@@ -1095,24 +1097,19 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMTransaction> const& m)
             }
         }
 
-        if (app_.getJobQueue().getJobCount(jtTRANSACTION) > 100)
-        {
-            JLOG(p_journal_.info()) << "Transaction queue is full";
-        }
-        else if (app_.getLedgerMaster().getValidatedLedgerAge() > 4min)
+        if (app_.getLedgerMaster().getValidatedLedgerAge() > 4min)
         {
             JLOG(p_journal_.trace()) << "No new transactions until synchronized";
         }
-        else
+        else if (! overlay_.txVerifier().add (stx, checkSignature,
+            [weak = std::weak_ptr<PeerImp>(shared_from_this()),
+            flags, checkSignature, stx] () {
+                if (auto peer = weak.lock())
+                    peer->checkTransaction(flags,
+                        checkSignature, stx);
+            }))
         {
-            app_.getJobQueue ().addJob (
-                jtTRANSACTION, "recvTransaction->checkTransaction",
-                [weak = std::weak_ptr<PeerImp>(shared_from_this()),
-                flags, checkSignature, stx] (Job&) {
-                    if (auto peer = weak.lock())
-                        peer->checkTransaction(flags,
-                            checkSignature, stx);
-                });
+            JLOG(p_journal_.info()) << "Transaction queue is full";
         }
     }
     catch (std::exception const&)
@@ -1695,6 +1692,8 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMGetObjectByHash> const& m)
         std::uint32_t pLSeq = 0;
         bool pLDo = true;
         bool progress = false;
+        std::vector<LedgerMaster::FetchPackEntry> entries;
+        entries.reserve (packet.objects_size ());
 
         for (int i = 0; i < packet.objects_size (); ++i)
         {
@@ -1733,11 +1732,19 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMGetObjectByHash> const& m)
                         std::make_shared< Blob > (
                             obj.data ().begin (), obj.data ().end ()));
 
-                    app_.getLedgerMaster ().addFetchPack (hash, data);
+                    entries.emplace_back (hash, std::move (data));
                 }
             }
         }
 
+        // Checked together, which is faster than one at a time
+        if (auto const bad = app_.getLedgerMaster ().addFetchPack (entries))
+        {
+            JLOG(p_journal_.warn()) <<
+                "GetObj: " << bad << " fetch pack objects failed hash check";
+            fee_ = Resource::feeInvalidRequest;
+        }
+
         if (pLDo && (pLSeq != 0))
         {
             JLOG(p_journal_.debug()) <<
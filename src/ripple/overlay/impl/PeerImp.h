@@ -148,6 +148,8 @@ private:
     std::mutex mutable recentLock_;
     protocol::TMStatusChange last_status_;
     protocol::TMHello hello_;
+    // Both ends offered compression in the handshake
+    bool const compression_;
     Resource::Consumer usage_;
     Resource::Charge fee_;
     PeerFinder::Slot::ptr slot_;
@@ -404,7 +406,7 @@ public:
     error_code
     onMessageBegin (std::uint16_t type,
         std::shared_ptr <::google::protobuf::Message> const& m,
-        std::size_t size);
+        std::size_t size, std::size_t uncompressedSize);
 
     void
     onMessageEnd (std::uint16_t type,
@@ -498,6 +500,7 @@ PeerImp::PeerImp (Application& app, std::unique_ptr<beast::asio::ssl_bundle>&& s
     , publicKey_ (publicKey)
     , creationTime_ (clock_type::now())
     , hello_ (hello)
+    , compression_ (app_.config().COMPRESSION && hello.compression())
     , usage_ (usage)
     , fee_ (Resource::feeLightPeer)
     , slot_ (std::move(slot))
@@ -22,7 +22,9 @@
 
 #include "ripple.pb.h"
 #include <ripple/overlay/Message.h>
+#include <ripple/overlay/impl/Tuning.h>
 #include <ripple/overlay/impl/ZeroCopyStream.h>
+#include <lz4/lib/lz4.h>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/buffers_iterator.hpp>
 #include <boost/system/error_code.hpp>
@@ -70,7 +72,7 @@ std::enable_if_t<std::is_base_of<
     ::google::protobuf::Message, T>::value,
         boost::system::error_code>
 invoke (int type, Buffers const& buffers,
-    Handler& handler)
+    std::size_t wireSize, Handler& handler)
 {
     ZeroCopyInputStream<Buffers> stream(buffers);
     stream.Skip(Message::kHeaderBytes);
@@ -78,7 +80,7 @@ invoke (int type, Buffers const& buffers,
     if (! m->ParseFromZeroCopyStream(&stream))
         return boost::system::errc::make_error_code(
             boost::system::errc::invalid_argument);
-    auto ec = handler.onMessageBegin (type, m,
+    auto ec = handler.onMessageBegin (type, m, wireSize,
        Message::kHeaderBytes + Message::size (buffers));
     if (! ec)
     {
@@ -88,6 +90,74 @@ invoke (int type, Buffers const& buffers,
     return ec;
 }
 
+// Calls the handler for the uncompressed message in buffers,
+// which arrived as wireSize bytes.
+template <class Buffers, class Handler>
+boost::system::error_code
+invokeType (int type, Buffers const& buffers,
+    std::size_t wireSize, Handler& handler)
+{
+    switch (type)
+    {
+    case protocol::mtHELLO:         return invoke<protocol::TMHello> (type, buffers, wireSize, handler);
+    case protocol::mtMANIFESTS:     return invoke<protocol::TMManifests> (type, buffers, wireSize, handler);
+    case protocol::mtPING:          return invoke<protocol::TMPing> (type, buffers, wireSize, handler);
+    case protocol::mtCLUSTER:       return invoke<protocol::TMCluster> (type, buffers, wireSize, handler);
+    case protocol::mtGET_PEERS:     return invoke<protocol::TMGetPeers> (type, buffers, wireSize, handler);
+    case protocol::mtPEERS:         return invoke<protocol::TMPeers> (type, buffers, wireSize, handler);
+    case protocol::mtENDPOINTS:     return invoke<protocol::TMEndpoints> (type, buffers, wireSize, handler);
+    case protocol::mtTRANSACTION:   return invoke<protocol::TMTransaction> (type, buffers, wireSize, handler);
+    case protocol::mtGET_LEDGER:    return invoke<protocol::TMGetLedger> (type, buffers, wireSize, handler);
+    case protocol::mtLEDGER_DATA:   return invoke<protocol::TMLedgerData> (type, buffers, wireSize, handler);
+    case protocol::mtPROPOSE_LEDGER:return invoke<protocol::TMProposeSet> (type, buffers, wireSize, handler);
+    case protocol::mtSTATUS_CHANGE: return invoke<protocol::TMStatusChange> (type, buffers, wireSize, handler);
+    case protocol::mtHAVE_SET:      return invoke<protocol::TMHaveTransactionSet> (type, buffers, wireSize, handler);
+    case protocol::mtVALIDATION:    return invoke<protocol::TMValidation> (type, buffers, wireSize, handler);
+    case protocol::mtGET_OBJECTS:   return invoke<protocol::TMGetObjectByHash> (type, buffers, wireSize, handler);
+    default:
+        break;
+    }
+    return handler.onMessageUnknown (type);
+}
+
+// Decompresses the message in buffers, which holds
+// size bytes, and calls the handler for it.
+template <class Buffers, class Handler>
+boost::system::error_code
+invokeCompressed (int type, Buffers const& buffers,
+    std::size_t size, Handler& handler)
+{
+    auto const invalid = boost::system::errc::make_error_code(
+        boost::system::errc::invalid_argument);
+
+    // The header, the packed length and the compressed data
+    std::vector<std::uint8_t> in (size);
+    boost::asio::buffer_copy (boost::asio::buffer (in), buffers);
+    if (in.size () <= Message::kHeaderBytes + 4)
+        return invalid;
+
+    auto const p = &in[Message::kHeaderBytes];
+    std::size_t const n =
+        (std::size_t{p[0]} << 24) | (std::size_t{p[1]} << 16) |
+        (std::size_t{p[2]} << 8) | std::size_t{p[3]};
+    if (n == 0 || n > Tuning::maxDecompressBytes)
+        return invalid;
+
+    std::vector<std::uint8_t> out (Message::kHeaderBytes + n);
+    Message::encodeHeader (out.data (),
+        static_cast<std::uint32_t> (n), type);
+    auto const result = LZ4_decompress_safe (
+        reinterpret_cast<char const*> (p + 4),
+        reinterpret_cast<char*> (&out[Message::kHeaderBytes]),
+        static_cast<int> (size - Message::kHeaderBytes - 4),
+        static_cast<int> (n));
+    if (result < 0 || static_cast<std::size_t> (result) != n)
+        return invalid;
+
+    return invokeType (type, boost::asio::const_buffers_1 (
+        out.data (), out.size ()), size, handler);
+}
+
 }
 
 /** Calls the handler for up to one protocol message in the passed buffers.
@@ -111,27 +181,10 @@ invokeProtocolMessage (Buffers const& buffers, Handler& handler)
     if (boost::asio::buffer_size(buffers) < size)
         return result;
 
-    switch (type)
-    {
-    case protocol::mtHELLO:         ec = detail::invoke<protocol::TMHello> (type, buffers, handler); break;
-    case protocol::mtMANIFESTS:     ec = detail::invoke<protocol::TMManifests> (type, buffers, handler); break;
-    case protocol::mtPING:          ec = detail::invoke<protocol::TMPing> (type, buffers, handler); break;
-    case protocol::mtCLUSTER:       ec = detail::invoke<protocol::TMCluster> (type, buffers, handler); break;
-    case protocol::mtGET_PEERS:     ec = detail::invoke<protocol::TMGetPeers> (type, buffers, handler); break;
-    case protocol::mtPEERS:         ec = detail::invoke<protocol::TMPeers> (type, buffers, handler); break;
-    case protocol::mtENDPOINTS:     ec = detail::invoke<protocol::TMEndpoints> (type, buffers, handler); break;
-    case protocol::mtTRANSACTION:   ec = detail::invoke<protocol::TMTransaction> (type, buffers, handler); break;
-    case protocol::mtGET_LEDGER:    ec = detail::invoke<protocol::TMGetLedger> (type, buffers, handler); break;
-    case protocol::mtLEDGER_DATA:   ec = detail::invoke<protocol::TMLedgerData> (type, buffers, handler); break;
-    case protocol::mtPROPOSE_LEDGER:ec = detail::invoke<protocol::TMProposeSet> (type, buffers, handler); break;
-    case protocol::mtSTATUS_CHANGE: ec = detail::invoke<protocol::TMStatusChange> (type, buffers, handler); break;
-    case protocol::mtHAVE_SET:      ec = detail::invoke<protocol::TMHaveTransactionSet> (type, buffers, handler); break;
-    case protocol::mtVALIDATION:    ec = detail::invoke<protocol::TMValidation> (type, buffers, handler); break;
-    case protocol::mtGET_OBJECTS:   ec = detail::invoke<protocol::TMGetObjectByHash> (type, buffers, handler); break;
-    default:
-        ec = handler.onMessageUnknown (type);
-        break;
-    }
+    if (Message::compressed(buffers))
+        ec = detail::invokeCompressed (type, buffers, size, handler);
+    else
+        ec = detail::invokeType (type, buffers, size, handler);
     if (! ec)
         result.first = size;
 
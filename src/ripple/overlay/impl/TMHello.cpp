@@ -121,6 +121,9 @@ buildHello (
     // h.set_ipv4port (portNumber); // ignored now
     h.set_testnet (false);
 
+    if (app.config().COMPRESSION)
+        h.set_compression (true);
+
     if (remote.is_v4())
     {
         auto addr = remote.to_v4 ();
@@ -185,6 +188,9 @@ appendHello (beast::http::headers& h,
     if (hello.has_remote_ip())
         h.insert ("Remote-IP", beast::IP::to_string (
             beast::IP::AddressV4(hello.remote_ip())));
+
+    if (hello.compression())
+        h.insert ("Compression", "lz4");
 }
 
 std::vector<ProtocolVersion>
@@ -336,6 +342,13 @@ parseHello (bool request, beast::http::headers const& h, beast::Journal journal)
         }
     }
 
+    {
+        // Unknown algorithms are ignored
+        auto const iter = h.find ("Compression");
+        if (iter != h.end() && iter->second == "lz4")
+            hello.set_compression (true);
+    }
+
     return hello;
 }
 
@@ -43,8 +43,13 @@ public:
         count_t messagesIn;
         count_t messagesOut;
 
+        // The bytes the messages would take uncompressed
+        count_t uncompressedBytesIn;
+        count_t uncompressedBytesOut;
+
         TrafficStats() : bytesIn(0), bytesOut(0),
-            messagesIn(0), messagesOut(0)
+            messagesIn(0), messagesOut(0),
+            uncompressedBytesIn(0), uncompressedBytesOut(0)
         { ; }
 
         TrafficStats(const TrafficStats& ts)
@@ -52,6 +57,8 @@ public:
             , bytesOut (ts.bytesOut.load())
             , messagesIn (ts.messagesIn.load())
             , messagesOut (ts.messagesOut.load())
+            , uncompressedBytesIn (ts.uncompressedBytesIn.load())
+            , uncompressedBytesOut (ts.uncompressedBytesOut.load())
         { ; }
 
         operator bool () const
@@ -81,16 +88,19 @@ public:
         ::google::protobuf::Message const& message,
         int type, bool inbound);
 
-    void addCount (category cat, bool inbound, int number)
+    void addCount (category cat, bool inbound, int number,
+        int uncompressed)
     {
         if (inbound)
         {
             counts_[cat].bytesIn += number;
+            counts_[cat].uncompressedBytesIn += uncompressed;
             ++counts_[cat].messagesIn;
         }
         else
         {
             counts_[cat].bytesOut += number;
+            counts_[cat].uncompressedBytesOut += uncompressed;
             ++counts_[cat].messagesOut;
         }
     }
@@ -71,6 +71,20 @@ enum
 
     /** How many messages we consider reasonable sustained on a send queue */
     targetSendQueue     =   16,
+
+    /** How many transactions from peers may wait for
+        signature verification before we drop new ones */
+    maxVerifyQueue      = 10000,
+
+    /** How many transaction signatures to check in one batch */
+    verifyBatchSize     =   64,
+
+    /** How large a message must be before we compress it for
+        peers which accept compressed messages */
+    minCompressBytes    = 1024,
+
+    /** The largest decompressed message we accept */
+    maxDecompressBytes  = 64 * 1024 * 1024,
 };
 
 } // Tuning
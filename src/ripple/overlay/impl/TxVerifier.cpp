@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/TxVerifier.h>
+#include <ripple/overlay/impl/Tuning.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/JobQueue.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+TxVerifier::TxVerifier (Application& app, beast::Journal journal)
+    : app_ (app)
+    , j_ (journal)
+    , maxJobs_ (std::max (1u, std::thread::hardware_concurrency()))
+{
+}
+
+bool
+TxVerifier::add (std::shared_ptr<STTx const> const& stx,
+    bool checkSignature, handler_type handler)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (queue_.size() >= Tuning::maxVerifyQueue)
+        return false;
+    queue_.push_back ({stx, checkSignature, std::move (handler)});
+
+    // Bring in another job when those running
+    // have more than a batch each still waiting.
+    if (jobs_ < maxJobs_ &&
+        queue_.size() > jobs_ * std::size_t (Tuning::verifyBatchSize))
+    {
+        ++jobs_;
+        addJob (lock);
+    }
+    return true;
+}
+
+std::size_t
+TxVerifier::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return queue_.size();
+}
+
+void
+TxVerifier::addJob (std::lock_guard<std::mutex> const&)
+{
+    app_.getJobQueue().addJob (jtTRANSACTION, "verifyTransactions",
+        [this] (Job&) { run(); });
+}
+
+void
+TxVerifier::run ()
+{
+    std::vector<Item> batch;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        auto const n = std::min<std::size_t> (
+            queue_.size(), Tuning::verifyBatchSize);
+        batch.reserve (n);
+        std::move (queue_.begin(), queue_.begin() + n,
+            std::back_inserter (batch));
+        queue_.erase (queue_.begin(), queue_.begin() + n);
+    }
+
+    std::vector<std::shared_ptr<STTx const>> txs;
+    txs.reserve (batch.size());
+    for (auto const& item : batch)
+    {
+        if (item.checkSignature)
+            txs.push_back (item.stx);
+    }
+
+    if (! txs.empty())
+    {
+        JLOG(j_.trace()) <<
+            "Checking " << txs.size() << " transaction signatures";
+        checkSignatures (app_.getHashRouter(), txs,
+            app_.getLedgerMaster().getValidatedRules(),
+                app_.config());
+    }
+
+    for (auto const& item : batch)
+        item.handler();
+
+    // Keep going while there is work, one batch per job
+    // so that other job types get a turn in between.
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (queue_.empty())
+        --jobs_;
+    else
+        addJob (lock);
+}
+
+} // ripple
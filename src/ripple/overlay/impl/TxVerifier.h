@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_OVERLAY_TXVERIFIER_H_INCLUDED
+#define RIPPLE_OVERLAY_TXVERIFIER_H_INCLUDED
+
+#include <ripple/app/main/Application.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/beast/utility/Journal.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace ripple {
+
+/** Checks the signatures of transactions received from peers.
+
+    Transactions are queued as they arrive and their signatures
+    are checked in batches on the job queue, with up to one job
+    per core. The results are cached in the HashRouter, so the
+    handler for each transaction, which runs afterwards on the
+    same job, finds the signature state already known.
+*/
+class TxVerifier
+{
+public:
+    using handler_type = std::function<void(void)>;
+
+    TxVerifier (Application& app, beast::Journal journal);
+
+    TxVerifier (TxVerifier const&) = delete;
+    TxVerifier& operator= (TxVerifier const&) = delete;
+
+    /** Queue a transaction for verification.
+
+        @param stx The transaction.
+        @param checkSignature `false` if the signature should
+                              not be checked.
+        @param handler Called once the signature is checked.
+        @return `false` if the queue is full, in which case
+                the transaction is dropped.
+    */
+    bool
+    add (std::shared_ptr<STTx const> const& stx,
+        bool checkSignature, handler_type handler);
+
+    /** Returns the number of transactions waiting. */
+    std::size_t
+    size () const;
+
+private:
+    struct Item
+    {
+        std::shared_ptr<STTx const> stx;
+        bool checkSignature;
+        handler_type handler;
+    };
+
+    void
+    addJob (std::lock_guard<std::mutex> const&);
+
+    void
+    run ();
+
+    Application& app_;
+    beast::Journal j_;
+    int const maxJobs_;
+    std::mutex mutable mutex_;
+    std::deque<Item> queue_;
+    int jobs_ = 0;
+};
+
+} // ripple
+
+#endif
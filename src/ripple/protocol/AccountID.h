@@ -30,6 +30,7 @@
 #include <cstddef>
 #include <mutex>
 #include <string>
+#include <vector>
 
 namespace ripple {
 
@@ -47,6 +48,10 @@ using AccountID = base_uint<
 std::string
 toBase58 (AccountID const& v);
 
+/** Convert each AccountID to base58 checked string */
+std::vector<std::string>
+toBase58 (std::vector<AccountID> const& v);
+
 /** Parse AccountID from checked, base58 string.
     @return boost::none if a parse error occurs
 */
@@ -100,11 +100,18 @@ JSS ( both );                       // in: Subscribe, Unsubscribe
 JSS ( both_sides );                 // in: Subscribe, Unsubscribe
 JSS ( build_path );                 // in: TransactionSign
 JSS ( build_version );              // out: NetworkOPs
+JSS ( cache_budget_kb );            // out: GetCounts
+JSS ( cache_bytes );                // out: GetCounts
+JSS ( cache_scale );                // out: GetCounts
+JSS ( cache_size );                 // out: GetCounts
+JSS ( cache_usage_kb );             // out: GetCounts
+JSS ( cache_used_kb );              // out: GetCounts
 JSS ( cancel_after );               // out: AccountChannels
 JSS ( can_delete );                 // out: CanDelete
 JSS ( channel_id );                 // out: AccountChannels
 JSS ( channels );                   // out: AccountChannels
 JSS ( check_nodes );                // in: LedgerCleaner
+JSS ( checkouts );                  // out: GetCounts
 JSS ( clear );                      // in/out: FetchInfo
 JSS ( close_flags );                // out: LedgerToJson
 JSS ( close_time );                 // in: Application, out: NetworkOPs,
@@ -123,6 +130,7 @@ JSS ( comment );                    // in: UnlAdd
 JSS ( complete );                   // out: NetworkOPs, InboundLedger
 JSS ( complete_ledgers );           // out: NetworkOPs, PeerImp
 JSS ( consensus );                  // out: NetworkOPs, LedgerConsensus
+JSS ( contended );                  // out: GetCounts
 JSS ( converge_time );              // out: NetworkOPs
 JSS ( converge_time_s );            // out: NetworkOPs
 JSS ( count );                      // in: AccountTx*
@@ -195,6 +203,7 @@ JSS ( have_header );                // out: InboundLedger
 JSS ( have_state );                 // out: InboundLedger
 JSS ( have_transactions );          // out: InboundLedger
 JSS ( highest_sequence );           // out: AccountInfo
+JSS ( hits );                       // out: GetCounts
 JSS ( hostid );                     // out: NetworkOPs
 JSS ( hotwallet );                  // in: GatewayBalances
 JSS ( id );                         // websocket.
@@ -224,6 +233,7 @@ JSS ( ledger );                     // in: NetworkOPs, LedgerCleaner,
 JSS ( ledger_current_index );       // out: NetworkOPs, RPCHelpers,
                                     //      LedgerCurrent, LedgerAccept
 JSS ( ledger_data );                // out: LedgerHeader
+JSS ( ledger_db );                  // out: GetCounts
 JSS ( ledger_hash );                // in: RPCHelpers, LedgerRequest,
                                     //     RipplePathFind, TransactionEntry,
                                     //     handlers/Ledger
@@ -268,6 +278,7 @@ JSS ( max_ledger );                 // in/out: LedgerCleaner
 JSS ( max_queue_size );             // out: TxQ
 JSS ( max_spend_drops );            // out: AccountInfo
 JSS ( max_spend_drops_total );      // out: AccountInfo
+JSS ( max_wait_us );                // out: GetCounts
 JSS ( median_fee );                 // out: TxQ
 JSS ( median_level );               // out: TxQ
 JSS ( message );                    // error.
@@ -279,6 +290,7 @@ JSS ( min_count );                  // in: GetCounts
 JSS ( min_ledger );                 // in: LedgerCleaner
 JSS ( minimum_fee );                // out: TxQ
 JSS ( minimum_level );              // out: TxQ
+JSS ( misses );                     // out: GetCounts
 JSS ( missingCommand );             // error
 JSS ( name );                       // out: AmendmentTableImpl, PeerImp
 JSS ( needed_state_hashes );        // out: InboundLedger
@@ -288,13 +300,18 @@ JSS ( no_ripple );                  // out: AccountLines
 JSS ( no_ripple_peer );             // out: AccountLines
 JSS ( node );                       // in: UnlAdd, UnlDelete
 JSS ( node_binary );                // out: LedgerEntry
+JSS ( node_cache_partitions );      // out: GetCounts
 JSS ( node_hit_rate );              // out: GetCounts
 JSS ( node_read_bytes );            // out: GetCounts
+JSS ( node_read_errors );           // out: GetCounts
 JSS ( node_reads_hit );             // out: GetCounts
 JSS ( node_reads_total );           // out: GetCounts
 JSS ( node_writes );                // out: GetCounts
 JSS ( node_written_bytes );         // out: GetCounts
 JSS ( nodes );                      // out: PathState
+JSS ( nodes_per_second );           // out: SHAMapStore
+JSS ( nodes_present );              // out: SHAMapStore
+JSS ( nodes_written );              // out: SHAMapStore
 JSS ( obligations );                // out: GatewayBalances
 JSS ( offer );                      // in: LedgerEntry
 JSS ( offers );                     // out: NetworkOPs, AccountOffers, Subscribe
@@ -336,6 +353,8 @@ JSS ( queue );                      // in: AccountInfo
 JSS ( queue_data );                 // out: AccountInfo
 JSS ( random );                     // out: Random
 JSS ( raw_meta );                   // out: AcceptedLedgerTx
+JSS ( read_connections );           // out: GetCounts
+JSS ( reads );                      // out: GetCounts
 JSS ( receive_currencies );         // out: AccountCurrencies
 JSS ( reference_level );            // out: TxQ
 JSS ( regular_seed );               // in/out: LedgerEntry
@@ -350,6 +369,7 @@ JSS ( result );                     // RPC
 JSS ( ripple_lines );               // out: NetworkOPs
 JSS ( ripple_state );               // in: LedgerEntr
 JSS ( role );                       // out: Ping.cpp
+JSS ( rotation );                   // out: NetworkOPs
 JSS ( rt_accounts );                // in: Subscribe, Unsubscribe
 JSS ( sanity );                     // out: PeerImp
 JSS ( search_depth );               // in: RipplePathFind
@@ -385,6 +405,7 @@ JSS ( state_accounting );           // out: NetworkOPs
 JSS ( state_now );                  // in: Subscribe
 JSS ( status );                     // error
 JSS ( stop );                       // in: LedgerCleaner
+JSS ( stream );                     // in: LedgerData
 JSS ( streams );                    // in: Subscribe, Unsubscribe
 JSS ( strict );                     // in: AccountCurrencies, AccountInfo
 JSS ( sub_index );                  // in: LedgerEntry
@@ -401,16 +422,20 @@ JSS ( taker_pays_funded );          // out: NetworkOPs
 JSS ( threshold );                  // in: Blacklist
 JSS ( ticket );                     // in: AccountObjects
 JSS ( timeouts );                   // out: InboundLedger
+JSS ( track_size );                 // out: GetCounts
 JSS ( traffic );                    // out: Overlay
 JSS ( totalCoins );                 // out: LedgerToJson
 JSS ( total_coins );                // out: LedgerToJson
 JSS ( transTreeHash );              // out: ledger/Ledger.cpp
 JSS ( transaction );                // in: Tx
                                     // out: NetworkOPs, AcceptedLedgerTx,
+JSS ( transaction_db );             // out: GetCounts
 JSS ( transaction_hash );           // out: LedgerProposal, LedgerToJson
 JSS ( transactions );               // out: LedgerToJson,
                                     // in: AccountTx*, Unsubscribe
 JSS ( transitions );                // out: NetworkOPs
+JSS ( treenode_cache_bytes );       // out: GetCounts
+JSS ( treenode_cache_partitions );  // out: GetCounts
 JSS ( treenode_cache_size );        // out: GetCounts
 JSS ( treenode_track_size );        // out: GetCounts
 JSS ( tx );                         // out: STTx, AccountTx*
@@ -449,8 +474,11 @@ JSS ( value );                      // out: STAmount
 JSS ( version );                    // out: RPCVersion
 JSS ( vetoed );                     // out: AmendmentTableImpl
 JSS ( vote );                       // in: Feature
+JSS ( wait_us );                    // out: GetCounts
+JSS ( waits );                      // out: GetCounts
 JSS ( warning );                    // rpc:
 JSS ( write_load );                 // out: GetCounts
+JSS ( writes );                     // out: GetCounts
 
 #undef JSS
 
@@ -30,6 +30,7 @@
 #include <cstdint>
 #include <cstring>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -230,6 +231,26 @@ verify (PublicKey const& publicKey,
     Slice const& sig,
     bool mustBeFullyCanonical = true);
 
+/** A signature on a message, to be checked as part of a group. */
+struct SignatureCheck
+{
+    Slice publicKey;
+    Slice message;
+    Slice signature;
+    bool mustBeFullyCanonical;
+};
+
+/** Verify a group of signatures.
+    Each result is exactly what verifying the signature alone
+    would give. A public key of unknown type yields an invalid
+    result rather than an exception.
+
+    @return A vector whose element `i` is `true` if the
+            signature in `checks[i]` is valid.
+*/
+std::vector<bool>
+verify (std::vector<SignatureCheck> const& checks);
+
 /** Calculate the 160-bit node ID from a node public key. */
 NodeID
 calcNodeID (PublicKey const&);
@@ -27,6 +27,8 @@
 #include <boost/container/flat_set.hpp>
 #include <boost/logic/tribool.hpp>
 #include <functional>
+#include <memory>
+#include <vector>
 
 namespace ripple {
 
@@ -157,6 +159,16 @@ private:
 
 bool passesLocalChecks (STObject const& st, std::string&);
 
+/** Check the signatures of a group of transactions.
+    The results are the same as calling STTx::checkSign on each
+    transaction in turn. Each single signature is verified on its
+    own; Ed25519 signatures are not batched, since the cofactorless
+    batch equation can accept signatures a single check rejects.
+*/
+std::vector<std::pair<bool, std::string>>
+checkSign (std::vector<std::shared_ptr<STTx const>> const& txs,
+    bool allowMultiSign);
+
 /** Sterilize a transaction.
 
     The transaction is serialized and then deserialized,
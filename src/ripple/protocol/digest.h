@@ -21,6 +21,7 @@
 #define RIPPLE_PROTOCOL_DIGEST_H_INCLUDED
 
 #include <ripple/basics/base_uint.h>
+#include <ripple/basics/Slice.h>
 #include <ripple/beast/crypto/ripemd.h>
 #include <ripple/beast/crypto/sha2.h>
 #include <ripple/beast/hash/endian.h>
@@ -291,6 +292,25 @@ sha512Half_s (Args const&... args)
         sha512_half_hasher_s::result_type>(h);
 }
 
+/** Computes the SHA512-Half of each of a set of independent messages.
+
+    This is faster than hashing the messages one at a time when there
+    are many of them. On processors with AVX2 the messages are hashed
+    four at once, one in each 64-bit lane, and messages of similar
+    length are grouped together. Other processors hash them in turn.
+
+    @param messages The messages to hash.
+    @param count The number of messages.
+    @param digests Receives the digest of each message, in order.
+*/
+void
+sha512HalfBatch (Slice const* messages, std::size_t count,
+    uint256* digests);
+
+/** Returns true if sha512HalfBatch hashes several messages at once. */
+bool
+sha512HalfBatchIsVectorized ();
+
 } // ripple
 
 #endif
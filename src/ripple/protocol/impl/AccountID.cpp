@@ -34,6 +34,16 @@ toBase58 (AccountID const& v)
             v.data(), v.size());
 }
 
+std::vector<std::string>
+toBase58 (std::vector<AccountID> const& v)
+{
+    static_assert(sizeof(AccountID) == AccountID::bytes,
+        "AccountID must be laid out without padding");
+    return base58EncodeTokens(
+        TOKEN_ACCOUNT_ID, v.data(),
+            AccountID::bytes, v.size());
+}
+
 template<>
 boost::optional<AccountID>
 parseBase58 (std::string const& s)
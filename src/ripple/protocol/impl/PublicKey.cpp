@@ -262,6 +262,29 @@ verify (PublicKey const& publicKey,
     return false;
 }
 
+std::vector<bool>
+verify (std::vector<SignatureCheck> const& checks)
+{
+    std::vector<bool> result (checks.size(), false);
+
+    // Ed25519 signatures are deliberately not batch verified:
+    // the batch equation accepts some signatures, such as ones
+    // with a non-canonical R or a small order component, that
+    // the check in verify above rejects. Since the result gets
+    // cached with the transaction, any difference would let
+    // servers disagree on its validity.
+    for (std::size_t i = 0; i < checks.size(); ++i)
+    {
+        auto const& check = checks[i];
+        if (publicKeyType (check.publicKey))
+            result[i] = verify (PublicKey (check.publicKey),
+                check.message, check.signature,
+                    check.mustBeFullyCanonical);
+    }
+
+    return result;
+}
+
 NodeID
 calcNodeID (PublicKey const& pk)
 {
@@ -508,6 +508,71 @@ bool passesLocalChecks (STObject const& st, std::string& reason)
     return true;
 }
 
+std::vector<std::pair<bool, std::string>>
+checkSign (std::vector<std::shared_ptr<STTx const>> const& txs,
+    bool allowMultiSign)
+{
+    std::vector<std::pair<bool, std::string>> result (
+        txs.size(), {false, "Invalid signature."});
+
+    // Fields of the single-signed transactions. The storage
+    // is reserved up front so the slices in checks stay valid.
+    struct Single
+    {
+        std::size_t index;
+        Blob spk;
+        Blob signature;
+        Blob data;
+    };
+    std::vector<Single> singles;
+    singles.reserve (txs.size());
+    std::vector<SignatureCheck> checks;
+    checks.reserve (txs.size());
+
+    for (std::size_t i = 0; i < txs.size(); ++i)
+    {
+        auto const& tx = *txs[i];
+        try
+        {
+            auto spk = tx.getFieldVL (sfSigningPubKey);
+            if (allowMultiSign && spk.empty ())
+            {
+                result[i] = tx.checkSign (allowMultiSign);
+                continue;
+            }
+
+            // Same rules as STTx::checkSingleSign
+            if (tx.isFieldPresent (sfSigners))
+            {
+                result[i].second = "Cannot both single- and multi-sign.";
+                continue;
+            }
+            if (! publicKeyType (makeSlice (spk)))
+                continue;
+
+            singles.push_back ({i, std::move (spk),
+                tx.getFieldVL (sfTxnSignature), getSigningData (tx)});
+            auto const& single = singles.back();
+            checks.push_back ({makeSlice (single.spk),
+                makeSlice (single.data), makeSlice (single.signature),
+                    (tx.getFlags() & tfFullyCanonicalSig) != 0});
+        }
+        catch (std::exception const&)
+        {
+            // Assume it was a signature failure.
+        }
+    }
+
+    auto const valid = verify (checks);
+    for (std::size_t i = 0; i < singles.size(); ++i)
+    {
+        if (valid[i])
+            result[singles[i].index] = {true, ""};
+    }
+
+    return result;
+}
+
 std::shared_ptr<STTx const>
 sterilize (STTx const& stx)
 {
@@ -19,10 +19,27 @@
 
 #include <BeastConfig.h>
 #include <ripple/protocol/digest.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 #include <type_traits>
+#include <vector>
 #include <openssl/ripemd.h>
 #include <openssl/sha.h>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RIPPLE_SHA512_AVX2 1
+#define RIPPLE_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_M_X64)
+#define RIPPLE_SHA512_AVX2 1
+#define RIPPLE_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#define RIPPLE_SHA512_AVX2 0
+#endif
+
 namespace ripple {
 
 openssl_ripemd160_hasher::openssl_ripemd160_hasher()
@@ -113,4 +130,328 @@ openssl_sha256_hasher::operator result_type() noexcept
     return digest;
 }
 
+//------------------------------------------------------------------------------
+
+namespace detail {
+
+static
+void
+sha512HalfBatchScalar (Slice const* messages, std::size_t count,
+    uint256* digests)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        sha512_half_hasher h;
+        h (messages[i].data (), messages[i].size ());
+        digests[i] = static_cast<sha512_half_hasher::result_type>(h);
+    }
+}
+
+#if RIPPLE_SHA512_AVX2
+
+static std::uint64_t const sha512K[80] =
+{
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+    0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+    0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+    0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+    0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+    0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+    0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL,
+    0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+    0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL,
+    0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL,
+    0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+    0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+    0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL,
+    0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+    0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL,
+    0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+    0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+    0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL,
+    0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+    0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+    0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static std::uint64_t const sha512Init[8] =
+{
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL,
+    0xa54ff53a5f1d36f1ULL, 0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+    0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static
+bool
+cpuHasAVX2 ()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid (info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid (info, 1);
+    // The OS must save the AVX registers
+    bool const osxsave = (info[2] & (1 << 27)) != 0;
+    if (! osxsave || (_xgetbv (0) & 0x6) != 0x6)
+        return false;
+    __cpuidex (info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports ("avx2");
+#endif
+}
+
+static inline
+std::uint64_t
+loadBigEndian (unsigned char const* p)
+{
+    std::uint64_t v;
+    std::memcpy (&v, p, sizeof(v));
+#if defined(_MSC_VER)
+    return _byteswap_uint64 (v);
+#else
+    return __builtin_bswap64 (v);
+#endif
+}
+
+// One message in a lane, with its final blocks padded
+struct Sha512Lane
+{
+    unsigned char const* data;
+    std::size_t full;
+    std::size_t blocks;
+    unsigned char tail[256];
+
+    void
+    reset (Slice const& message)
+    {
+        std::size_t const size = message.size ();
+        data = message.data ();
+        full = size / 128;
+        blocks = (size + 17 + 127) / 128;
+
+        std::size_t const rest = size - full * 128;
+        std::size_t const tailSize = (blocks - full) * 128;
+        std::memset (tail, 0, tailSize);
+        if (rest != 0)
+            std::memcpy (tail, data + full * 128, rest);
+        tail[rest] = 0x80;
+
+        // The length in bits, as a 128-bit big endian number
+        std::uint64_t const bits = static_cast<std::uint64_t>(size) << 3;
+        tail[tailSize - 9] = static_cast<unsigned char>(size >> 61);
+        for (int i = 0; i < 8; ++i)
+            tail[tailSize - 1 - i] =
+                static_cast<unsigned char>(bits >> (8 * i));
+    }
+
+    unsigned char const*
+    block (std::size_t i) const
+    {
+        // Lanes which are done hash their last block again,
+        // and the result is discarded.
+        if (i >= blocks)
+            i = blocks - 1;
+        return (i < full) ? (data + 128 * i) : (tail + 128 * (i - full));
+    }
+};
+
+template <int n>
+RIPPLE_TARGET_AVX2 static inline
+__m256i
+rotr (__m256i x)
+{
+    return _mm256_or_si256 (
+        _mm256_srli_epi64 (x, n), _mm256_slli_epi64 (x, 64 - n));
+}
+
+RIPPLE_TARGET_AVX2 static inline
+__m256i
+add (__m256i x, __m256i y)
+{
+    return _mm256_add_epi64 (x, y);
+}
+
+RIPPLE_TARGET_AVX2 static inline
+__m256i
+xor3 (__m256i x, __m256i y, __m256i z)
+{
+    return _mm256_xor_si256 (_mm256_xor_si256 (x, y), z);
+}
+
+// Hash one block in each of four lanes, leaving the state of lanes
+// outside the mask untouched
+RIPPLE_TARGET_AVX2 static
+void
+compress4 (__m256i* state, unsigned char const* const* blocks, __m256i mask)
+{
+    __m256i w[16];
+    for (int t = 0; t < 16; ++t)
+    {
+        w[t] = _mm256_set_epi64x (
+            static_cast<long long>(loadBigEndian (blocks[3] + 8 * t)),
+            static_cast<long long>(loadBigEndian (blocks[2] + 8 * t)),
+            static_cast<long long>(loadBigEndian (blocks[1] + 8 * t)),
+            static_cast<long long>(loadBigEndian (blocks[0] + 8 * t)));
+    }
+
+    __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+    __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int t = 0; t < 80; ++t)
+    {
+        if (t >= 16)
+        {
+            __m256i const w2 = w[(t - 2) & 15];
+            __m256i const w15 = w[(t - 15) & 15];
+            __m256i const s1 = xor3 (
+                rotr<19> (w2), rotr<61> (w2), _mm256_srli_epi64 (w2, 6));
+            __m256i const s0 = xor3 (
+                rotr<1> (w15), rotr<8> (w15), _mm256_srli_epi64 (w15, 7));
+            w[t & 15] = add (add (s1, w[(t - 7) & 15]),
+                add (s0, w[t & 15]));
+        }
+
+        __m256i const S1 = xor3 (rotr<14> (e), rotr<18> (e), rotr<41> (e));
+        __m256i const ch = _mm256_xor_si256 (
+            _mm256_and_si256 (e, f), _mm256_andnot_si256 (e, g));
+        __m256i const t1 = add (add (add (h, S1), add (ch, w[t & 15])),
+            _mm256_set1_epi64x (static_cast<long long>(sha512K[t])));
+        __m256i const S0 = xor3 (rotr<28> (a), rotr<34> (a), rotr<39> (a));
+        __m256i const maj = xor3 (_mm256_and_si256 (a, b),
+            _mm256_and_si256 (a, c), _mm256_and_si256 (b, c));
+        __m256i const t2 = add (S0, maj);
+
+        h = g;
+        g = f;
+        f = e;
+        e = add (d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = add (t1, t2);
+    }
+
+    __m256i const next[8] = { a, b, c, d, e, f, g, h };
+    for (int i = 0; i < 8; ++i)
+    {
+        state[i] = _mm256_blendv_epi8 (
+            state[i], add (state[i], next[i]), mask);
+    }
+}
+
+// Hash four messages, which may be the same message more than once
+RIPPLE_TARGET_AVX2 static
+void
+sha512Half4 (Sha512Lane const* lanes, uint256* const* digests)
+{
+    __m256i state[8];
+    for (int i = 0; i < 8; ++i)
+        state[i] = _mm256_set1_epi64x (static_cast<long long>(sha512Init[i]));
+
+    std::size_t blocks = 0;
+    for (int j = 0; j < 4; ++j)
+        blocks = std::max (blocks, lanes[j].blocks);
+
+    for (std::size_t i = 0; i < blocks; ++i)
+    {
+        unsigned char const* const block[4] = {
+            lanes[0].block (i), lanes[1].block (i),
+            lanes[2].block (i), lanes[3].block (i) };
+        __m256i const mask = _mm256_set_epi64x (
+            (i < lanes[3].blocks) ? -1 : 0,
+            (i < lanes[2].blocks) ? -1 : 0,
+            (i < lanes[1].blocks) ? -1 : 0,
+            (i < lanes[0].blocks) ? -1 : 0);
+        compress4 (state, block, mask);
+    }
+
+    // The half digest is the first four words, big endian
+    for (int i = 0; i < 4; ++i)
+    {
+        alignas(32) std::uint64_t words[4];
+        _mm256_store_si256 (reinterpret_cast<__m256i*>(words), state[i]);
+        for (int j = 0; j < 4; ++j)
+        {
+            auto out = digests[j]->begin () + 8 * i;
+            for (int k = 0; k < 8; ++k)
+                out[k] = static_cast<unsigned char>(words[j] >> (56 - 8 * k));
+        }
+    }
+}
+
+static
+void
+sha512HalfBatchAVX2 (Slice const* messages, std::size_t count,
+    uint256* digests)
+{
+    // Messages of similar length share a group, so few lanes idle
+    std::vector<std::size_t> order (count);
+    std::iota (order.begin (), order.end (), std::size_t{0});
+    std::stable_sort (order.begin (), order.end (),
+        [messages](std::size_t x, std::size_t y)
+        {
+            return messages[x].size () < messages[y].size ();
+        });
+
+    Sha512Lane lanes[4];
+    std::size_t i = 0;
+    for (; i + 1 < count; i += 4)
+    {
+        // A short last group repeats its final message
+        uint256 spare;
+        uint256* out[4];
+        for (int j = 0; j < 4; ++j)
+        {
+            if (i + j < count)
+            {
+                lanes[j].reset (messages[order[i + j]]);
+                out[j] = &digests[order[i + j]];
+            }
+            else
+            {
+                lanes[j] = lanes[j - 1];
+                out[j] = &spare;
+            }
+        }
+        sha512Half4 (lanes, out);
+    }
+
+    if (i < count)
+        sha512HalfBatchScalar (&messages[order[i]], 1, &digests[order[i]]);
+}
+
+#endif
+
+} // detail
+
+bool
+sha512HalfBatchIsVectorized ()
+{
+#if RIPPLE_SHA512_AVX2
+    static bool const avx2 = detail::cpuHasAVX2 ();
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+void
+sha512HalfBatch (Slice const* messages, std::size_t count,
+    uint256* digests)
+{
+#if RIPPLE_SHA512_AVX2
+    if (count > 1 && sha512HalfBatchIsVectorized ())
+        return detail::sha512HalfBatchAVX2 (messages, count, digests);
+#endif
+    detail::sha512HalfBatchScalar (messages, count, digests);
+}
+
 } // ripple
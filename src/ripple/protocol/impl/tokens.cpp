@@ -20,7 +20,9 @@
 #include <BeastConfig.h>
 #include <ripple/protocol/tokens.h>
 #include <ripple/protocol/digest.h>
+#include <array>
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <type_traits>
@@ -88,21 +90,74 @@ checksum (void* out,
 
 //------------------------------------------------------------------------------
 
-// Code from Bitcoin: https://github.com/bitcoin/bitcoin
-// Copyright (c) 2014 The Bitcoin Core developers
-// Distributed under the MIT software license, see the accompanying
-// file COPYING or http://www.opensource.org/licenses/mit-license.php.
-//
-// Modified from the original
+// Base58 conversions work on limbs holding several digits at a time,
+// so that the quadratic inner loops run over a twentieth of the
+// elements of a digit by digit conversion.
 //
+// Binary data is consumed 32 bits at a time into limbs of five
+// base58 digits, and base58 text is consumed five digits at a time
+// into limbs of 32 bits. Either way, a limb times the multiplier
+// plus the carry fits in 64 bits.
+
+// 58^5, the base of a limb of base58 digits
+static std::uint64_t const base58Limb = 656356768;
+static int const base58LimbDigits = 5;
+
+// The number of base58 limbs needed for the given number of bytes:
+// log(256^bytes) / log(58^5) = bytes * 8 / 29.29, rounded up.
+static constexpr
+std::size_t
+base58Limbs (std::size_t bytes)
+{
+    return bytes * 8 / 29 + 1;
+}
+
+// Converts big-endian bytes to base58 limbs, least significant
+// first, returning the number of limbs used.
+template <class Limbs>
+static
+std::size_t
+toBase58Limbs (unsigned char const* pbegin,
+    unsigned char const* pend, Limbs& limbs)
+{
+    std::size_t used = 0;
+    // The leading chunk takes the bytes left over from whole words
+    std::size_t chunk = (pend - pbegin) % 4;
+    if (chunk == 0)
+        chunk = 4;
+    while (pbegin != pend)
+    {
+        std::uint64_t carry = 0;
+        for (std::size_t i = 0; i < chunk; ++i)
+            carry = (carry << 8) | *pbegin++;
+        auto const multiplier = std::uint64_t(1) << (8 * chunk);
+        // Apply "limbs = limbs * 2^(8 * chunk) + carry".
+        for (std::size_t i = 0; i < used; ++i)
+        {
+            carry += limbs[i] * multiplier;
+            limbs[i] = carry % base58Limb;
+            carry /= base58Limb;
+        }
+        while (carry != 0)
+        {
+            assert (used < limbs.size());
+            limbs[used++] = carry % base58Limb;
+            carry /= base58Limb;
+        }
+        chunk = 4;
+    }
+    return used;
+}
+
 // WARNING Do not call this directly, use
-//         encodeBase58Token instead since it
+//         base58EncodeToken instead since it
 //         calculates the size of buffer needed.
+template <class Limbs>
 static
 std::string
 encodeBase58(
     void const* message, std::size_t size,
-        void *temp, char const* const alphabet)
+        Limbs& limbs, char const* const alphabet)
 {
     auto pbegin = reinterpret_cast<
         unsigned char const*>(message);
@@ -114,38 +169,57 @@ encodeBase58(
         pbegin++;
         zeroes++;
     }
-    auto const b58begin = reinterpret_cast<
-        unsigned char*>(temp);
-    // log(256) / log(58), rounded up.
-    auto const b58end = b58begin +
-        size * (138 / 100 + 1);
-    std::fill(b58begin, b58end, 0);
-    while (pbegin != pend)
-    {
-        int carry = *pbegin;
-        // Apply "b58 = b58 * 256 + ch".
-        for (auto iter = b58end; iter != b58begin; --iter)
-        {
-            carry += 256 * (iter[-1]);
-            iter[-1] = carry % 58;
-            carry /= 58;
-        }
-        assert(carry == 0);
-        pbegin++;
-    }
-    // Skip leading zeroes in base58 result.
-    auto iter = b58begin;
-    while (iter != b58end && *iter == 0)
-        ++iter;
+    auto const used = toBase58Limbs (pbegin, pend, limbs);
     // Translate the result into a string.
     std::string str;
-    str.reserve(zeroes + (b58end - iter));
+    str.reserve(zeroes + used * base58LimbDigits);
     str.assign(zeroes, alphabet[0]);
-    while (iter != b58end)
-        str += alphabet[*(iter++)];
+    if (used == 0)
+        return str;
+    // The most significant limb has no leading zeroes
+    char digits[base58LimbDigits];
+    int n = 0;
+    for (auto v = limbs[used - 1]; v != 0; v /= 58)
+        digits[n++] = alphabet[v % 58];
+    while (n != 0)
+        str += digits[--n];
+    for (auto i = used - 1; i-- != 0;)
+    {
+        auto v = limbs[i];
+        for (n = base58LimbDigits; n-- != 0; v /= 58)
+            digits[n] = alphabet[v % 58];
+        str.append(digits, base58LimbDigits);
+    }
     return str;
 }
 
+// Lay the data out as
+//      <type><token><checksum>
+static
+void
+expandToken (unsigned char* out, std::uint8_t type,
+    void const* token, std::size_t size)
+{
+    out[0] = type;
+    std::memcpy(out + 1, token, size);
+    checksum(out + 1 + size, out, 1 + size);
+}
+
+// Encodes a token whose size is known at compile time, with all
+// of the working storage on the stack.
+template <std::size_t Size>
+static
+std::string
+base58EncodeToken (std::uint8_t type, void const* token)
+{
+    // expanded token includes type + checksum
+    std::array<unsigned char, 1 + Size + 4> expanded;
+    std::array<std::uint64_t, base58Limbs(1 + Size + 4)> limbs;
+    expandToken(expanded.data(), type, token, Size);
+    return encodeBase58(expanded.data(), expanded.size(),
+        limbs, rippleAlphabet);
+}
+
 /*  Base-58 encode a Ripple Token
 
     Ripple Tokens have a one-byte prefx indicating
@@ -157,49 +231,129 @@ encodeBase58(
         Wallet Seed
         Account Public Key
         Account ID
-
-    @param temp A pointer to storage of not
-                less than 2*(size+6) bytes
 */
 std::string
 base58EncodeToken (std::uint8_t type,
     void const* token, std::size_t size)
 {
-    char buf[1024];
+    // Account IDs and public keys
+    if (size == 20)
+        return base58EncodeToken<20>(type, token);
+    if (size == 33)
+        return base58EncodeToken<33>(type, token);
+
     // expanded token includes type + checksum
-    auto const expanded = 1 + size + 4;
-    // add scratch, log(256) / log(58), rounded up.
-    auto const needed = expanded +
-        size * (138 / 100 + 1);
-    std::unique_ptr<
-        char[]> pbuf;
-    char* temp;
-    if (needed > sizeof(buf))
+    std::vector<unsigned char> expanded(1 + size + 4);
+    std::vector<std::uint64_t> limbs(base58Limbs(expanded.size()));
+    expandToken(expanded.data(), type, token, size);
+    return encodeBase58(expanded.data(), expanded.size(),
+        limbs, rippleAlphabet);
+}
+
+template <std::size_t Size>
+static
+void
+base58EncodeTokens (std::uint8_t type,
+    unsigned char const* tokens, std::size_t count,
+        std::vector<std::string>& result)
+{
+    for (std::size_t i = 0; i < count; ++i, tokens += Size)
+        result.push_back(base58EncodeToken<Size>(type, tokens));
+}
+
+std::vector<std::string>
+base58EncodeTokens (std::uint8_t type,
+    void const* tokens, std::size_t size, std::size_t count)
+{
+    auto p = reinterpret_cast<unsigned char const*>(tokens);
+    std::vector<std::string> result;
+    result.reserve(count);
+    if (size == 20)
     {
-        pbuf.reset(new char[needed]);
-        temp = pbuf.get();
+        base58EncodeTokens<20>(type, p, count, result);
+    }
+    else if (size == 33)
+    {
+        base58EncodeTokens<33>(type, p, count, result);
     }
     else
     {
-        temp = buf;
+        for (std::size_t i = 0; i < count; ++i, p += size)
+            result.push_back(base58EncodeToken(type, p, size));
     }
-    // Lay the data out as
-    //      <type><token><checksum>
-    temp[0] = type;
-    std::memcpy(temp + 1, token, size);
-    checksum(temp + 1 + size, temp, 1 + size);
-    return encodeBase58(temp, expanded,
-        temp + expanded, rippleAlphabet);
+    return result;
 }
 
 //------------------------------------------------------------------------------
 
-// Code from Bitcoin: https://github.com/bitcoin/bitcoin
-// Copyright (c) 2014 The Bitcoin Core developers
-// Distributed under the MIT software license, see the accompanying
-// file COPYING or http://www.opensource.org/licenses/mit-license.php.
-//
-// Modified from the original
+// Converts base58 digits to 32-bit limbs, least significant first,
+// returning the number of limbs used, or -1 if a character is not
+// in the alphabet.
+template <class Limbs, class InverseArray>
+static
+int
+fromBase58Limbs (char const* psz, std::size_t remain,
+    Limbs& limbs, InverseArray const& inv)
+{
+    std::size_t used = 0;
+    // The leading chunk takes the digits left over from whole limbs
+    std::size_t chunk = remain % base58LimbDigits;
+    if (chunk == 0)
+        chunk = base58LimbDigits;
+    while (remain > 0)
+    {
+        std::uint64_t carry = 0;
+        std::uint64_t multiplier = 1;
+        for (std::size_t i = 0; i < chunk; ++i)
+        {
+            auto const digit = inv[*psz++];
+            if (digit == -1)
+                return -1;
+            carry = carry * 58 + digit;
+            multiplier *= 58;
+        }
+        remain -= chunk;
+        // Apply "limbs = limbs * 58^chunk + carry".
+        for (std::size_t i = 0; i < used; ++i)
+        {
+            carry += limbs[i] * multiplier;
+            limbs[i] = carry & 0xffffffff;
+            carry >>= 32;
+        }
+        while (carry != 0)
+        {
+            assert (used < limbs.size());
+            limbs[used++] = carry & 0xffffffff;
+            carry >>= 32;
+        }
+        chunk = base58LimbDigits;
+    }
+    return static_cast<int>(used);
+}
+
+template <class Limbs>
+static
+std::string
+fromLimbs (Limbs const& limbs, int used, int zeroes)
+{
+    std::string result;
+    result.reserve (zeroes + used * 4);
+    result.assign (zeroes, 0x00);
+    if (used == 0)
+        return result;
+    // Skip leading zeroes in the most significant limb.
+    auto const top = limbs[used - 1];
+    int shift = 24;
+    while ((top >> shift) == 0)
+        shift -= 8;
+    for (; shift >= 0; shift -= 8)
+        result.push_back(static_cast<char>(top >> shift));
+    for (auto i = used - 1; i-- != 0;)
+        for (shift = 24; shift >= 0; shift -= 8)
+            result.push_back(static_cast<char>(limbs[i] >> shift));
+    return result;
+}
+
 template <class InverseArray>
 static
 std::string
@@ -216,37 +370,23 @@ decodeBase58 (std::string const& s,
         ++psz;
         --remain;
     }
-    // Allocate enough space in big-endian base256 representation.
-    // log(58) / log(256), rounded up.
-    std::vector<unsigned char> b256(
-        remain * 733 / 1000 + 1);
-    while (remain > 0)
+    // Allocate enough limbs for the big-endian base256 representation.
+    // log(58^remain) / log(2^32) = remain * 0.183, rounded up.
+    auto const needed = remain / base58LimbDigits + 1;
+    // Tokens fit in limbs on the stack
+    std::array<std::uint64_t, 16> small;
+    if (needed <= small.size())
     {
-        auto carry = inv[*psz];
-        if (carry == -1)
+        auto const used = fromBase58Limbs(psz, remain, small, inv);
+        if (used == -1)
             return {};
-        // Apply "b256 = b256 * 58 + carry".
-        for (auto iter = b256.rbegin();
-            iter != b256.rend(); ++iter)
-        {
-            carry += 58 * *iter;
-            *iter = carry % 256;
-            carry /= 256;
-        }
-        assert(carry == 0);
-        ++psz;
-        --remain;
+        return fromLimbs(small, used, zeroes);
     }
-    // Skip leading zeroes in b256.
-    auto iter = std::find_if(
-        b256.begin(), b256.end(),[](unsigned char c)
-            { return c != 0; });
-    std::string result;
-    result.reserve (zeroes + (b256.end() - iter));
-    result.assign (zeroes, 0x00);
-    while (iter != b256.end())
-        result.push_back(*(iter++));
-    return result;
+    std::vector<std::uint64_t> limbs(needed);
+    auto const used = fromBase58Limbs(psz, remain, limbs, inv);
+    if (used == -1)
+        return {};
+    return fromLimbs(limbs, used, zeroes);
 }
 
 /*  Base58 decode a Ripple token
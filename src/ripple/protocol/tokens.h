@@ -23,6 +23,7 @@
 #include <boost/optional.hpp>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace ripple {
 
@@ -69,13 +70,24 @@ parseHexOrBase58 (std::string const& s);
         Account Public Key
         Account ID
 
-    @param temp A pointer to storage of not
-                less than 2*(size+6) bytes
+    Account IDs (20 bytes) and public keys (33 bytes)
+    are encoded without allocating working storage.
 */
 std::string
 base58EncodeToken (std::uint8_t type,
     void const* token, std::size_t size);
 
+/** Base-58 encode consecutive Ripple Tokens
+
+    The tokens are all of the given type and size, and are
+    laid out one after another starting at tokens.
+
+    @return The encoding of each token, in order.
+*/
+std::vector<std::string>
+base58EncodeTokens (std::uint8_t type,
+    void const* tokens, std::size_t size, std::size_t count);
+
 /** Decode a Base58 token
 
     The type and checksum must match or an
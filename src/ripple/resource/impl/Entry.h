@@ -25,6 +25,7 @@
 #include <ripple/resource/impl/Tuning.h>
 #include <ripple/beast/clock/abstract_clock.h>
 #include <ripple/beast/core/List.h>
+#include <atomic>
 #include <cassert>
 
 namespace ripple {
@@ -41,9 +42,11 @@ struct Entry
 
     /**
        @param now Construction time of Entry.
+       @param index Index of the table shard holding the Entry.
     */
-    explicit Entry(clock_type::time_point const now)
-        : refcount (0)
+    Entry(clock_type::time_point const now, std::size_t index)
+        : shard (index)
+        , refcount (0)
         , local_balance (now)
         , remote_balance (0)
         , lastWarningTime (0)
@@ -76,7 +79,7 @@ struct Entry
     }
 
     // Balance including remote contributions
-    int balance (clock_type::time_point const now)
+    int balance (clock_type::time_point const now) const
     {
         return local_balance.value (now) + remote_balance;
     }
@@ -91,14 +94,20 @@ struct Entry
     // Back pointer to the map key (bit of a hack here)
     Key const* key;
 
+    // Index of the table shard holding this entry
+    std::size_t const shard;
+
+    // The fields below are guarded by the shard's lock, except
+    // for the balances, which may be charged without it.
+
     // Number of Consumer references
     int refcount;
 
     // Exponentially decaying balance of resource consumption
-    DecayingSample <decayWindowSeconds, clock_type> local_balance;
+    AtomicDecayingSample <decayWindowSeconds, clock_type> local_balance;
 
     // Normalized balance contribution from imports
-    int remote_balance;
+    std::atomic <int> remote_balance;
 
     // Time of the last warning
     clock_type::rep lastWarningTime;
@@ -31,6 +31,7 @@
 #include <ripple/beast/clock/abstract_clock.h>
 #include <ripple/beast/insight/Insight.h>
 #include <ripple/beast/utility/PropertyStream.h>
+#include <array>
 #include <cassert>
 #include <mutex>
 
@@ -57,30 +58,42 @@ private:
         beast::insight::Meter drop;
     };
 
-    Stats m_stats;
-    Stopwatch& m_clock;
-    beast::Journal m_journal;
+    // One independently locked part of the consumer table. Balances
+    // are charged without the lock; it guards membership, reference
+    // counts and the lists.
+    struct Shard
+    {
+        std::mutex lock;
+
+        // Table of the entries in this shard
+        Table table;
+
+        // Because the following are intrusive lists, a given Entry may be in
+        // at most list at a given instant.  The Entry must be removed from
+        // one list before placing it in another.
 
-    std::recursive_mutex lock_;
+        // List of all active inbound entries
+        EntryIntrusiveList inbound;
 
-    // Table of all entries
-    Table table_;
+        // List of all active outbound entries
+        EntryIntrusiveList outbound;
 
-    // Because the following are intrusive lists, a given Entry may be in
-    // at most list at a given instant.  The Entry must be removed from
-    // one list before placing it in another.
+        // List of all active admin entries
+        EntryIntrusiveList admin;
 
-    // List of all active inbound entries
-    EntryIntrusiveList inbound_;
+        // List of all inactve entries
+        EntryIntrusiveList inactive;
+    };
 
-    // List of all active outbound entries
-    EntryIntrusiveList outbound_;
+    Stats m_stats;
+    Stopwatch& m_clock;
+    beast::Journal m_journal;
 
-    // List of all active admin entries
-    EntryIntrusiveList admin_;
+    // All entries, sharded by the hash of their key
+    Key::hasher hasher_;
+    std::array <Shard, tableShards> shards_;
 
-    // List of all inactve entries
-    EntryIntrusiveList inactive_;
+    std::mutex importLock_;
 
     // All imported gossip data
     Imports importTable_;
@@ -104,67 +117,28 @@ public:
         // destroyed before the consumer table.
         //
         importTable_.clear();
-        table_.clear();
+        for (auto& shard : shards_)
+            shard.table.clear();
     }
 
     Consumer newInboundEndpoint (beast::IP::Endpoint const& address)
     {
-        Entry* entry (nullptr);
-
-        {
-            std::lock_guard<std::recursive_mutex> _(lock_);
-            auto result =
-                table_.emplace (std::piecewise_construct,
-                    std::make_tuple (kindInbound, address.at_port (0)), // Key
-                    std::make_tuple (m_clock.now()));                   // Entry
-
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                {
-                    inactive_.erase (
-                        inactive_.iterator_to (*entry));
-                }
-                inbound_.push_back (*entry);
-            }
-        }
+        Entry& entry (insert (Key (kindInbound, address.at_port (0))));
 
         JLOG(m_journal.debug()) <<
-            "New inbound endpoint " << *entry;
+            "New inbound endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     Consumer newOutboundEndpoint (beast::IP::Endpoint const& address)
     {
-        Entry* entry (nullptr);
-
-        {
-            std::lock_guard<std::recursive_mutex> _(lock_);
-            auto result =
-                table_.emplace (std::piecewise_construct,
-                    std::make_tuple (kindOutbound, address),            // Key
-                    std::make_tuple (m_clock.now()));                   // Entry
-
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                    inactive_.erase (
-                        inactive_.iterator_to (*entry));
-                outbound_.push_back (*entry);
-            }
-        }
+        Entry& entry (insert (Key (kindOutbound, address)));
 
         JLOG(m_journal.debug()) <<
-            "New outbound endpoint " << *entry;
+            "New outbound endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     /**
@@ -174,31 +148,12 @@ public:
      */
     Consumer newUnlimitedEndpoint (std::string const& name)
     {
-        Entry* entry (nullptr);
-
-        {
-            std::lock_guard<std::recursive_mutex> _(lock_);
-            auto result =
-                table_.emplace (std::piecewise_construct,
-                    std::make_tuple (name),                             // Key
-                    std::make_tuple (m_clock.now()));                   // Entry
-
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                    inactive_.erase (
-                        inactive_.iterator_to (*entry));
-                admin_.push_back (*entry);
-            }
-        }
+        Entry& entry (insert (Key (name)));
 
         JLOG(m_journal.debug()) <<
-            "New unlimited endpoint " << *entry;
+            "New unlimited endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     Json::Value getJson ()
@@ -212,43 +167,13 @@ public:
         clock_type::time_point const now (m_clock.now());
 
         Json::Value ret (Json::objectValue);
-        std::lock_guard<std::recursive_mutex> _(lock_);
 
-        for (auto& inboundEntry : inbound_)
+        for (auto& shard : shards_)
         {
-            int localBalance = inboundEntry.local_balance.value (now);
-            if ((localBalance + inboundEntry.remote_balance) >= threshold)
-            {
-                Json::Value& entry = (ret[inboundEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = inboundEntry.remote_balance;
-                entry[jss::type] = "inbound";
-            }
-
-        }
-        for (auto& outboundEntry : outbound_)
-        {
-            int localBalance = outboundEntry.local_balance.value (now);
-            if ((localBalance + outboundEntry.remote_balance) >= threshold)
-            {
-                Json::Value& entry = (ret[outboundEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = outboundEntry.remote_balance;
-                entry[jss::type] = "outbound";
-            }
-
-        }
-        for (auto& adminEntry : admin_)
-        {
-            int localBalance = adminEntry.local_balance.value (now);
-            if ((localBalance + adminEntry.remote_balance) >= threshold)
-            {
-                Json::Value& entry = (ret[adminEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = adminEntry.remote_balance;
-                entry[jss::type] = "admin";
-            }
-
+            std::lock_guard<std::mutex> _(shard.lock);
+            writeJson (ret, now, threshold, shard.inbound, "inbound");
+            writeJson (ret, now, threshold, shard.outbound, "outbound");
+            writeJson (ret, now, threshold, shard.admin, "admin");
         }
 
         return ret;
@@ -259,18 +184,20 @@ public:
         clock_type::time_point const now (m_clock.now());
 
         Gossip gossip;
-        std::lock_guard<std::recursive_mutex> _(lock_);
-
-        gossip.items.reserve (inbound_.size());
 
-        for (auto& inboundEntry : inbound_)
+        for (auto& shard : shards_)
         {
-            Gossip::Item item;
-            item.balance = inboundEntry.local_balance.value (now);
-            if (item.balance >= minimumGossipBalance)
+            std::lock_guard<std::mutex> _(shard.lock);
+
+            for (auto& inboundEntry : shard.inbound)
             {
-                item.address = inboundEntry.key->address;
-                gossip.items.push_back (item);
+                Gossip::Item item;
+                item.balance = inboundEntry.local_balance.value (now);
+                if (item.balance >= minimumGossipBalance)
+                {
+                    item.address = inboundEntry.key->address;
+                    gossip.items.push_back (item);
+                }
             }
         }
 
@@ -283,7 +210,7 @@ public:
     {
         clock_type::rep const elapsed (m_clock.now().time_since_epoch().count());
         {
-            std::lock_guard<std::recursive_mutex> _(lock_);
+            std::lock_guard<std::mutex> _(importLock_);
             auto result =
                 importTable_.emplace (std::piecewise_construct,
                     std::make_tuple(origin),                  // Key
@@ -339,26 +266,34 @@ public:
     //
     void periodicActivity ()
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
-
         clock_type::rep const elapsed (m_clock.now().time_since_epoch().count());
 
-        for (auto iter (inactive_.begin()); iter != inactive_.end();)
+        // One shard at a time, so charges and new
+        // endpoints elsewhere in the table are not held up
+        for (auto& shard : shards_)
         {
-            if (iter->whenExpires <= elapsed)
-            {
-                JLOG(m_journal.debug()) << "Expired " << *iter;
-                auto table_iter =
-                    table_.find (*iter->key);
-                ++iter;
-                erase (table_iter);
-            }
-            else
+            std::lock_guard<std::mutex> _(shard.lock);
+
+            for (auto iter (shard.inactive.begin());
+                iter != shard.inactive.end();)
             {
-                break;
+                if (iter->whenExpires <= elapsed)
+                {
+                    JLOG(m_journal.debug()) << "Expired " << *iter;
+                    auto table_iter =
+                        shard.table.find (*iter->key);
+                    ++iter;
+                    erase (shard, table_iter);
+                }
+                else
+                {
+                    break;
+                }
             }
         }
 
+        std::lock_guard<std::mutex> _(importLock_);
+
         auto iter = importTable_.begin();
         while (iter != importTable_.end())
         {
@@ -392,56 +327,30 @@ public:
         return Disposition::ok;
     }
 
-    void erase (Table::iterator iter)
-    {
-        std::lock_guard<std::recursive_mutex> _(lock_);
-        Entry& entry (iter->second);
-        assert (entry.refcount == 0);
-        inactive_.erase (
-            inactive_.iterator_to (entry));
-        table_.erase (iter);
-    }
-
     void acquire (Entry& entry)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        std::lock_guard<std::mutex> _(shards_[entry.shard].lock);
         ++entry.refcount;
     }
 
     void release (Entry& entry)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        Shard& shard (shards_[entry.shard]);
+        std::lock_guard<std::mutex> _(shard.lock);
         if (--entry.refcount == 0)
         {
             JLOG(m_journal.debug()) <<
                 "Inactive " << entry;
 
-            switch (entry.key->kind)
-            {
-            case kindInbound:
-                inbound_.erase (
-                    inbound_.iterator_to (entry));
-                break;
-            case kindOutbound:
-                outbound_.erase (
-                    outbound_.iterator_to (entry));
-                break;
-            case kindUnlimited:
-                admin_.erase (
-                    admin_.iterator_to (entry));
-                break;
-            default:
-                assert(false);
-                break;
-            }
-            inactive_.push_back (entry);
+            active (shard, entry.key->kind).erase (
+                active (shard, entry.key->kind).iterator_to (entry));
+            shard.inactive.push_back (entry);
             entry.whenExpires = m_clock.now().time_since_epoch().count() + secondsUntilExpiration;
         }
     }
 
     Disposition charge (Entry& entry, Charge const& fee)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
         clock_type::time_point const now (m_clock.now());
         int const balance (entry.add (fee.cost(), now));
         JLOG(m_journal.trace()) <<
@@ -454,15 +363,18 @@ public:
         if (entry.isUnlimited())
             return false;
 
-        std::lock_guard<std::recursive_mutex> _(lock_);
         bool notify (false);
-        clock_type::rep const elapsed (m_clock.now().time_since_epoch().count());
-        if (entry.balance (m_clock.now()) >= warningThreshold &&
-            elapsed != entry.lastWarningTime)
+        clock_type::time_point const now (m_clock.now());
+        clock_type::rep const elapsed (now.time_since_epoch().count());
         {
-            charge (entry, feeWarning);
-            notify = true;
-            entry.lastWarningTime = elapsed;
+            std::lock_guard<std::mutex> _(shards_[entry.shard].lock);
+            if (entry.balance (now) >= warningThreshold &&
+                elapsed != entry.lastWarningTime)
+            {
+                charge (entry, feeWarning);
+                notify = true;
+                entry.lastWarningTime = elapsed;
+            }
         }
         if (notify)
         {
@@ -477,7 +389,7 @@ public:
         if (entry.isUnlimited())
             return false;
 
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        std::lock_guard<std::mutex> _(shards_[entry.shard].lock);
         bool drop (false);
         clock_type::time_point const now (m_clock.now());
         int const balance (entry.balance (now));
@@ -500,7 +412,6 @@ public:
 
     int balance (Entry& entry)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
         return entry.balance (m_clock.now());
     }
 
@@ -519,7 +430,7 @@ public:
             item ["name"] = entry.to_string();
             item ["balance"] = entry.balance(now);
             if (entry.remote_balance != 0)
-                item ["remote_balance"] = entry.remote_balance;
+                item ["remote_balance"] = entry.remote_balance.load();
         }
     }
 
@@ -527,26 +438,92 @@ public:
     {
         clock_type::time_point const now (m_clock.now());
 
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        writeLists (now, map, "inbound", &Shard::inbound);
+        writeLists (now, map, "outbound", &Shard::outbound);
+        writeLists (now, map, "admin", &Shard::admin);
+        writeLists (now, map, "inactive", &Shard::inactive);
+    }
+
+private:
+    // Find or add the entry for a key, and take a reference to it
+    Entry& insert (Key const& key)
+    {
+        std::size_t const index (hasher_ (key) % tableShards);
+        Shard& shard (shards_[index]);
+
+        std::lock_guard<std::mutex> _(shard.lock);
+        auto result =
+            shard.table.emplace (std::piecewise_construct,
+                std::make_tuple (key),                                  // Key
+                std::make_tuple (m_clock.now(), index));                // Entry
 
+        Entry& entry (result.first->second);
+        entry.key = &result.first->first;
+        ++entry.refcount;
+        if (entry.refcount == 1)
         {
-            beast::PropertyStream::Set s ("inbound", map);
-            writeList (now, s, inbound_);
+            if (! result.second)
+                shard.inactive.erase (
+                    shard.inactive.iterator_to (entry));
+            active (shard, key.kind).push_back (entry);
         }
+        return entry;
+    }
 
+    // Returns the list of active entries of a kind
+    static EntryIntrusiveList& active (Shard& shard, Kind kind)
+    {
+        switch (kind)
         {
-            beast::PropertyStream::Set s ("outbound", map);
-            writeList (now, s, outbound_);
+        case kindInbound:
+            return shard.inbound;
+        case kindOutbound:
+            return shard.outbound;
+        case kindUnlimited:
+            return shard.admin;
+        default:
+            assert(false);
+            return shard.inactive;
         }
+    }
 
+    // Call with the shard locked
+    void erase (Shard& shard, Table::iterator iter)
+    {
+        Entry& entry (iter->second);
+        assert (entry.refcount == 0);
+        shard.inactive.erase (
+            shard.inactive.iterator_to (entry));
+        shard.table.erase (iter);
+    }
+
+    void writeJson (Json::Value& ret,
+        clock_type::time_point const now, int threshold,
+            EntryIntrusiveList& list, char const* type)
+    {
+        for (auto& listEntry : list)
         {
-            beast::PropertyStream::Set s ("admin", map);
-            writeList (now, s, admin_);
+            int localBalance = listEntry.local_balance.value (now);
+            if ((localBalance + listEntry.remote_balance) >= threshold)
+            {
+                Json::Value& entry = (ret[listEntry.to_string()] = Json::objectValue);
+                entry[jss::local] = localBalance;
+                entry[jss::remote] = listEntry.remote_balance.load();
+                entry[jss::type] = type;
+            }
         }
+    }
 
+    void writeLists (
+        clock_type::time_point const now,
+            beast::PropertyStream::Map& map, std::string const& name,
+                EntryIntrusiveList Shard::* list)
+    {
+        beast::PropertyStream::Set s (name, map);
+        for (auto& shard : shards_)
         {
-            beast::PropertyStream::Set s ("inactive", map);
-            writeList (now, s, inactive_);
+            std::lock_guard<std::mutex> _(shard.lock);
+            writeList (now, s, shard.*list);
         }
     }
 };
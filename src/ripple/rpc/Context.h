@@ -35,6 +35,8 @@ class LedgerMaster;
 
 namespace RPC {
 
+class ResultStream;
+
 /** The context of information needed to call an RPC. */
 struct Context
 {
@@ -58,6 +60,11 @@ struct Context
     std::shared_ptr<JobCoro> jobCoro;
     InfoSub::pointer infoSub;
     Headers headers;
+
+    /** Where a handler may put a streamed part of its result.
+        Null when the transport can only send whole results.
+    */
+    std::shared_ptr<ResultStream>* stream = nullptr;
 };
 
 } // RPC
@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_RPC_RESULTSTREAM_H_INCLUDED
+#define RIPPLE_RPC_RESULTSTREAM_H_INCLUDED
+
+#include <string>
+
+namespace ripple {
+namespace RPC {
+
+/** An array in an RPC result which is sent while it is rendered.
+
+    A handler whose result could be too large to hold in memory may,
+    if the transport supports it, return the other fields of its result
+    as usual and set one of these in the Context for the large array.
+    The transport sends the rest of the result first. It then pulls the
+    elements a chunk at a time, no faster than the client reads them.
+*/
+class ResultStream
+{
+public:
+    virtual ~ResultStream() = default;
+
+    /** Returns the name of the streamed array in the result. */
+    virtual
+    char const*
+    field() const = 0;
+
+    /** Append the next elements of the array as JSON text.
+
+        The elements are separated by commas, without the enclosing
+        brackets. Rendering stops once at least `bytes` have been
+        appended. An exception ends the result early.
+
+        @return `true` if no elements remain.
+    */
+    virtual
+    bool
+    write (std::string& out, std::size_t bytes) = 0;
+};
+
+} // RPC
+} // ripple
+
+#endif
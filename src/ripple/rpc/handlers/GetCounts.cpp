@@ -57,6 +57,26 @@ void textTime (
         text += "s";
 }
 
+static
+Json::Value partitionCounts (
+    std::vector <TaggedCachePartitionStats> const& stats)
+{
+    Json::Value ret (Json::arrayValue);
+
+    for (auto const& s : stats)
+    {
+        Json::Value& entry = ret.append (Json::objectValue);
+        entry[jss::cache_size] = s.cacheSize;
+        entry[jss::cache_bytes] = static_cast<Json::UInt> (s.cacheBytes);
+        entry[jss::track_size] = static_cast<Json::UInt> (s.trackSize);
+        entry[jss::hits] = static_cast<Json::UInt> (s.hits);
+        entry[jss::misses] = static_cast<Json::UInt> (s.misses);
+        entry[jss::contended] = static_cast<Json::UInt> (s.contended);
+    }
+
+    return ret;
+}
+
 // {
 //   min_count: <number>  // optional, defaults to 10
 // }
@@ -91,6 +111,9 @@ Json::Value doGetCounts (RPC::Context& context)
     if (dbKB > 0)
         ret[jss::dbKBTransaction] = dbKB;
 
+    ret[jss::ledger_db] = context.app.getLedgerDB ().getJson ();
+    ret[jss::transaction_db] = context.app.getTxnDB ().getJson ();
+
     {
         std::size_t c = context.app.getOPs().getLocalTxCount ();
         if (c > 0)
@@ -109,6 +132,35 @@ Json::Value doGetCounts (RPC::Context& context)
     ret[jss::fullbelow_size] = static_cast<int>(context.app.family().fullbelow().size());
     ret[jss::treenode_cache_size] = context.app.family().treecache().getCacheSize();
     ret[jss::treenode_track_size] = context.app.family().treecache().getTrackSize();
+    ret[jss::treenode_cache_bytes] = static_cast<Json::UInt>(
+        context.app.family().treecache().getCacheBytes());
+
+    {
+        auto const& budget = context.app.getCacheBudget ();
+        std::uint64_t used = 0;
+        Json::Value usage (Json::objectValue);
+        for (auto const& u : budget.getUsage ())
+        {
+            used += u.second;
+            usage[u.first] = static_cast<Json::UInt> (
+                usage[u.first].asUInt () + u.second / 1024);
+        }
+        ret[jss::cache_budget_kb] = static_cast<Json::UInt> (
+            budget.getBudget () / 1024);
+        ret[jss::cache_used_kb] = static_cast<Json::UInt> (used / 1024);
+        ret[jss::cache_scale] = budget.getScale ();
+        ret[jss::cache_usage_kb] = usage;
+    }
+
+    if (context.app.family().treecache().getPartitionCount () > 1)
+        ret[jss::treenode_cache_partitions] = partitionCounts (
+            context.app.family().treecache().getPartitionStats ());
+
+    {
+        auto const stats = context.app.getNodeStore ().getCachePartitionStats ();
+        if (stats.size () > 1)
+            ret[jss::node_cache_partitions] = partitionCounts (stats);
+    }
 
     std::string uptime;
     int s = UptimeTimer::getInstance ().getElapsedSeconds ();
@@ -122,6 +174,8 @@ Json::Value doGetCounts (RPC::Context& context)
     ret[jss::node_writes] = context.app.getNodeStore().getStoreCount();
     ret[jss::node_reads_total] = context.app.getNodeStore().getFetchTotalCount();
     ret[jss::node_reads_hit] = context.app.getNodeStore().getFetchHitCount();
+    ret[jss::node_read_errors] =
+        context.app.getNodeStore().getFetchErrorCount();
     ret[jss::node_written_bytes] = context.app.getNodeStore().getStoreSize();
     ret[jss::node_read_bytes] = context.app.getNodeStore().getFetchSize();
 
@@ -18,22 +18,121 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/LedgerToJson.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/basics/contract.h>
+#include <ripple/json/to_string.h>
 #include <ripple/ledger/ReadView.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/JsonFields.h>
+#include <ripple/resource/Fees.h>
 #include <ripple/rpc/impl/RPCHelpers.h>
 #include <ripple/rpc/impl/Tuning.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/rpc/ResultStream.h>
 #include <ripple/rpc/Role.h>
+#include <boost/optional.hpp>
 
 namespace ripple {
 
+// Streams the state nodes of a ledger in key order, walking the
+// state map once. The consumer is charged for each page's worth of
+// nodes, as if they had been requested a page at a time.
+class LedgerDataStream : public RPC::ResultStream
+{
+    std::shared_ptr<ReadView const> ledger_;
+    Resource::Consumer consumer_;
+    bool const binary_;
+    bool first_ = true;
+    int count_ = 0;
+
+    // Binary nodes of a closed ledger are copied from the leaves
+    // of its state map, without deserializing them.
+    std::shared_ptr<Ledger const> closed_;
+    boost::optional<SHAMap::const_iterator> leaf_;
+    boost::optional<ReadView::sles_type::iterator> sle_;
+
+public:
+    LedgerDataStream (std::shared_ptr<ReadView const> ledger,
+            ReadView::key_type const& marker, bool binary,
+                Resource::Consumer const& consumer)
+        : ledger_ (std::move (ledger))
+        , consumer_ (consumer)
+        , binary_ (binary)
+    {
+        if (binary_)
+            closed_ = std::dynamic_pointer_cast<Ledger const> (ledger_);
+
+        if (closed_)
+            leaf_ = closed_->stateMap ().upper_bound (marker);
+        else
+            sle_ = ledger_->sles.upper_bound (marker);
+    }
+
+    char const*
+    field() const override
+    {
+        return jss::state.c_str ();
+    }
+
+    bool
+    write (std::string& out, std::size_t bytes) override
+    {
+        auto const limit = out.size () + bytes;
+        while (out.size () < limit)
+        {
+            if (closed_ ?
+                (*leaf_ == closed_->stateMap ().end ()) :
+                (*sle_ == ledger_->sles.end ()))
+                return true;
+
+            if (! first_)
+                out += ',';
+            first_ = false;
+
+            if (closed_)
+            {
+                auto const& item = **leaf_;
+                out += "{\"data\":\"";
+                out += strHex (item.peekData ());
+                out += "\",\"index\":\"";
+                out += to_string (item.key ());
+                out += "\"}";
+                ++*leaf_;
+            }
+            else
+            {
+                auto const& sle = **sle_;
+                Json::Value entry;
+                if (binary_)
+                    entry[jss::data] = serializeHex (*sle);
+                else
+                    entry = sle->getJson (0);
+                entry[jss::index] = to_string (sle->key ());
+                out += to_string (entry);
+                ++*sle_;
+            }
+
+            if (++count_ == RPC::Tuning::pageLength (binary_))
+            {
+                count_ = 0;
+                consumer_.charge (Resource::feeReferenceRPC);
+                if (consumer_.disconnect ())
+                    Throw<std::runtime_error> ("load limit exceeded");
+            }
+        }
+        return false;
+    }
+};
+
 // Get state nodes from a ledger
 //   Inputs:
 //     limit:        integer, maximum number of entries
 //     marker:       opaque, resume point
 //     binary:       boolean, format
+//     stream:       boolean, send every entry after the marker as it
+//                   is read, if the connection supports it
 //   Outputs:
 //     ledger_hash:  chosen ledger's hash
 //     ledger_index: chosen ledger's index
@@ -58,6 +157,20 @@ Json::Value doLedgerData (RPC::Context& context)
 
     bool isBinary = params[jss::binary].asBool();
 
+    if (params[jss::stream].asBool ())
+    {
+        if (! context.stream)
+            return RPC::make_error (rpcNOT_SUPPORTED,
+                "Streaming is not supported on this connection.");
+
+        jvResult[jss::ledger_hash] = to_string (lpLedger->info().hash);
+        jvResult[jss::ledger_index] = lpLedger->info().seq;
+
+        *context.stream = std::make_shared<LedgerDataStream> (
+            lpLedger, *key, isBinary, context.consumer);
+        return jvResult;
+    }
+
     int limit = -1;
     if (params.isMember (jss::limit))
     {
@@ -80,7 +193,7 @@ Json::Value doLedgerData (RPC::Context& context)
     auto e = lpLedger->sles.end();
     for (auto i = lpLedger->sles.upper_bound(*key); i != e; ++i)
     {
-        auto sle = lpLedger->read(keylet::unchecked((*i)->key()));
+        auto const& sle = *i;
         if (limit-- <= 0)
         {
             // Stop processing before the current key.
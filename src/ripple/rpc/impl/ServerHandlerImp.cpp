@@ -38,7 +38,9 @@
 #include <ripple/resource/ResourceManager.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/impl/Tuning.h>
+#include <ripple/rpc/ResultStream.h>
 #include <ripple/rpc/RPCHandler.h>
+#include <ripple/server/Writer.h>
 #include <beast/core/detail/base64.hpp>
 #include <beast/http/headers.hpp>
 #include <boost/algorithm/string.hpp>
@@ -46,6 +48,7 @@
 #include <boost/optional.hpp>
 #include <boost/regex.hpp>
 #include <algorithm>
+#include <mutex>
 #include <stdexcept>
 
 namespace ripple {
@@ -213,6 +216,257 @@ buffers_to_string(ConstBufferSequence const& bs)
     return s;
 }
 
+//------------------------------------------------------------------------------
+
+// Renders a streamed result on the job queue, one chunk ahead of the
+// connection, so that a slow client holds up the rendering instead of
+// the whole result being buffered.
+class ResultStreamPump
+    : public std::enable_shared_from_this<ResultStreamPump>
+{
+public:
+    enum class State
+    {
+        ready,      // Text was taken
+        pending,    // No text yet, resume will be called
+        done,       // All the text was taken
+        failed      // The result ended early
+    };
+
+    ResultStreamPump (JobQueue& jobQueue, beast::Journal journal,
+            std::shared_ptr<RPC::ResultStream> stream,
+                std::string prefix, std::string suffix)
+        : jobQueue_ (jobQueue)
+        , j_ (journal)
+        , stream_ (std::move (stream))
+        , suffix_ (std::move (suffix))
+        , ready_ (std::move (prefix))
+    {
+    }
+
+    // Take the text rendered so far. When there is none, `resume`
+    // is called once there is.
+    State
+    take (std::string& out, std::function<void(void)> resume)
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        if (! ready_.empty ())
+        {
+            out.clear ();
+            out.swap (ready_);
+            // Render the next chunk while this one is sent
+            start ();
+            return State::ready;
+        }
+        if (failed_)
+            return State::failed;
+        if (finished_)
+            return State::done;
+        start ();
+        if (failed_)
+            return State::failed;
+        resume_ = std::move (resume);
+        return State::pending;
+    }
+
+private:
+    void
+    start ()
+    {
+        if (busy_ || finished_ || failed_)
+            return;
+        if (jobQueue_.isStopping ())
+        {
+            failed_ = true;
+            return;
+        }
+        busy_ = true;
+        jobQueue_.addJob (jtCLIENT, "RPC::stream",
+            [self = shared_from_this()](Job&) { self->render (); });
+    }
+
+    void
+    render ()
+    {
+        std::string text;
+        bool done = false;
+        bool failed = false;
+        try
+        {
+            done = stream_->write (text, RPC::Tuning::streamChunkBytes);
+            if (done)
+                text += suffix_;
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (j_.warn()) << "Streamed result ended early: " << e.what();
+            failed = true;
+        }
+
+        std::function<void(void)> resume;
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            busy_ = false;
+            if (failed)
+                failed_ = true;
+            else
+                ready_ = std::move (text);
+            finished_ = done;
+            resume.swap (resume_);
+        }
+        if (resume)
+            resume ();
+    }
+
+    JobQueue& jobQueue_;
+    beast::Journal j_;
+    std::shared_ptr<RPC::ResultStream> stream_;
+    std::string const suffix_;
+
+    std::mutex mutex_;
+    std::string ready_;
+    std::function<void(void)> resume_;
+    bool busy_ = false;
+    bool finished_ = false;
+    bool failed_ = false;
+};
+
+// Sends a streamed result as the chunked body of an HTTP reply.
+// A result which ends early ends without the last chunk, so that
+// the client can tell it is incomplete.
+class ResultStreamWriter : public Writer
+{
+    std::shared_ptr<ResultStreamPump> pump_;
+    std::string buf_;
+    std::size_t pos_ = 0;
+    bool done_ = false;
+
+public:
+    ResultStreamWriter (std::shared_ptr<ResultStreamPump> pump)
+        : pump_ (std::move (pump))
+        , buf_ (HTTPChunkedReplyHeader ())
+    {
+    }
+
+    bool
+    complete() override
+    {
+        return done_ && pos_ == buf_.size();
+    }
+
+    void
+    consume (std::size_t bytes) override
+    {
+        pos_ += bytes;
+    }
+
+    bool
+    prepare (std::size_t, std::function<void(void)> resume) override
+    {
+        if (pos_ < buf_.size() || done_)
+            return true;
+
+        std::string text;
+        switch (pump_->take (text, std::move (resume)))
+        {
+        case ResultStreamPump::State::ready:
+        {
+            std::stringstream ss;
+            ss << std::hex << text.size() << "\r\n";
+            buf_ = ss.str() + text + "\r\n";
+            break;
+        }
+        case ResultStreamPump::State::done:
+            buf_ = "0\r\n\r\n";
+            done_ = true;
+            break;
+        case ResultStreamPump::State::failed:
+            // Nothing more is written, and the connection closes
+            // without the last chunk.
+            buf_.clear();
+            done_ = true;
+            break;
+        case ResultStreamPump::State::pending:
+            return false;
+        }
+        pos_ = 0;
+        return true;
+    }
+
+    std::vector<boost::asio::const_buffer>
+    data() override
+    {
+        return {boost::asio::const_buffer (
+            buf_.data() + pos_, buf_.size() - pos_)};
+    }
+};
+
+// Sends a streamed result as the frames of one WebSocket message.
+// A result which ends early ends the message early, leaving text
+// which does not parse.
+class ResultStreamWSMsg : public WSMsg
+{
+    std::shared_ptr<ResultStreamPump> pump_;
+    std::string buf_;
+    std::size_t pos_ = 0;
+    std::size_t n_ = 0;
+
+public:
+    explicit
+    ResultStreamWSMsg (std::shared_ptr<ResultStreamPump> pump)
+        : pump_ (std::move (pump))
+    {
+    }
+
+    std::pair<boost::tribool,
+        std::vector<boost::asio::const_buffer>>
+    prepare (std::size_t bytes,
+        std::function<void(void)> resume) override
+    {
+        pos_ += n_;
+        n_ = 0;
+        if (pos_ == buf_.size())
+        {
+            switch (pump_->take (buf_, std::move (resume)))
+            {
+            case ResultStreamPump::State::ready:
+                pos_ = 0;
+                break;
+            case ResultStreamPump::State::pending:
+                return {boost::indeterminate, {}};
+            case ResultStreamPump::State::done:
+            case ResultStreamPump::State::failed:
+                return {true, {}};
+            }
+        }
+        n_ = std::min (bytes, buf_.size() - pos_);
+        return {false, {boost::asio::const_buffer (
+            buf_.data() + pos_, n_)}};
+    }
+};
+
+// Returns the text of a reply before and after the streamed array
+// in its result.
+static
+std::pair<std::string, std::string>
+splitReply (Json::Value& reply, Json::Value& result,
+    RPC::ResultStream const& stream)
+{
+    static Json::StaticString const placeholder ("\x01stream\x01");
+    result[stream.field()] = placeholder;
+
+    auto const text = to_string (reply);
+    auto const key = to_string (Json::Value (stream.field())) + ":";
+    auto const value = to_string (Json::Value (placeholder));
+    auto const pos = text.find (key + value);
+    assert (pos != std::string::npos);
+
+    auto const start = pos + key.size();
+    return {
+        text.substr (0, start) + "[",
+        "]" + text.substr (start + value.size())};
+}
+
 void
 ServerHandlerImp::onRequest (Session& session)
 {
@@ -279,8 +533,20 @@ ServerHandlerImp::onWSMessage(
         [this, session = std::move(session),
             jv = std::move(jv)](auto const& jc)
         {
-            auto const jr =
-                this->processSession(session, jc, jv);
+            std::shared_ptr<RPC::ResultStream> stream;
+            auto jr =
+                this->processSession(session, jc, jv, stream);
+            if (stream)
+            {
+                auto text = splitReply(jr, jr[jss::result], *stream);
+                session->send(std::make_shared<ResultStreamWSMsg>(
+                    std::make_shared<ResultStreamPump>(m_jobQueue,
+                        m_journal, std::move(stream),
+                            std::move(text.first),
+                                std::move(text.second))));
+                session->complete();
+                return;
+            }
             auto const s = to_string(jr);
             auto const n = s.length();
             beast::streambuf sb(n);
@@ -312,7 +578,8 @@ Json::Value
 ServerHandlerImp::processSession(
     std::shared_ptr<WSSession> const& session,
         std::shared_ptr<JobCoro> const& coro,
-            Json::Value const& jv)
+            Json::Value const& jv,
+                std::shared_ptr<RPC::ResultStream>& stream)
 {
     auto is = std::static_pointer_cast<WSInfoSub> (session->appDefined);
     if (is->getConsumer().disconnect())
@@ -361,7 +628,8 @@ ServerHandlerImp::processSession(
             role,
             coro,
             is,
-            {is->user(), is->forwarded_for()}
+            {is->user(), is->forwarded_for()},
+            &stream
             };
         RPC::doCommand(context, jr[jss::result]);
     }
@@ -380,7 +648,7 @@ ServerHandlerImp::processSession(
         jr = jr[jss::result];
         jr[jss::status] = jss::error;
         jr[jss::request] = jv;
-
+        stream.reset();
     }
     else
     {
@@ -403,7 +671,7 @@ void
 ServerHandlerImp::processSession (std::shared_ptr<Session> const& session,
     std::shared_ptr<JobCoro> jobCoro)
 {
-    processRequest (
+    auto const writer = processRequest (
         session->port(), buffers_to_string(
             session->request().body.data()),
                 session->remoteAddress().at_port (0),
@@ -427,13 +695,16 @@ ServerHandlerImp::processSession (std::shared_ptr<Session> const& session,
             return std::string{};
         }());
 
-    if(is_keep_alive(session->request()))
+    // A streamed reply ends the connection
+    if (writer)
+        session->write (writer, false);
+    else if(is_keep_alive(session->request()))
         session->complete();
     else
         session->close (true);
 }
 
-void
+std::shared_ptr<Writer>
 ServerHandlerImp::processRequest (Port const& port,
     std::string const& request, beast::IP::Endpoint const& remoteIPAddress,
         Output&& output, std::shared_ptr<JobCoro> jobCoro,
@@ -450,7 +721,7 @@ ServerHandlerImp::processRequest (Port const& port,
             ! jsonRPC.isObject ())
         {
             HTTPReply (400, "Unable to parse request", output, rpcJ);
-            return;
+            return {};
         }
     }
 
@@ -463,12 +734,12 @@ ServerHandlerImp::processRequest (Port const& port,
 
     if (! method) {
         HTTPReply (400, "Null method", output, rpcJ);
-        return;
+        return {};
     }
 
     if (!method.isString ()) {
         HTTPReply (400, "method is not string", output, rpcJ);
-        return;
+        return {};
     }
 
     /* ---------------------------------------------------------------------- */
@@ -510,7 +781,7 @@ ServerHandlerImp::processRequest (Port const& port,
         if (usage.disconnect())
         {
             HTTPReply(503, "Server is overloaded", output, rpcJ);
-            return;
+            return {};
         }
     }
 
@@ -518,7 +789,7 @@ ServerHandlerImp::processRequest (Port const& port,
     if (strMethod.empty())
     {
         HTTPReply (400, "method is empty", output, rpcJ);
-        return;
+        return {};
     }
 
     // Extract request parameters from the request Json as `params`.
@@ -535,7 +806,7 @@ ServerHandlerImp::processRequest (Port const& port,
     else if (!params.isArray () || params.size() != 1)
     {
         HTTPReply (400, "params unparseable", output, rpcJ);
-        return;
+        return {};
     }
     else
     {
@@ -543,7 +814,7 @@ ServerHandlerImp::processRequest (Port const& port,
         if (!params.isObject())
         {
             HTTPReply (400, "params unparseable", output, rpcJ);
-            return;
+            return {};
         }
     }
 
@@ -555,7 +826,7 @@ ServerHandlerImp::processRequest (Port const& port,
         // FIXME Needs implementing
         // XXX This needs rate limiting to prevent brute forcing password.
         HTTPReply (403, "Forbidden", output, rpcJ);
-        return;
+        return {};
     }
 
     JLOG(m_journal.debug()) << "Query: " << strMethod << params;
@@ -568,9 +839,10 @@ ServerHandlerImp::processRequest (Port const& port,
     Resource::Charge loadType = Resource::feeReferenceRPC;
     auto const start (std::chrono::high_resolution_clock::now ());
 
+    std::shared_ptr<RPC::ResultStream> stream;
     RPC::Context context {m_journal, params, app_, loadType, m_networkOPs,
         app_.getLedgerMaster(), usage, role, jobCoro, InfoSub::pointer(),
-        {user, forwardedFor}};
+        {user, forwardedFor}, &stream};
     Json::Value result;
     RPC::doCommand (context, result);
 
@@ -582,6 +854,7 @@ ServerHandlerImp::processRequest (Port const& port,
         JLOG (m_journal.debug())  <<
             "rpcError: " << result [jss::error] <<
             ": " << result [jss::error_message];
+        stream.reset ();
     }
     else
     {
@@ -590,6 +863,26 @@ ServerHandlerImp::processRequest (Port const& port,
 
     Json::Value reply (Json::objectValue);
     reply[jss::result] = std::move (result);
+
+    if (stream)
+    {
+        auto text = splitReply (reply, reply[jss::result], *stream);
+        text.second += '\n';
+
+        rpc_time_.notify (static_cast <beast::insight::Event::value_type> (
+            std::chrono::duration_cast <std::chrono::milliseconds> (
+                std::chrono::high_resolution_clock::now () - start)));
+        ++rpc_requests_;
+        usage.charge (loadType);
+
+        JLOG (m_journal.debug()) << "Reply: " << text.first << "...";
+
+        return std::make_shared<ResultStreamWriter> (
+            std::make_shared<ResultStreamPump> (m_jobQueue, rpcJ,
+                std::move (stream), std::move (text.first),
+                    std::move (text.second)));
+    }
+
     auto response = to_string (reply);
 
     rpc_time_.notify (static_cast <beast::insight::Event::value_type> (
@@ -612,6 +905,7 @@ ServerHandlerImp::processRequest (Port const& port,
     }
 
     HTTPReply (200, response, output, rpcJ);
+    return {};
 }
 
 //------------------------------------------------------------------------------
@@ -23,6 +23,7 @@
 #include <ripple/core/Job.h>
 #include <ripple/core/JobCoro.h>
 #include <ripple/rpc/impl/WSInfoSub.h>
+#include <ripple/rpc/ResultStream.h>
 #include <ripple/server/Server.h>
 #include <ripple/server/Session.h>
 #include <ripple/server/WSSession.h>
@@ -155,13 +156,16 @@ public:
     processSession(
         std::shared_ptr<WSSession> const& session,
             std::shared_ptr<JobCoro> const& coro,
-                Json::Value const& jv);
+                Json::Value const& jv,
+                    std::shared_ptr<RPC::ResultStream>& stream);
 
     void
     processSession (std::shared_ptr<Session> const&,
         std::shared_ptr<JobCoro> jobCoro);
 
-    void
+    // Returns the writer for a streamed reply, or null
+    // if the reply was written to the output.
+    std::shared_ptr<Writer>
     processRequest (Port const& port, std::string const& request,
         beast::IP::Endpoint const& remoteIPAddress, Output&&,
         std::shared_ptr<JobCoro> jobCoro,
@@ -20,6 +20,8 @@
 #ifndef RIPPLE_RPC_TUNING_H_INCLUDED
 #define RIPPLE_RPC_TUNING_H_INCLUDED
 
+#include <cstddef>
+
 namespace ripple {
 namespace RPC {
 
@@ -71,6 +73,9 @@ inline int pageLength(bool isBinary)
     return isBinary ? binaryPageLength : jsonPageLength;
 }
 
+/** Least number of bytes of a streamed result rendered at once. */
+static std::size_t const streamChunkBytes = 64 * 1024;
+
 /** Maximum number of source currencies allowed in a path find request. */
 static int const max_src_cur = 18;
 
@@ -86,6 +86,16 @@ public:
                 std::move(sb));
         sp->send(m);
     }
+
+    void
+    send(std::shared_ptr<Message const> const& m, bool) override
+    {
+        auto sp = ws_.lock();
+        if(! sp)
+            return;
+        sp->send(std::make_shared<
+            SharedTextWSMsg>(m->text()));
+    }
 };
 
 } // ripple
@@ -30,6 +30,7 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -106,6 +107,40 @@ public:
     }
 };
 
+/** A WSMsg holding text which may be shared with other messages.
+
+    The text is never modified, so one rendering of a published
+    message can be queued on many sessions at once.
+*/
+class SharedTextWSMsg : public WSMsg
+{
+    std::shared_ptr<std::string const> text_;
+    std::size_t pos_ = 0;
+    std::size_t n_ = 0;
+
+public:
+    explicit
+    SharedTextWSMsg(std::shared_ptr<std::string const> text)
+        : text_(std::move(text))
+    {
+    }
+
+    std::pair<boost::tribool,
+        std::vector<boost::asio::const_buffer>>
+    prepare(std::size_t bytes,
+        std::function<void(void)>) override
+    {
+        pos_ += n_;
+        auto const remain = text_->size() - pos_;
+        if (remain == 0)
+            return{true, {}};
+        n_ = std::min(bytes, remain);
+        boost::tribool const done = (n_ == remain);
+        return{done, {boost::asio::const_buffer(
+            text_->data() + pos_, n_)}};
+    }
+};
+
 struct WSSession
 {
     std::shared_ptr<void> appDefined;
@@ -117,4 +117,17 @@ void HTTPReply (
     output ("\r\n");
 }
 
+std::string HTTPChunkedReplyHeader ()
+{
+    return
+        "HTTP/1.1 200 OK\r\n" +
+        getHTTPHeaderTimestamp () +
+        "Connection: close\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "Content-Type: application/json; charset=UTF-8\r\n"
+        "Server: " + systemName () + "-json-rpc/" +
+        BuildInfo::getFullVersionString () + "\r\n"
+        "\r\n";
+}
+
 } // ripple
@@ -28,6 +28,11 @@ namespace ripple {
 void HTTPReply (
     int nStatus, std::string const& strMsg, Json::Output const&, beast::Journal j);
 
+/** Returns the header of a successful reply whose body is sent in chunks.
+    The connection closes after the reply.
+*/
+std::string HTTPChunkedReplyHeader ();
+
 } // ripple
 
 #endif
@@ -26,6 +26,7 @@
 #include <ripple/nodestore/Database.h>
 #include <ripple/beast/utility/Journal.h>
 #include <cstdint>
+#include <functional>
 
 namespace ripple {
 
@@ -69,6 +70,17 @@ public:
     virtual
     void
     missing_node (uint256 const& refHash) = 0;
+
+    /** Calls a function for each index in [0, count).
+
+        The calls may be spread over up to `jobs` threads, the
+        caller's included, and all are done when this returns.
+        If a call throws, the first exception is rethrown.
+    */
+    virtual
+    void
+    parallelFor (std::size_t count, int jobs,
+        std::function <void(std::size_t)> const& f) = 0;
 };
 
 } // ripple
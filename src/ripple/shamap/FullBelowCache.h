@@ -83,6 +83,14 @@ public:
         return m_cache.size ();
     }
 
+    /** Share a memory budget with other caches.
+        @note The budget must outlive the cache.
+    */
+    void setBudget (CacheBudget& budget)
+    {
+        m_cache.setBudget (budget);
+    }
+
     /** Remove expired cache items.
         Thread safety:
             Safe to call from any thread.
@@ -36,6 +36,7 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_lock_guard.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <atomic>
 #include <cassert>
 #include <stack>
 #include <vector>
@@ -84,9 +85,12 @@ private:
     std::uint32_t                   seq_;
     std::uint32_t                   ledgerSeq_ = 0; // sequence number of ledger this is part of
     std::shared_ptr<SHAMapAbstractNode> root_;
-    mutable SHAMapState             state_;
+    // Atomic because replies from several peers may be added to
+    // a synching map at once
+    mutable std::atomic<SHAMapState> state_;
     SHAMapType                      type_;
     bool                            backed_ = true; // Map is backed by the database
+    int                             flushThreshold_ = 128; // see setFlushThreshold
 
 public:
     class version
@@ -186,7 +190,23 @@ public:
     std::vector<std::pair<SHAMapNodeID, uint256>>
     getMissingNodes (
         std::size_t max,
-        SHAMapSyncFilter *filter);
+        SHAMapSyncFilter *filter,
+        NodeStore::FetchPriority priority = NodeStore::FetchPriority::normal);
+
+    /** Divide missing nodes into groups to request from different peers.
+
+        A node goes to the group picked by the branch of the root it
+        lies under, so no two groups share any inner node but the
+        root. The replies to each group can then be added at the
+        same time without contending for the same nodes.
+
+        @param parts The number of groups, at least one.
+    */
+    static
+    std::vector<std::vector<std::pair<SHAMapNodeID, uint256>>>
+    splitMissingNodes (
+        std::vector<std::pair<SHAMapNodeID, uint256>> const& nodes,
+        std::size_t parts);
 
     bool getNodeFat (SHAMapNodeID node,
         std::vector<SHAMapNodeID>& nodeIDs,
@@ -213,6 +233,16 @@ public:
                   Delta& differences, int maxCount) const;
 
     int flushDirty (NodeObjectType t, std::uint32_t seq);
+
+    /** Set when flushing hashes the branches of the root in parallel.
+
+        Flushing counts the modified nodes two levels below the root.
+        If there are at least this many, the modified branches of the
+        root are hashed and written on several threads before the root
+        itself. Fewer, and the whole map is flushed on the caller's
+        thread, which is cheaper for small changes.
+    */
+    void setFlushThreshold (int threshold);
     void walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const;
     bool deepCompare (SHAMap & other) const;  // Intended for debug/test only
 
@@ -279,6 +309,9 @@ private:
     std::shared_ptr<SHAMapAbstractNode>
         writeNode(NodeObjectType t, std::uint32_t seq,
                   std::shared_ptr<SHAMapAbstractNode> node) const;
+    std::shared_ptr<SHAMapAbstractNode>
+        writeNode(NodeObjectType t, std::uint32_t seq,
+                  std::shared_ptr<SHAMapAbstractNode> node, Blob&& raw) const;
 
     SHAMapTreeNode* firstBelow (std::shared_ptr<SHAMapAbstractNode>,
                                 SharedPtrNodeStack& stack, int branch = 0) const;
@@ -292,7 +325,8 @@ private:
 
     // Descend with filter
     SHAMapAbstractNode* descendAsync (SHAMapInnerNode* parent, int branch,
-        SHAMapSyncFilter* filter, bool& pending) const;
+        SHAMapSyncFilter* filter, bool& pending,
+        NodeStore::FetchPriority priority) const;
 
     std::pair <SHAMapAbstractNode*, SHAMapNodeID>
         descend (SHAMapInnerNode* parent, SHAMapNodeID const& parentID,
@@ -315,6 +349,13 @@ private:
                      std::shared_ptr<SHAMapItem const> const& otherMapItem,
                      bool isFirstMap, Delta & differences, int & maxCount) const;
     int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq);
+    int flushSubTree (std::shared_ptr<SHAMapInnerNode>& node,
+                      bool doWrite, NodeObjectType t, std::uint32_t seq);
+    int flushRootBranches (std::shared_ptr<SHAMapInnerNode> const& root,
+                           bool doWrite, NodeObjectType t, std::uint32_t seq);
+    int countModified (std::shared_ptr<SHAMapInnerNode> const& root) const;
+    int flushLeaves (std::shared_ptr<SHAMapInnerNode> const& top,
+                     bool doWrite, NodeObjectType t, std::uint32_t seq);
     bool isInconsistentNode(std::shared_ptr<SHAMapAbstractNode> const& node) const;
 };
 
@@ -325,6 +366,13 @@ SHAMap::setLedgerSeq (std::uint32_t lseq)
     ledgerSeq_ = lseq;
 }
 
+inline
+void
+SHAMap::setFlushThreshold (int threshold)
+{
+    flushThreshold_ = threshold;
+}
+
 inline
 void
 SHAMap::setImmutable ()
@@ -337,7 +385,8 @@ inline
 bool
 SHAMap::isSynching () const
 {
-    return (state_ == SHAMapState::Floating) || (state_ == SHAMapState::Synching);
+    auto const state = state_.load ();
+    return (state == SHAMapState::Floating) || (state == SHAMapState::Synching);
 }
 
 inline
@@ -351,7 +400,11 @@ inline
 void
 SHAMap::clearSynching ()
 {
-    state_ = SHAMapState::Modifying;
+    // A map found to be invalid stays that way
+    auto state = state_.load ();
+    while ((state != SHAMapState::Invalid) &&
+            !state_.compare_exchange_weak (state, SHAMapState::Modifying))
+        ;
 }
 
 inline
@@ -23,8 +23,11 @@
 #include <ripple/shamap/SHAMapItem.h>
 #include <ripple/shamap/SHAMapNodeID.h>
 #include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/spinlock.h>
 #include <ripple/beast/utility/Journal.h>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -131,6 +134,9 @@ public:
     virtual uint256 const& key() const = 0;
     virtual void invariants(bool is_v2, bool is_root = false) const = 0;
 
+    /** Returns the bytes this node occupies, not counting its children. */
+    virtual std::size_t getMemoryUsage () const = 0;
+
     static std::shared_ptr<SHAMapAbstractNode>
         make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat format,
              SHAMapHash const& hash, bool hashValid, beast::Journal j,
@@ -147,14 +153,23 @@ class SHAMapInnerNodeV2;
 class SHAMapInnerNode
     : public SHAMapAbstractNode
 {
-    std::array<SHAMapHash, 16>          mHashes;
-    std::shared_ptr<SHAMapAbstractNode> mChildren[16];
-    int                             mIsBranch = 0;
-    std::uint32_t                   mFullBelowGen = 0;
+    // The fields used on every descent are kept together: the branch
+    // mask, which locates a branch's slot, then the locks, then the
+    // slots themselves.
+    std::uint16_t                   mIsBranch = 0;
+
+    // One lock bit per branch, guarding publication of children
+    mutable std::atomic<std::uint16_t> mChildLock {0};
+    std::atomic<std::uint32_t>      mFullBelowGen {0};
+
+    // Hashes, then children, of the populated branches only, in
+    // branch order and in a single allocation. The slot of branch m
+    // is the number of populated branches below m.
+    SHAMapHash*                     mHashes = nullptr;
 
-    static std::mutex               childLock;
 public:
     SHAMapInnerNode(std::uint32_t seq);
+    ~SHAMapInnerNode();
     std::shared_ptr<SHAMapAbstractNode> clone(std::uint32_t seq) const override;
 
     bool isEmpty () const;
@@ -179,6 +194,15 @@ public:
     std::string getString (SHAMapNodeID const&) const override;
     uint256 const& key() const override;
     void invariants(bool is_v2, bool is_root = false) const override;
+    std::size_t getMemoryUsage () const override;
+
+private:
+    static int branchCount (std::uint16_t isBranch);
+    int slot (int m) const;
+    std::shared_ptr<SHAMapAbstractNode>* children () const;
+    void setBranches (std::uint16_t isBranch);
+    void setHashes (std::array<SHAMapHash, 16> const& hashes);
+    void copyFrom (SHAMapInnerNode const& other);
 
     friend std::shared_ptr<SHAMapAbstractNode>
         SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq,
@@ -243,6 +267,7 @@ public:
     void addRaw (Serializer&, SHANodeFormat format) const override;
     uint256 const& key() const override;
     void invariants(bool is_v2, bool is_root = false) const override;
+    std::size_t getMemoryUsage () const override;
 
 public:  // public only to SHAMap
 
@@ -256,6 +281,14 @@ public:  // public only to SHAMap
 
     std::string getString (SHAMapNodeID const&) const override;
     bool updateHash () override;
+
+    /** Update the hashes of several leaves at once.
+
+        @param raw Receives the prefixed serialization of each
+                   leaf, which is what its hash covers.
+    */
+    static void updateHashes (SHAMapTreeNode* const* nodes,
+        std::size_t count, Serializer* raw);
 };
 
 // SHAMapAbstractNode
@@ -342,6 +375,32 @@ SHAMapInnerNode::SHAMapInnerNode(std::uint32_t seq)
 {
 }
 
+inline
+int
+SHAMapInnerNode::branchCount (std::uint16_t isBranch)
+{
+    unsigned x = isBranch;
+    x = x - ((x >> 1) & 0x5555);
+    x = (x & 0x3333) + ((x >> 2) & 0x3333);
+    x = (x + (x >> 4)) & 0x0F0F;
+    return (x + (x >> 8)) & 0x1F;
+}
+
+inline
+int
+SHAMapInnerNode::slot (int m) const
+{
+    return branchCount (mIsBranch & ((1u << m) - 1));
+}
+
+inline
+std::shared_ptr<SHAMapAbstractNode>*
+SHAMapInnerNode::children () const
+{
+    return reinterpret_cast<std::shared_ptr<SHAMapAbstractNode>*>(
+        mHashes + branchCount (mIsBranch));
+}
+
 inline
 bool
 SHAMapInnerNode::isEmptyBranch (int m) const
@@ -354,7 +413,10 @@ SHAMapHash const&
 SHAMapInnerNode::getChildHash (int m) const
 {
     assert ((m >= 0) && (m < 16) && (getType() == tnINNER));
-    return mHashes[m];
+    static SHAMapHash const empty;
+    if (isEmptyBranch (m))
+        return empty;
+    return mHashes[slot (m)];
 }
 
 inline
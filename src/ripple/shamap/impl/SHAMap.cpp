@@ -21,6 +21,10 @@
 #include <ripple/basics/contract.h>
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/beast/unit_test.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
 
 namespace ripple {
 
@@ -469,7 +473,8 @@ SHAMap::descend (SHAMapInnerNode * parent, SHAMapNodeID const& parentID,
 
 SHAMapAbstractNode*
 SHAMap::descendAsync (SHAMapInnerNode* parent, int branch,
-    SHAMapSyncFilter * filter, bool & pending) const
+    SHAMapSyncFilter * filter, bool & pending,
+    NodeStore::FetchPriority priority) const
 {
     pending = false;
 
@@ -488,7 +493,7 @@ SHAMap::descendAsync (SHAMapInnerNode* parent, int branch,
         if (!ptr && backed_)
         {
             std::shared_ptr<NodeObject> obj;
-            if (! f_.db().asyncFetch (hash.as_uint256(), obj))
+            if (! f_.db().asyncFetch (hash.as_uint256(), obj, priority))
             {
                 pending = true;
                 return nullptr;
@@ -1116,15 +1121,24 @@ SHAMap::writeNode (
 {
     // Node is ours, so we can just make it shareable
     assert (node->getSeq() == seq_);
+
+    Serializer s;
+    node->addRaw (s, snfPREFIX);
+    return writeNode (t, seq, std::move (node), std::move (s.modData ()));
+}
+
+// As above, when the caller already serialized the node
+std::shared_ptr<SHAMapAbstractNode>
+SHAMap::writeNode (NodeObjectType t, std::uint32_t seq,
+    std::shared_ptr<SHAMapAbstractNode> node, Blob&& raw) const
+{
+    assert (node->getSeq() == seq_);
     assert (backed_);
     node->setSeq (0);
 
     canonicalize (node->getNodeHash(), node);
 
-    Serializer s;
-    node->addRaw (s, snfPREFIX);
-    f_.db().store (t,
-        std::move (s.modData ()), node->getNodeHash ().as_uint256());
+    f_.db().store (t, std::move (raw), node->getNodeHash ().as_uint256());
     return node;
 }
 
@@ -1165,7 +1179,6 @@ int
 SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
 {
     int flushed = 0;
-    Serializer s;
 
     if (!root_ || (root_->getSeq() == 0))
         return flushed;
@@ -1192,12 +1205,38 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
         return 1;
     }
 
+    node = preFlushNode(std::move(node));
+
+    // Large changes flush the branches of the root in parallel, which
+    // leaves only the root and any leaves directly below it to do here
+    if (countModified (node) >= flushThreshold_)
+        flushed += flushRootBranches (node, doWrite, t, seq);
+
+    flushed += flushSubTree (node, doWrite, t, seq);
+
+    // Last inner node is the new root_
+    root_ = std::move (node);
+
+    return flushed;
+}
+
+// Flush the modified nodes below an inner node we own, then the node
+// itself, which may be replaced by its canonical copy.
+int
+SHAMap::flushSubTree (std::shared_ptr<SHAMapInnerNode>& top,
+    bool doWrite, NodeObjectType t, std::uint32_t seq)
+{
+    int flushed = 0;
+
     // Stack of {parent,index,child} pointers representing
     // inner nodes we are in the process of flushing
     using StackEntry = std::pair <std::shared_ptr<SHAMapInnerNode>, int>;
     std::stack <StackEntry, std::vector<StackEntry>> stack;
 
-    node = preFlushNode(std::move(node));
+    // Hash the leaves together, leaving only inner nodes to walk
+    flushed += flushLeaves (top, doWrite, t, seq);
+
+    auto node = std::move (top);
 
     int pos = 0;
 
@@ -1279,8 +1318,158 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
         ++pos;
     }
 
-    // Last inner node is the new root_
-    root_ = std::move (node);
+    top = std::move (node);
+
+    return flushed;
+}
+
+// Hash the modified leaves below an inner node we own in batches, then
+// write and share them. The inner nodes on the way are made ours and
+// hooked to their parents, for flushSubTree to hash once the leaves are.
+int
+SHAMap::flushLeaves (std::shared_ptr<SHAMapInnerNode> const& top,
+    bool doWrite, NodeObjectType t, std::uint32_t seq)
+{
+    struct Leaf
+    {
+        SHAMapInnerNode* parent;
+        int branch;
+        std::shared_ptr<SHAMapTreeNode> node;
+    };
+
+    std::vector<Leaf> leaves;
+    std::vector<SHAMapInnerNode*> stack { top.get () };
+
+    while (! stack.empty ())
+    {
+        auto const node = stack.back ();
+        stack.pop_back ();
+
+        for (int branch = 0; branch < 16; ++branch)
+        {
+            if (node->isEmptyBranch (branch))
+                continue;
+
+            auto child = node->getChild (branch);
+            if (!child || (child->getSeq() == 0))
+                continue;
+
+            child = preFlushNode (std::move (child));
+
+            if (child->isInner ())
+            {
+                node->shareChild (branch, child);
+                stack.push_back (
+                    static_cast<SHAMapInnerNode*>(child.get ()));
+            }
+            else
+            {
+                leaves.push_back ({ node, branch,
+                    std::static_pointer_cast<SHAMapTreeNode>(
+                        std::move (child)) });
+            }
+        }
+    }
+
+    std::vector<SHAMapTreeNode*> nodes;
+    nodes.reserve (leaves.size ());
+    for (auto const& leaf : leaves)
+        nodes.push_back (leaf.node.get ());
+
+    std::vector<Serializer> raw (leaves.size ());
+    SHAMapTreeNode::updateHashes (nodes.data (), nodes.size (), raw.data ());
+
+    for (std::size_t i = 0; i < leaves.size (); ++i)
+    {
+        auto& leaf = leaves[i];
+        assert (leaf.parent->getSeq() == seq_);
+
+        std::shared_ptr<SHAMapAbstractNode> node = std::move (leaf.node);
+        if (doWrite && backed_)
+            node = writeNode (t, seq, std::move (node),
+                std::move (raw[i].modData ()));
+        else
+            node->setSeq (0);
+
+        leaf.parent->shareChild (leaf.branch, node);
+    }
+
+    return static_cast<int>(leaves.size ());
+}
+
+// Count the modified nodes two levels below the root, a cheap
+// estimate of how much work flushing the map will take.
+int
+SHAMap::countModified (std::shared_ptr<SHAMapInnerNode> const& root) const
+{
+    int count = 0;
+
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (root->isEmptyBranch (branch))
+            continue;
+
+        auto const child = root->getChild (branch);
+        if (!child || (child->getSeq() == 0) || !child->isInner ())
+            continue;
+
+        auto const inner = static_cast<SHAMapInnerNode*>(child.get());
+        for (int i = 0; i < 16; ++i)
+        {
+            if (inner->isEmptyBranch (i))
+                continue;
+
+            auto const grandchild = inner->getChildPointer (i);
+            if (grandchild && (grandchild->getSeq() != 0))
+                ++count;
+        }
+    }
+
+    return count;
+}
+
+// Flush the modified inner nodes directly below the root, spread over
+// the family's threads. The branches share no nodes, and the caches
+// and store they write to are thread safe.
+int
+SHAMap::flushRootBranches (std::shared_ptr<SHAMapInnerNode> const& root,
+    bool doWrite, NodeObjectType t, std::uint32_t seq)
+{
+    assert (root->getSeq() == seq_);
+
+    std::array <std::shared_ptr<SHAMapInnerNode>, 16> branches;
+    std::array <int, 16> modified;
+    int work = 0;
+
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (root->isEmptyBranch (branch))
+            continue;
+
+        auto child = root->getChild (branch);
+        if (child && (child->getSeq() != 0) && child->isInner ())
+        {
+            branches[branch] = std::static_pointer_cast<SHAMapInnerNode>(
+                preFlushNode (std::move (child)));
+            modified[work++] = branch;
+        }
+    }
+
+    std::atomic <int> flushed (0);
+    f_.parallelFor (work,
+        std::min <int> (std::thread::hardware_concurrency (), work),
+        [&](std::size_t i)
+        {
+            flushed += flushSubTree (
+                branches[modified[i]], doWrite, t, seq);
+        });
+
+    // The flushed branches can now be shared
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (branches[branch])
+            root->shareChild (branch, branches[branch]);
+    }
 
     return flushed;
 }
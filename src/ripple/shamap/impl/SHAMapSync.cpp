@@ -106,7 +106,8 @@ void SHAMap::visitNodes(std::function<bool (SHAMapAbstractNode&)> const& functio
     nodes that are not permanently stored locally
 */
 std::vector<std::pair<SHAMapNodeID, uint256>>
-SHAMap::getMissingNodes(std::size_t max, SHAMapSyncFilter* filter)
+SHAMap::getMissingNodes(std::size_t max, SHAMapSyncFilter* filter,
+    NodeStore::FetchPriority priority)
 {
     assert (root_->isValid ());
     assert (root_->getNodeHash().isNonZero ());
@@ -177,7 +178,7 @@ SHAMap::getMissingNodes(std::size_t max, SHAMapSyncFilter* filter)
                     {
                         SHAMapNodeID childID = nodeID.getChildNodeID (branch);
                         bool pending = false;
-                        auto d = descendAsync (node, branch, filter, pending);
+                        auto d = descendAsync (node, branch, filter, pending, priority);
 
                         if (!d)
                         {
@@ -551,6 +552,26 @@ SHAMap::addKnownNode (const SHAMapNodeID& node, Slice const& rawNode,
     return SHAMapAddNode::duplicate ();
 }
 
+std::vector<std::vector<std::pair<SHAMapNodeID, uint256>>>
+SHAMap::splitMissingNodes (
+    std::vector<std::pair<SHAMapNodeID, uint256>> const& nodes,
+    std::size_t parts)
+{
+    assert (parts != 0);
+    std::vector<std::vector<std::pair<SHAMapNodeID, uint256>>> ret (parts);
+
+    for (auto const& node : nodes)
+    {
+        // The branch of the root is the first nibble of the path
+        int branch = 0;
+        if (!node.first.isRoot ())
+            branch = SHAMapNodeID ().selectBranch (node.first.getNodeID ());
+        ret[branch % parts].push_back (node);
+    }
+
+    return ret;
+}
+
 bool SHAMap::deepCompare (SHAMap& other) const
 {
     // Intended for debug/test only
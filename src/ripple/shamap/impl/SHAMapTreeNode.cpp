@@ -26,30 +26,122 @@
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <ripple/beast/core/LexicalCast.h>
+#include <algorithm>
 #include <mutex>
+#include <new>
+#include <vector>
 
 #include <openssl/sha.h>
 
 namespace ripple {
 
-std::mutex SHAMapInnerNode::childLock;
-
 SHAMapAbstractNode::~SHAMapAbstractNode() = default;
 
+// The storage for one populated branch
+static std::size_t constexpr branchBytes =
+    sizeof(SHAMapHash) + sizeof(std::shared_ptr<SHAMapAbstractNode>);
+
+SHAMapInnerNode::~SHAMapInnerNode()
+{
+    setBranches (0);
+}
+
+// Reallocate the slots for a new set of populated branches, keeping
+// the hashes and children of branches in both the old and new sets.
+// Only called while the node is not shared.
+void
+SHAMapInnerNode::setBranches (std::uint16_t isBranch)
+{
+    if (isBranch == mIsBranch)
+        return;
+
+    auto const oldCount = branchCount (mIsBranch);
+    auto const newCount = branchCount (isBranch);
+    auto const oldChildren = children ();
+
+    SHAMapHash* hashes = nullptr;
+    if (newCount != 0)
+    {
+        hashes = static_cast<SHAMapHash*>(
+            ::operator new (newCount * branchBytes));
+        auto const newChildren = reinterpret_cast<
+            std::shared_ptr<SHAMapAbstractNode>*>(hashes + newCount);
+
+        for (int m = 0, from = 0, to = 0; m < 16; ++m)
+        {
+            bool const had = (mIsBranch & (1 << m)) != 0;
+            if (isBranch & (1 << m))
+            {
+                if (had)
+                {
+                    new (&hashes[to]) SHAMapHash (mHashes[from]);
+                    new (&newChildren[to]) std::shared_ptr<
+                        SHAMapAbstractNode> (std::move (oldChildren[from]));
+                }
+                else
+                {
+                    new (&hashes[to]) SHAMapHash ();
+                    new (&newChildren[to]) std::shared_ptr<
+                        SHAMapAbstractNode> ();
+                }
+                ++to;
+            }
+            if (had)
+                ++from;
+        }
+    }
+
+    if (oldCount != 0)
+    {
+        for (int i = 0; i < oldCount; ++i)
+            oldChildren[i].~shared_ptr();
+        ::operator delete (mHashes);
+    }
+
+    mHashes = hashes;
+    mIsBranch = isBranch;
+}
+
+// Populate the branches with non-zero hashes
+void
+SHAMapInnerNode::setHashes (std::array<SHAMapHash, 16> const& hashes)
+{
+    std::uint16_t isBranch = 0;
+    for (int m = 0; m < 16; ++m)
+    {
+        if (hashes[m].isNonZero ())
+            isBranch |= (1 << m);
+    }
+    setBranches (isBranch);
+    for (int m = 0, i = 0; m < 16; ++m)
+    {
+        if (isBranch & (1 << m))
+            mHashes[i++] = hashes[m];
+    }
+}
+
+void
+SHAMapInnerNode::copyFrom (SHAMapInnerNode const& other)
+{
+    mHash = other.mHash;
+    mFullBelowGen = other.mFullBelowGen.load ();
+    setBranches (other.mIsBranch);
+    auto const count = branchCount (mIsBranch);
+    std::copy (other.mHashes, other.mHashes + count, mHashes);
+    spinlock<std::uint16_t> sl (other.mChildLock);
+    std::lock_guard <spinlock<std::uint16_t>> lock (sl);
+    std::copy (other.children (), other.children () + count, children ());
+}
+
 std::shared_ptr<SHAMapAbstractNode>
 SHAMapInnerNode::clone(std::uint32_t seq) const
 {
     auto p = std::make_shared<SHAMapInnerNode>(seq);
-    p->mHash = mHash;
-    p->mIsBranch = mIsBranch;
-    p->mFullBelowGen = mFullBelowGen;
-    p->mHashes = mHashes;
-    std::lock_guard <std::mutex> lock(childLock);
-    for (int i = 0; i < 16; ++i)
-    {
-        p->mChildren[i] = mChildren[i];
-        assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(p->mChildren[i]) == nullptr);
-    }
+    p->copyFrom (*this);
+#ifndef NDEBUG
+    for (int i = 0; i < branchCount (mIsBranch); ++i)
+        assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(p->children()[i]) == nullptr);
+#endif
     return std::move(p);
 }
 
@@ -57,20 +149,18 @@ std::shared_ptr<SHAMapAbstractNode>
 SHAMapInnerNodeV2::clone(std::uint32_t seq) const
 {
     auto p = std::make_shared<SHAMapInnerNodeV2>(seq);
-    p->mHash = mHash;
-    p->mIsBranch = mIsBranch;
-    p->mFullBelowGen = mFullBelowGen;
-    p->mHashes = mHashes;
+    p->copyFrom (*this);
     p->common_ = common_;
     p->depth_ = depth_;
-    std::lock_guard <std::mutex> lock(childLock);
-    for (int i = 0; i < 16; ++i)
+#ifndef NDEBUG
+    for (int i = 0; i < branchCount (mIsBranch); ++i)
     {
-        p->mChildren[i] = mChildren[i];
-        if (p->mChildren[i] != nullptr)
-            assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(p->mChildren[i]) != nullptr ||
-                   std::dynamic_pointer_cast<SHAMapTreeNode>(p->mChildren[i]) != nullptr);
+        auto const& child = p->children()[i];
+        if (child != nullptr)
+            assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(child) != nullptr ||
+                   std::dynamic_pointer_cast<SHAMapTreeNode>(child) != nullptr);
     }
+#endif
     return std::move(p);
 }
 
@@ -148,13 +238,10 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
                 Throw<std::runtime_error> ("invalid FI node");
 
             auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i].as_uint256(), i * 32);
-
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+                s.get256 (hashes[i].as_uint256(), i * 32);
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -165,6 +252,7 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
         {
             auto ret = std::make_shared<SHAMapInnerNode>(seq);
             // compressed inner
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < (len / 33); ++i)
             {
                 int pos;
@@ -172,10 +260,9 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
                     Throw<std::runtime_error> ("short CI node");
                 if ((pos < 0) || (pos >= 16))
                     Throw<std::runtime_error> ("invalid CI node");
-                s.get256 (ret->mHashes[pos].as_uint256(), i * 33);
-                if (ret->mHashes[pos].isNonZero ())
-                    ret->mIsBranch |= (1 << pos);
+                s.get256 (hashes[pos].as_uint256(), i * 33);
             }
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -207,13 +294,10 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
                 Throw<std::runtime_error> ("invalid FI node");
 
             auto ret = std::make_shared<SHAMapInnerNodeV2>(seq);
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i].as_uint256(), i * 32);
-
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+                s.get256 (hashes[i].as_uint256(), i * 32);
+            ret->setHashes (hashes);
             ret->set_common(id.getDepth(), id.getNodeID());
             if (hashValid)
                 ret->mHash = hash;
@@ -225,6 +309,7 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
         {
             auto ret = std::make_shared<SHAMapInnerNodeV2>(seq);
             // compressed v2 inner
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < (len / 33); ++i)
             {
                 int pos;
@@ -232,10 +317,9 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
                     Throw<std::runtime_error> ("short CI node");
                 if ((pos < 0) || (pos >= 16))
                     Throw<std::runtime_error> ("invalid CI node");
-                s.get256 (ret->mHashes[pos].as_uint256(), i * 33);
-                if (ret->mHashes[pos].isNonZero ())
-                    ret->mIsBranch |= (1 << pos);
+                s.get256 (hashes[pos].as_uint256(), i * 33);
             }
+            ret->setHashes (hashes);
             ret->set_common(id.getDepth(), id.getNodeID());
             if (hashValid)
                 ret->mHash = hash;
@@ -305,13 +389,10 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
             else
                 ret = std::make_shared<SHAMapInnerNode>(seq);
 
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i].as_uint256(), i * 32);
-
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+                s.get256 (hashes[i].as_uint256(), i * 32);
+            ret->setHashes (hashes);
 
             if (isV2)
             {
@@ -368,8 +449,8 @@ SHAMapInnerNode::updateHash()
         sha512_half_hasher h;
         using beast::hash_append;
         hash_append(h, HashPrefix::innerNode);
-        for(auto const& hh : mHashes)
-            hash_append(h, hh);
+        for (int m = 0; m < 16; ++m)
+            hash_append(h, getChildHash(m));
         nh = static_cast<typename
             sha512_half_hasher::result_type>(h);
     }
@@ -382,10 +463,12 @@ SHAMapInnerNode::updateHash()
 void
 SHAMapInnerNode::updateHashDeep()
 {
-    for (auto pos = 0; pos < 16; ++pos)
+    auto const count = branchCount (mIsBranch);
+    auto const children = this->children ();
+    for (auto i = 0; i < count; ++i)
     {
-        if (mChildren[pos] != nullptr)
-            mHashes[pos] = mChildren[pos]->getNodeHash();
+        if (children[i] != nullptr)
+            mHashes[i] = children[i]->getNodeHash();
     }
     updateHash();
 }
@@ -441,18 +524,18 @@ SHAMapInnerNode::addRaw(Serializer& s, SHANodeFormat format) const
         {
             s.add32 (HashPrefix::innerNode);
 
-            for (auto const& hh : mHashes)
-                s.add256 (hh.as_uint256());
+            for (int i = 0; i < 16; ++i)
+                s.add256 (getChildHash(i).as_uint256());
         }
         else  // format == snfWIRE
         {
             if (getBranchCount () < 12)
             {
                 // compressed node
-                for (int i = 0; i < mHashes.size(); ++i)
+                for (int i = 0; i < 16; ++i)
                     if (!isEmptyBranch (i))
                     {
-                        s.add256 (mHashes[i].as_uint256());
+                        s.add256 (getChildHash(i).as_uint256());
                         s.add8 (i);
                     }
 
@@ -460,8 +543,8 @@ SHAMapInnerNode::addRaw(Serializer& s, SHANodeFormat format) const
             }
             else
             {
-                for (auto const& hh : mHashes)
-                    s.add256 (hh.as_uint256());
+                for (int i = 0; i < 16; ++i)
+                    s.add256 (getChildHash(i).as_uint256());
 
                 s.add8 (2);
             }
@@ -479,7 +562,7 @@ SHAMapInnerNodeV2::addRaw(Serializer& s, SHANodeFormat format) const
         s.add32 (HashPrefix::innerNodeV2);
 
         for (int i = 0 ; i < 16; ++i)
-            s.add256 (mHashes[i].as_uint256());
+            s.add256 (getChildHash(i).as_uint256());
 
         s.add8(depth_);
 
@@ -516,6 +599,25 @@ SHAMapInnerNodeV2::updateHash()
     return true;
 }
 
+void
+SHAMapTreeNode::updateHashes (SHAMapTreeNode* const* nodes,
+    std::size_t count, Serializer* raw)
+{
+    std::vector<Slice> messages;
+    messages.reserve (count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        nodes[i]->addRaw (raw[i], snfPREFIX);
+        messages.push_back (raw[i].slice ());
+    }
+
+    std::vector<uint256> digests (count);
+    sha512HalfBatch (messages.data (), count, digests.data ());
+
+    for (std::size_t i = 0; i < count; ++i)
+        nodes[i]->mHash = SHAMapHash{digests[i]};
+}
+
 void
 SHAMapTreeNode::addRaw(Serializer& s, SHANodeFormat format) const
 {
@@ -592,13 +694,20 @@ bool SHAMapInnerNode::isEmpty () const
 int SHAMapInnerNode::getBranchCount () const
 {
     assert (isInner ());
-    int count = 0;
+    return branchCount (mIsBranch);
+}
 
-    for (int i = 0; i < 16; ++i)
-        if (!isEmptyBranch (i))
-            ++count;
+std::size_t
+SHAMapInnerNode::getMemoryUsage () const
+{
+    return sizeof(*this) + branchCount (mIsBranch) * branchBytes;
+}
 
-    return count;
+std::size_t
+SHAMapTreeNode::getMemoryUsage () const
+{
+    // The item is normally only referenced by this node
+    return sizeof(*this) + sizeof(SHAMapItem) + mItem->size();
 }
 
 #ifdef BEAST_DEBUG
@@ -627,14 +736,14 @@ std::string
 SHAMapInnerNode::getString(const SHAMapNodeID & id) const
 {
     std::string ret = SHAMapAbstractNode::getString(id);
-    for (int i = 0; i < mHashes.size(); ++i)
+    for (int i = 0; i < 16; ++i)
     {
         if (!isEmptyBranch (i))
         {
             ret += "\nb";
             ret += beast::lexicalCastThrow <std::string> (i);
             ret += " = ";
-            ret += to_string (mHashes[i]);
+            ret += to_string (getChildHash (i));
         }
     }
     return ret;
@@ -670,13 +779,18 @@ SHAMapInnerNode::setChild(int m, std::shared_ptr<SHAMapAbstractNode> const& chil
     assert (mType == tnINNER);
     assert (mSeq != 0);
     assert (child.get() != this);
-    mHashes[m].zero();
     mHash.zero();
     if (child)
-        mIsBranch |= (1 << m);
+    {
+        setBranches (mIsBranch | (1 << m));
+        auto const i = slot (m);
+        mHashes[i].zero();
+        children()[i] = child;
+    }
     else
-        mIsBranch &= ~ (1 << m);
-    mChildren[m] = child;
+    {
+        setBranches (mIsBranch & ~(1 << m));
+    }
 }
 
 // finished modifying, now make shareable
@@ -687,8 +801,9 @@ void SHAMapInnerNode::shareChild (int m, std::shared_ptr<SHAMapAbstractNode> con
     assert (mSeq != 0);
     assert (child);
     assert (child.get() != this);
+    assert (!isEmptyBranch (m));
 
-    mChildren[m] = child;
+    children()[slot (m)] = child;
 }
 
 SHAMapAbstractNode*
@@ -697,8 +812,12 @@ SHAMapInnerNode::getChildPointer (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInner());
 
-    std::lock_guard <std::mutex> lock (childLock);
-    return mChildren[branch].get ();
+    if (isEmptyBranch (branch))
+        return nullptr;
+
+    packed_spinlock<std::uint16_t> sl (mChildLock, branch);
+    std::lock_guard <packed_spinlock<std::uint16_t>> lock (sl);
+    return children()[slot (branch)].get ();
 }
 
 std::shared_ptr<SHAMapAbstractNode>
@@ -707,8 +826,12 @@ SHAMapInnerNode::getChild (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInner());
 
-    std::lock_guard <std::mutex> lock (childLock);
-    return mChildren[branch];
+    if (isEmptyBranch (branch))
+        return {};
+
+    packed_spinlock<std::uint16_t> sl (mChildLock, branch);
+    std::lock_guard <packed_spinlock<std::uint16_t>> lock (sl);
+    return children()[slot (branch)];
 }
 
 std::shared_ptr<SHAMapAbstractNode>
@@ -717,20 +840,23 @@ SHAMapInnerNode::canonicalizeChild(int branch, std::shared_ptr<SHAMapAbstractNod
     assert (branch >= 0 && branch < 16);
     assert (isInner());
     assert (node);
-    assert (node->getNodeHash() == mHashes[branch]);
+    assert (!isEmptyBranch (branch));
+    assert (node->getNodeHash() == getChildHash (branch));
 
-    std::lock_guard <std::mutex> lock (childLock);
-    if (mChildren[branch])
+    auto& child = children()[slot (branch)];
+    packed_spinlock<std::uint16_t> sl (mChildLock, branch);
+    std::lock_guard <packed_spinlock<std::uint16_t>> lock (sl);
+    if (child)
     {
         // There is already a node hooked up, return it
-        node = mChildren[branch];
+        node = child;
     }
     else
     {
         // Hook this node up
         // node must not be a v2 inner node
         assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(node) == nullptr);
-        mChildren[branch] = node;
+        child = node;
     }
     return node;
 }
@@ -741,13 +867,16 @@ SHAMapInnerNodeV2::canonicalizeChild(int branch, std::shared_ptr<SHAMapAbstractN
     assert (branch >= 0 && branch < 16);
     assert (isInner());
     assert (node);
-    assert (node->getNodeHash() == mHashes[branch]);
+    assert (!isEmptyBranch (branch));
+    assert (node->getNodeHash() == getChildHash (branch));
 
-    std::lock_guard <std::mutex> lock (childLock);
-    if (mChildren[branch])
+    auto& child = children()[slot (branch)];
+    packed_spinlock<std::uint16_t> sl (mChildLock, branch);
+    std::lock_guard <packed_spinlock<std::uint16_t>> lock (sl);
+    if (child)
     {
         // There is already a node hooked up, return it
-        node = mChildren[branch];
+        node = child;
     }
     else
     {
@@ -755,7 +884,7 @@ SHAMapInnerNodeV2::canonicalizeChild(int branch, std::shared_ptr<SHAMapAbstractN
         // node must not be a v1 inner node
         assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(node) != nullptr ||
                std::dynamic_pointer_cast<SHAMapTreeNode>(node)    != nullptr);
-        mChildren[branch] = node;
+        child = node;
     }
     return node;
 }
@@ -827,10 +956,9 @@ SHAMapInnerNodeV2::setChildren(std::shared_ptr<SHAMapTreeNode> const& child1,
         b2 = *k2 >> 4;
         depth_ = 2*depth_;
     }
-    mChildren[b1] = child1;
-    mIsBranch |= 1 << b1;
-    mChildren[b2] = child2;
-    mIsBranch |= 1 << b2;
+    setBranches (mIsBranch | (1 << b1) | (1 << b2));
+    children()[slot (b1)] = child1;
+    children()[slot (b2)] = child2;
 }
 
 void
@@ -868,11 +996,12 @@ SHAMapInnerNode::invariants(bool is_v2, bool is_root) const
     unsigned count = 0;
     for (int i = 0; i < 16; ++i)
     {
-        if (mHashes[i].isNonZero())
+        if (getChildHash(i).isNonZero())
         {
             assert((mIsBranch & (1 << i)) != 0);
-            if (mChildren[i] != nullptr)
-                mChildren[i]->invariants(is_v2);
+            auto const& child = children()[slot(i)];
+            if (child != nullptr)
+                child->invariants(is_v2);
             ++count;
         }
         else
@@ -896,21 +1025,22 @@ SHAMapInnerNodeV2::invariants(bool is_v2, bool is_root) const
     unsigned count = 0;
     for (int i = 0; i < 16; ++i)
     {
-        if (mHashes[i].isNonZero())
+        if (getChildHash(i).isNonZero())
         {
             assert((mIsBranch & (1 << i)) != 0);
-            if (mChildren[i] != nullptr)
+            auto const& child = children()[slot(i)];
+            if (child != nullptr)
             {
-                assert(mHashes[i] == mChildren[i]->getNodeHash());
+                assert(getChildHash(i) == child->getNodeHash());
 #ifndef NDEBUG
-                auto const& childID = mChildren[i]->key();
+                auto const& childID = child->key();
 
                 // Make sure this child it attached to the correct branch
                 SHAMapNodeID nodeID {depth(), common()};
                 assert (i == nodeID.selectBranch(childID));
 #endif
                 assert(has_common_prefix(childID));
-                mChildren[i]->invariants(is_v2);
+                child->invariants(is_v2);
             }
             ++count;
         }
@@ -32,6 +32,12 @@
 #include <ripple/nodestore/Manager.h>
 #include <ripple/beast/utility/Journal.h>
 #include <ripple/beast/clock/manual_clock.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace ripple {
 namespace tests {
@@ -118,6 +124,46 @@ public:
     {
         Throw<std::runtime_error> ("missing node");
     }
+
+    // Each thread claims the next index until none are left
+    void
+    parallelFor (std::size_t count, int jobs,
+        std::function <void(std::size_t)> const& f) override
+    {
+        std::atomic <std::size_t> next (0);
+        std::exception_ptr error;
+        std::mutex mutex;
+
+        auto const run = [&]
+        {
+            for (std::size_t i; (i = next++) < count;)
+            {
+                try
+                {
+                    f (i);
+                }
+                catch (...)
+                {
+                    std::lock_guard <std::mutex> lock (mutex);
+                    if (! error)
+                        error = std::current_exception ();
+                    next = count;
+                }
+            }
+        };
+
+        std::vector <std::thread> threads;
+        auto const helpers = std::min <std::size_t> (
+            std::max (jobs, 1) - 1, count);
+        for (std::size_t i = 0; i < helpers; ++i)
+            threads.emplace_back (run);
+        run ();
+        for (auto& thread : threads)
+            thread.join ();
+
+        if (error)
+            std::rethrow_exception (error);
+    }
 };
 
 } // tests
@@ -20,6 +20,7 @@
 #include <BeastConfig.h>
 
 #include <ripple/basics/impl/BasicConfig.cpp>
+#include <ripple/basics/impl/CacheBudget.cpp>
 #include <ripple/basics/impl/CheckLibraryVersions.cpp>
 #include <ripple/basics/impl/contract.cpp>
 #include <ripple/basics/impl/CountedObject.cpp>
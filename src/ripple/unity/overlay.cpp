@@ -28,6 +28,7 @@
 #include <ripple/overlay/impl/PeerSet.cpp>
 #include <ripple/overlay/impl/TMHello.cpp>
 #include <ripple/overlay/impl/TrafficCount.cpp>
+#include <ripple/overlay/impl/TxVerifier.cpp>
 
 #if DOXYGEN
 #include <ripple/overlay/README.md>
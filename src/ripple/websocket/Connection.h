@@ -85,6 +85,8 @@ public:
     }
 
     void send (Json::Value const& jvObj, bool broadcast);
+    void send (std::shared_ptr<Message const> const& message,
+        bool broadcast);
 
     void disconnect ();
     static void handle_disconnect(weak_connection_ptr c);
@@ -362,6 +364,15 @@ void ConnectionImpl <WebSocket>::send (Json::Value const& jvObj, bool broadcast)
         m_handler.send (ptr, jvObj, broadcast);
 }
 
+template <class WebSocket>
+void ConnectionImpl <WebSocket>::send (
+    std::shared_ptr<Message const> const& message, bool broadcast)
+{
+    connection_ptr ptr = m_connection.lock ();
+    if (ptr)
+        m_handler.send (ptr, *message->text (), broadcast);
+}
+
 template <class WebSocket>
 void ConnectionImpl <WebSocket>::disconnect ()
 {
@@ -250,6 +250,42 @@ struct AccountTxPaging_test : beast::unit_test::suite
 
         BEAST_EXPECT(! token["ledger"]);
         BEAST_EXPECT(! token["seq"]);
+
+        {
+            // A marker need not name a stored transaction, as when the
+            // one it named has since been deleted: paging resumes from
+            // the marker's position.
+            limit = 2;
+
+            token = Json::objectValue;
+            token["ledger"] = 5;
+            token["seq"] = 5;
+            BEAST_EXPECT(next(limit, forward, token, min_ledger, max_ledger) == 2);
+            checkTransaction (txs_[0], 5, 7);
+            checkTransaction (txs_[1], 6, 1);
+            checkToken (token, 6, 5);
+
+            token = Json::objectValue;
+            token["ledger"] = 5;
+            token["seq"] = 5;
+            BEAST_EXPECT(next(limit, ! forward, token, min_ledger, max_ledger) == 2);
+            checkTransaction (txs_[0], 5, 4);
+            checkTransaction (txs_[1], 4, 10);
+            checkToken (token, 4, 4);
+        }
+
+        {
+            // Without a marker, a backward page starts with the last
+            // transaction of the newest ledger in the range.
+            limit = 2;
+            max_ledger = 6;
+
+            token = Json::nullValue;
+            BEAST_EXPECT(next(limit, ! forward, token, min_ledger, max_ledger) == 2);
+            checkTransaction (txs_[0], 6, 11);
+            checkTransaction (txs_[1], 6, 10);
+            checkToken (token, 6, 9);
+        }
     }
 };
 
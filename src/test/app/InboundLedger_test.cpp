@@ -0,0 +1,254 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/ledger/InboundLedger.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/overlay/Peer.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/shamap/tests/common.h>
+#include <ripple/test/jtx.h>
+#include <ripple/beast/unit_test.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Acquires a ledger's state from several peers at once.
+
+    Replies to the parts of each request are queued with gotData and
+    processed by as many concurrent runData calls as gotData asks
+    for, the way InboundLedgers dispatches jtLEDGER_DATA jobs.
+*/
+class InboundLedger_test : public beast::unit_test::suite
+{
+    // A peer that only needs to exist for its replies to be used,
+    // and which counts the requests sent to it
+    class TestPeer : public Peer
+    {
+        id_t id_;
+        PublicKey nodePublic_;
+        uint256 closedLedger_;
+        std::atomic<int> sent_ {0};
+
+    public:
+        explicit
+        TestPeer (id_t id)
+            : id_ (id)
+        {
+        }
+
+        int sent () const { return sent_; }
+
+        void send (Message::pointer const&) override { ++sent_; }
+        beast::IP::Endpoint getRemoteAddress() const override { return {}; }
+        void charge (Resource::Charge const&) override { }
+        id_t id() const override { return id_; }
+        bool cluster() const override { return false; }
+        bool isHighLatency() const override { return false; }
+        int getScore (bool) const override { return 0; }
+        PublicKey const& getNodePublic() const override { return nodePublic_; }
+        Json::Value json() override { return {}; }
+        uint256 const& getClosedLedgerHash () const override
+            { return closedLedger_; }
+        bool hasLedger (uint256 const&, std::uint32_t) const override
+            { return true; }
+        void ledgerRange (std::uint32_t& minSeq,
+            std::uint32_t& maxSeq) const override
+            { minSeq = maxSeq = 0; }
+        bool hasTxSet (uint256 const&) const override { return false; }
+        void cycleStatus () override { }
+        bool supportsVersion (int) override { return false; }
+        bool hasRange (std::uint32_t, std::uint32_t) override
+            { return false; }
+    };
+
+    // The reply to a request for the ledger's base data
+    static
+    std::shared_ptr<protocol::TMLedgerData>
+    makeBase (Ledger const& ledger)
+    {
+        auto packet = std::make_shared<protocol::TMLedgerData>();
+        packet->set_ledgerhash (
+            ledger.info().hash.begin (), ledger.info().hash.size ());
+        packet->set_ledgerseq (ledger.info().seq);
+        packet->set_type (protocol::liBASE);
+
+        Serializer header (128);
+        addRaw (ledger.info(), header);
+        packet->add_nodes ()->set_nodedata (
+            header.getDataPtr (), header.getLength ());
+
+        Serializer root (768);
+        ledger.stateMap().getRootNode (root, snfWIRE);
+        packet->add_nodes ()->set_nodedata (
+            root.getDataPtr (), root.getLength ());
+        return packet;
+    }
+
+    // The reply to a request for some of the ledger's state nodes
+    static
+    std::shared_ptr<protocol::TMLedgerData>
+    makeState (Ledger const& ledger,
+        std::vector<std::pair<SHAMapNodeID, uint256>> const& nodes)
+    {
+        auto packet = std::make_shared<protocol::TMLedgerData>();
+        packet->set_ledgerhash (
+            ledger.info().hash.begin (), ledger.info().hash.size ());
+        packet->set_ledgerseq (ledger.info().seq);
+        packet->set_type (protocol::liAS_NODE);
+
+        for (auto const& node : nodes)
+        {
+            std::vector<SHAMapNodeID> ids;
+            std::vector<Blob> data;
+            ledger.stateMap().getNodeFat (node.first, ids, data, true, 1);
+            for (std::size_t i = 0; i < ids.size (); ++i)
+            {
+                auto n = packet->add_nodes ();
+                n->set_nodeid (ids[i].getRawString ());
+                n->set_nodedata (data[i].data (), data[i].size ());
+            }
+        }
+        return packet;
+    }
+
+public:
+    void
+    testParallelData ()
+    {
+        testcase ("parallel data");
+
+        using namespace jtx;
+        Env env (*this);
+
+        // The ledger lives in a family of its own, so the
+        // application can't find any of its nodes locally.
+        tests::TestFamily family (env.app().journal ("SHAMap"));
+        auto const genesis = std::make_shared<Ledger> (
+            create_genesis, env.app().config(), family);
+        auto const source = std::make_shared<Ledger> (
+            *genesis, env.app().timeKeeper().closeTime());
+        for (int i = 1; i <= 2000; ++i)
+        {
+            AccountID const id (i);
+            auto sle = std::make_shared<SLE> (keylet::account (id));
+            sle->setAccountID (sfAccount, id);
+            sle->setFieldAmount (sfBalance, XRP (1000));
+            sle->setFieldU32 (sfSequence, 1);
+            source->rawInsert (sle);
+        }
+        source->setImmutable (env.app().config());
+
+        auto const inbound = std::make_shared<InboundLedger> (env.app(),
+            source->info().hash, source->info().seq,
+            InboundLedger::fcHISTORY, stopwatch());
+
+        std::vector<std::shared_ptr<TestPeer>> peers;
+        for (Peer::id_t id = 1; id <= 6; ++id)
+            peers.push_back (std::make_shared<TestPeer> (id));
+
+        auto runJobs = [&inbound](int jobs)
+        {
+            std::vector<std::thread> threads;
+            for (int i = 0; i < jobs; ++i)
+                threads.emplace_back ([&inbound] { inbound->runData (); });
+            for (auto& t : threads)
+                t.join ();
+        };
+
+        // One job picks up the base data
+        BEAST_EXPECT(inbound->gotData (peers[0], makeBase (*source)));
+        runJobs (1);
+        BEAST_EXPECT(inbound->getLedger ());
+        if (! inbound->getLedger ())
+            return;
+
+        auto& dest = inbound->getLedger ()->stateMap ();
+        int rounds = 0;
+        int mostJobs = 0;
+        while (rounds < 100)
+        {
+            auto const missing = dest.getMissingNodes (256, nullptr);
+            if (missing.empty ())
+                break;
+            ++rounds;
+
+            // Each part of the request goes to its own peer. While
+            // nothing runs, every reply up to the limit of four
+            // brings in a job of its own.
+            auto const groups = SHAMap::splitMissingNodes (
+                missing, peers.size ());
+            int replies = 0;
+            int jobs = 0;
+            for (std::size_t i = 0; i < groups.size (); ++i)
+            {
+                if (groups[i].empty ())
+                    continue;
+                ++replies;
+                if (inbound->gotData (peers[i],
+                        makeState (*source, groups[i])))
+                    ++jobs;
+            }
+            BEAST_EXPECT(jobs == std::min (replies, 4));
+            mostJobs = std::max (mostJobs, jobs);
+
+            std::vector<int> sent;
+            for (auto const& peer : peers)
+                sent.push_back (peer->sent ());
+
+            runJobs (jobs);
+
+            // However many jobs ran, only the last one to finish
+            // sends a follow-up request, to a single peer.
+            int asked = 0;
+            for (std::size_t i = 0; i < peers.size (); ++i)
+            {
+                if (peers[i]->sent () != sent[i])
+                    ++asked;
+            }
+            BEAST_EXPECT(asked <= 1);
+        }
+
+        BEAST_EXPECT(rounds > 0 && rounds < 100);
+        BEAST_EXPECT(mostJobs > 1);
+        BEAST_EXPECT(source->stateMap().deepCompare (dest));
+        BEAST_EXPECT(inbound->getJson (0)[jss::have_state].asBool ());
+
+        // With no transactions to fetch, the state completes it
+        BEAST_EXPECT(inbound->isComplete ());
+        BEAST_EXPECT(! inbound->gotData (peers[0], makeBase (*source)));
+    }
+
+    void
+    run () override
+    {
+        testParallelData ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(InboundLedger,app,ripple);
+
+} // test
+} // ripple
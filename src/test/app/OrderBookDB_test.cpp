@@ -0,0 +1,318 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/ledger/AcceptedLedger.h>
+#include <ripple/app/ledger/OrderBookDB.h>
+#include <ripple/basics/contract.h>
+#include <ripple/core/Stoppable.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/test/jtx.h>
+#include <ripple/beast/unit_test.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Keeps the books current from the metadata of published ledgers.
+
+    After each change the books are compared with those a full scan
+    of the same ledger finds.
+*/
+class OrderBookDB_test : public beast::unit_test::suite
+{
+    // Forwards to a ledger, calling a function when a scan of
+    // its state first reaches the lowest keys.
+    class HookedView : public ReadView
+    {
+        std::shared_ptr<ReadView const> base_;
+        std::function<void()> hook_;
+        mutable std::atomic<bool> called_ {false};
+
+    public:
+        HookedView (std::shared_ptr<ReadView const> base,
+                std::function<void()> hook)
+            : base_ (std::move (base))
+            , hook_ (std::move (hook))
+        {
+        }
+
+        LedgerInfo const& info() const override
+            { return base_->info(); }
+        bool open() const override
+            { return base_->open(); }
+        Fees const& fees() const override
+            { return base_->fees(); }
+        Rules const& rules() const override
+            { return base_->rules(); }
+        bool exists (Keylet const& k) const override
+            { return base_->exists (k); }
+        boost::optional<key_type> succ (key_type const& key,
+            boost::optional<key_type> const& last) const override
+            { return base_->succ (key, last); }
+        std::shared_ptr<SLE const> read (Keylet const& k) const override
+            { return base_->read (k); }
+
+        std::unique_ptr<sles_type::iter_base>
+        slesBegin() const override
+        {
+            if (! called_.exchange (true))
+                hook_ ();
+            return base_->slesBegin();
+        }
+
+        std::unique_ptr<sles_type::iter_base>
+        slesEnd() const override
+            { return base_->slesEnd(); }
+        std::unique_ptr<sles_type::iter_base>
+        slesUpperBound (key_type const& key) const override
+            { return base_->slesUpperBound (key); }
+        std::unique_ptr<txs_type::iter_base>
+        txsBegin() const override
+            { return base_->txsBegin(); }
+        std::unique_ptr<txs_type::iter_base>
+        txsEnd() const override
+            { return base_->txsEnd(); }
+        bool txExists (key_type const& key) const override
+            { return base_->txExists (key); }
+        tx_type txRead (key_type const& key) const override
+            { return base_->txRead (key); }
+    };
+
+    static
+    Json::Value
+    cancelOffer (jtx::Account const& account, std::uint32_t offerSeq)
+    {
+        Json::Value jv;
+        jv[jss::Account] = account.human();
+        jv[jss::OfferSequence] = offerSeq;
+        jv[jss::TransactionType] = "OfferCancel";
+        return jv;
+    }
+
+    // The books which take the issue, in order
+    static
+    std::vector<Book>
+    books (OrderBookDB& db, Issue const& issue)
+    {
+        std::vector<Book> result;
+        for (auto const& ob : db.getBooksByTakerPays (issue))
+            result.push_back (ob->book ());
+        std::sort (result.begin (), result.end ());
+        return result;
+    }
+
+    static
+    void
+    publish (jtx::Env& env, OrderBookDB& db,
+        std::shared_ptr<ReadView const> const& ledger)
+    {
+        db.processLedger (AcceptedLedger (ledger,
+            env.app().accountIDCache(), env.app().logs()));
+    }
+
+    // Check the books against those a full scan of the ledger finds
+    void
+    expectBooks (jtx::Env& env, OrderBookDB& db,
+        std::shared_ptr<ReadView const> const& ledger,
+            std::vector<Issue> const& issues)
+    {
+        RootStoppable root ("root");
+        OrderBookDB fresh (env.app(), root);
+        fresh.update (ledger);
+
+        for (auto const& issue : issues)
+        {
+            BEAST_EXPECT(books (db, issue) == books (fresh, issue));
+            BEAST_EXPECT(db.isBookToXRP (issue) == fresh.isBookToXRP (issue));
+        }
+    }
+
+public:
+    void
+    testIncremental ()
+    {
+        testcase ("incremental");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        auto const alice = Account ("alice");
+        auto const bob = Account ("bob");
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+        std::vector<Issue> const issues {
+            xrpIssue (), USD.issue (), EUR.issue ()};
+
+        env.fund (XRP (10000), alice, bob, gw);
+        env.trust (USD (1000), alice, bob);
+        env.trust (EUR (1000), alice, bob);
+        env (pay (gw, alice, USD (100)));
+        env.close ();
+
+        RootStoppable root ("root");
+        OrderBookDB db (env.app(), root);
+        db.setup (env.closed ());
+        BEAST_EXPECT(books (db, xrpIssue ()).empty ());
+        expectBooks (env, db, env.closed (), issues);
+
+        // Offers which take XRP leave its currency and issuer out of
+        // the new directory's fields. Two qualities make two roots.
+        auto const aliceSeq = env.seq (alice);
+        env (offer (alice, XRP (100), USD (10)));
+        env (offer (alice, XRP (200), USD (10)));
+        env (offer (alice, EUR (10), USD (10)));
+        env (offer (bob, EUR (10), XRP (100)));
+        env.close ();
+        publish (env, db, env.closed ());
+        BEAST_EXPECT(books (db, xrpIssue ()).size () == 1);
+        BEAST_EXPECT(books (db, EUR.issue ()).size () == 2);
+        BEAST_EXPECT(db.isBookToXRP (EUR.issue ()));
+        expectBooks (env, db, env.closed (), issues);
+
+        // Consuming the better offer removes one root of the book
+        env (offer (bob, USD (10), XRP (100)));
+        env.close ();
+        publish (env, db, env.closed ());
+        BEAST_EXPECT(books (db, xrpIssue ()).size () == 1);
+        expectBooks (env, db, env.closed (), issues);
+
+        // Cancelling the other removes the book
+        env (cancelOffer (alice, aliceSeq + 1));
+        env.close ();
+        publish (env, db, env.closed ());
+        BEAST_EXPECT(books (db, xrpIssue ()).empty ());
+        BEAST_EXPECT(books (db, EUR.issue ()).size () == 2);
+        expectBooks (env, db, env.closed (), issues);
+    }
+
+    void
+    testPending ()
+    {
+        testcase ("pending");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        auto const alice = Account ("alice");
+        auto const bob = Account ("bob");
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+        std::vector<Issue> const issues {
+            xrpIssue (), USD.issue (), EUR.issue ()};
+
+        env.fund (XRP (10000), alice, bob, gw);
+        env.trust (USD (1000), alice, bob);
+        env.trust (EUR (1000), alice, bob);
+        env (pay (gw, alice, USD (100)));
+        env.close ();
+
+        std::vector<std::shared_ptr<ReadView const>> ledgers;
+        ledgers.push_back (env.closed ());
+        env (offer (alice, XRP (100), USD (10)));
+        env.close ();
+        ledgers.push_back (env.closed ());
+        env (offer (alice, EUR (10), USD (10)));
+        env.close ();
+        ledgers.push_back (env.closed ());
+        env (offer (bob, USD (10), XRP (100)));
+        env.close ();
+        ledgers.push_back (env.closed ());
+
+        {
+            // Ledgers published during the scan are replayed in order,
+            // skipping the one scanned and stopping at the gap.
+            RootStoppable root ("root");
+            OrderBookDB db (env.app(), root);
+            db.setup (std::make_shared<HookedView> (ledgers[0],
+                [&]
+                {
+                    publish (env, db, ledgers[3]);
+                    publish (env, db, ledgers[0]);
+                    publish (env, db, ledgers[1]);
+                }));
+            BEAST_EXPECT(books (db, xrpIssue ()).size () == 1);
+            expectBooks (env, db, ledgers[1], issues);
+
+            publish (env, db, ledgers[2]);
+            BEAST_EXPECT(books (db, EUR.issue ()).size () == 1);
+            expectBooks (env, db, ledgers[2], issues);
+
+            publish (env, db, ledgers[3]);
+            BEAST_EXPECT(books (db, xrpIssue ()).empty ());
+            expectBooks (env, db, ledgers[3], issues);
+        }
+
+        {
+            // A ledger which doesn't follow the books rebuilds them
+            RootStoppable root ("root");
+            OrderBookDB db (env.app(), root);
+            db.setup (ledgers[0]);
+            publish (env, db, ledgers[2]);
+            BEAST_EXPECT(books (db, xrpIssue ()).size () == 1);
+            expectBooks (env, db, ledgers[2], issues);
+
+            // and older ledgers are ignored
+            publish (env, db, ledgers[0]);
+            expectBooks (env, db, ledgers[2], issues);
+        }
+
+        {
+            // A scan which throws leaves nothing behind to stop
+            // the next ledger from starting another.
+            RootStoppable root ("root");
+            OrderBookDB db (env.app(), root);
+            try
+            {
+                db.setup (std::make_shared<HookedView> (ledgers[1],
+                    [&]
+                    {
+                        publish (env, db, ledgers[2]);
+                        Throw<std::runtime_error> ("scan failed");
+                    }));
+                fail ("no exception");
+            }
+            catch (std::runtime_error const&)
+            {
+                pass ();
+            }
+            BEAST_EXPECT(books (db, xrpIssue ()).empty ());
+
+            publish (env, db, ledgers[3]);
+            BEAST_EXPECT(books (db, EUR.issue ()).size () == 1);
+            expectBooks (env, db, ledgers[3], issues);
+        }
+    }
+
+    void
+    run () override
+    {
+        testIncremental ();
+        testPending ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(OrderBookDB,app,ripple);
+
+} // test
+} // ripple
@@ -0,0 +1,175 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/paths/RippleLineCache.h>
+#include <ripple/app/paths/Tuning.h>
+#include <ripple/test/jtx.h>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class RippleLineCache_test : public beast::unit_test::suite
+{
+public:
+    void
+    testCarryForward ()
+    {
+        testcase ("carry forward");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gateway");
+        Account const alice ("alice");
+        Account const bob ("bob");
+        Account const carol ("carol");
+        auto const USD = gw["USD"];
+
+        env.fund (XRP(10000), gw, alice, bob, carol);
+        env.trust (USD(1000), alice, bob);
+        env (pay (gw, alice, USD(50)));
+        env.close ();
+
+        auto const first = std::make_shared<RippleLineCache> (env.closed ());
+        auto const& aliceLines = first->getRippleLines (alice);
+        auto const& gwLines = first->getRippleLines (gw);
+        BEAST_EXPECT(aliceLines.size () == 1);
+        BEAST_EXPECT(gwLines.size () == 2);
+        BEAST_EXPECT(first->getRippleLines (carol).empty ());
+
+        // Affects the gateway, bob and carol but not alice
+        env (pay (gw, bob, USD(10)));
+        env.trust (USD(100), carol);
+        env.close ();
+
+        auto const second = std::make_shared<RippleLineCache> (
+            env.closed (), *first, env.journal);
+        BEAST_EXPECT(&second->getRippleLines (alice) == &aliceLines);
+        BEAST_EXPECT(&second->getRippleLines (gw) != &gwLines);
+        BEAST_EXPECT(second->getRippleLines (gw).size () == 3);
+        BEAST_EXPECT(second->getRippleLines (carol).size () == 1);
+        BEAST_EXPECT(second->getStaleHubs ().empty ());
+
+        auto const& bobLines = second->getRippleLines (bob);
+        BEAST_EXPECT(bobLines.size () == 1);
+        BEAST_EXPECT(bobLines[0]->getBalance () == USD(10).value ());
+    }
+
+    void
+    testStaleHubs ()
+    {
+        testcase ("stale hubs");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gateway");
+        auto const USD = gw["USD"];
+
+        env.fund (XRP(10000), gw);
+        std::vector<Account> holders;
+        for (int i = 0; i < PATHFINDER_HUB_LINES; ++i)
+        {
+            holders.emplace_back ("holder" + std::to_string (i));
+            env.fund (XRP(1000), holders.back ());
+            env.trust (USD(1000), holders.back ());
+        }
+        env.close ();
+
+        auto const first = std::make_shared<RippleLineCache> (env.closed ());
+        BEAST_EXPECT(first->getRippleLines (gw).size () ==
+            std::size_t (PATHFINDER_HUB_LINES));
+        first->getRippleLines (holders[1]);
+
+        env (pay (gw, holders[0], USD(10)));
+        env.close ();
+
+        // The gateway has many lines, so it is worth loading early
+        auto const second = std::make_shared<RippleLineCache> (
+            env.closed (), *first, env.journal);
+        BEAST_EXPECT((second->getStaleHubs () ==
+            std::vector<AccountID>{ gw.id () }));
+    }
+
+    void
+    testConcurrent ()
+    {
+        testcase ("concurrent");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gateway");
+        auto const USD = gw["USD"];
+
+        std::vector<Account> holders;
+        env.fund (XRP(10000), gw);
+        for (int i = 0; i < 8; ++i)
+        {
+            holders.emplace_back ("holder" + std::to_string (i));
+            env.fund (XRP(1000), holders.back ());
+            env.trust (USD(1000), holders.back ());
+        }
+        env.close ();
+
+        // Every thread sees the same lines for each account
+        RippleLineCache cache (env.closed ());
+        std::vector<std::vector<
+            std::vector<RippleState::pointer> const*>> seen (8);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t)
+        {
+            threads.emplace_back ([&, t]
+            {
+                for (std::size_t i = 0; i < holders.size (); ++i)
+                {
+                    auto const& holder = holders[(t + i) % holders.size ()];
+                    seen[t].push_back (&cache.getRippleLines (holder));
+                }
+                seen[t].push_back (&cache.getRippleLines (gw));
+            });
+        }
+        for (auto& thread : threads)
+            thread.join ();
+
+        for (int t = 0; t < 8; ++t)
+        {
+            for (std::size_t i = 0; i < holders.size (); ++i)
+            {
+                BEAST_EXPECT(seen[t][i] ==
+                    &cache.getRippleLines (holders[(t + i) % holders.size ()]));
+                BEAST_EXPECT(seen[t][i]->size () == 1);
+            }
+            BEAST_EXPECT(seen[t].back ()->size () == holders.size ());
+        }
+    }
+
+    void
+    run () override
+    {
+        testCarryForward ();
+        testStaleHubs ();
+        testConcurrent ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(RippleLineCache,app,ripple);
+
+} // test
+} // ripple
@@ -426,6 +426,7 @@ public:
         validationCheck(env, 0);
         ledgerCheck(env, ledgerSeq - 2, 2);
         BEAST_EXPECT(lastRotated == store.getLastRotated());
+        BEAST_EXPECT(store.getJson().isNull());
 
         {
             // Closing one more ledger triggers a rotate
@@ -443,6 +444,19 @@ public:
 
         lastRotated = store.getLastRotated();
 
+        {
+            // The whole state map was copied, and is reported
+            auto const rotation = store.getJson();
+            BEAST_EXPECT(rotation[jss::state] == "complete");
+            BEAST_EXPECT(rotation[jss::ledger_index] == lastRotated);
+            BEAST_EXPECT(rotation[jss::nodes_present].asUInt() +
+                rotation[jss::nodes_written].asUInt() > 0);
+
+            auto const info = env.rpc("server_info");
+            BEAST_EXPECT(info[jss::result][jss::info][jss::rotation] ==
+                rotation);
+        }
+
         // Close enough ledgers to trigger another rotate
         for (; ledgerSeq < lastRotated + deleteInterval + 1; ++ledgerSeq)
         {
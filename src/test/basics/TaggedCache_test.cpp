@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <ripple/basics/CacheBudget.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/basics/TaggedCache.h>
 #include <ripple/beast/unit_test.h>
@@ -38,18 +39,22 @@ original object.
 class TaggedCache_test : public beast::unit_test::suite
 {
 public:
-    void run ()
+    using Key = int;
+    using Value = std::string;
+    using Cache = TaggedCache <Key, Value>;
+
+    void testCache (std::size_t partitions)
     {
+        testcase ("partitions " + std::to_string (partitions));
+
         beast::Journal const j;
 
         TestStopwatch clock;
         clock.set (0);
 
-        using Key = int;
-        using Value = std::string;
-        using Cache = TaggedCache <Key, Value>;
-
-        Cache c ("test", 1, 1, clock, j);
+        Cache c ("test", 1, 1, clock, j,
+            beast::insight::NullCollector::New (), partitions);
+        BEAST_EXPECT(c.getPartitionCount () == partitions);
 
         // Insert an item, retrieve it, and age it so it gets purged.
         {
@@ -145,6 +150,127 @@ public:
             BEAST_EXPECT(c.getTrackSize() == 0);
         }
     }
+
+    void testPartitionStats ()
+    {
+        testcase ("partition stats");
+
+        beast::Journal const j;
+
+        TestStopwatch clock;
+        clock.set (0);
+
+        Cache c ("test", 64, 1, clock, j,
+            beast::insight::NullCollector::New (), 8);
+
+        for (int i = 0; i < 64; ++i)
+            BEAST_EXPECT(! c.insert (i, std::to_string (i)));
+
+        for (int i = 0; i < 128; ++i)
+            c.fetch (i);
+
+        auto const stats = c.getPartitionStats ();
+        BEAST_EXPECT(stats.size () == 8);
+
+        std::size_t tracked = 0;
+        int cached = 0;
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        for (auto const& s : stats)
+        {
+            tracked += s.trackSize;
+            cached += s.cacheSize;
+            hits += s.hits;
+            misses += s.misses;
+            BEAST_EXPECT(s.contended == 0);
+        }
+        BEAST_EXPECT(tracked == 64);
+        BEAST_EXPECT(cached == 64);
+        BEAST_EXPECT(hits == 64);
+        BEAST_EXPECT(misses == 64);
+        BEAST_EXPECT(c.getHitRate () == 50.0f);
+
+        // Each partition is swept against its share of the target
+        ++clock;
+        c.sweep ();
+        BEAST_EXPECT(c.getCacheSize () == 0);
+        BEAST_EXPECT(c.getTrackSize () == 0);
+    }
+
+    void testBudget ()
+    {
+        testcase ("budget");
+
+        beast::Journal const j;
+
+        TestStopwatch clock;
+        clock.set (0);
+
+        CacheBudget budget;
+
+        {
+            Cache c ("test", 0, 10, clock, j,
+                beast::insight::NullCollector::New (), 4);
+            c.setCostFunction ([](Value const&) { return 1000; });
+            c.setBudget (budget);
+
+            for (int i = 0; i < 10; ++i)
+                BEAST_EXPECT(! c.insert (i, std::to_string (i)));
+            clock.set (5);
+            for (int i = 10; i < 20; ++i)
+                BEAST_EXPECT(! c.insert (i, std::to_string (i)));
+            clock.set (6);
+
+            auto const full = c.getCacheBytes ();
+            BEAST_EXPECT(full > 20 * 1000);
+
+            // Without a limit nothing is old enough to expire
+            BEAST_EXPECT(budget.update () == full);
+            BEAST_EXPECT(budget.getScale () == 1.0);
+            c.sweep ();
+            BEAST_EXPECT(c.getCacheSize () == 20);
+
+            // Twice the budget halves the target age, so the
+            // older half of the entries goes
+            budget.setBudget (full / 2);
+            BEAST_EXPECT(budget.update () == full);
+            BEAST_EXPECT(budget.getScale () == 0.5);
+            c.sweep ();
+            BEAST_EXPECT(c.getCacheSize () == 10);
+            BEAST_EXPECT(c.getCacheBytes () == full / 2);
+            BEAST_EXPECT(c.fetch (15) != nullptr);
+
+            auto const usage = budget.getUsage ();
+            BEAST_EXPECT(usage.size () == 1);
+            BEAST_EXPECT(usage[0].first == "test");
+            BEAST_EXPECT(usage[0].second == full);
+
+            // Usage at the budget holds the scale steady
+            budget.update ();
+            BEAST_EXPECT(budget.getScale () == 0.5);
+
+            // Well under the budget the scale recovers
+            c.clear ();
+            BEAST_EXPECT(c.getCacheBytes () == 0);
+            budget.update ();
+            BEAST_EXPECT(budget.getScale () > 0.5);
+            BEAST_EXPECT(budget.getScale () < 1.0);
+
+            budget.setBudget (0);
+            BEAST_EXPECT(budget.getScale () == 1.0);
+        }
+
+        // The cache leaves the budget when destroyed
+        BEAST_EXPECT(budget.getUsage ().empty ());
+    }
+
+    void run ()
+    {
+        testCache (1);
+        testCache (8);
+        testPartitionStats ();
+        testBudget ();
+    }
 };
 
 BEAST_DEFINE_TESTSUITE(TaggedCache,common,ripple);
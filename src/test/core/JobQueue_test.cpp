@@ -0,0 +1,270 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/contract.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/beast/insight/NullCollector.h>
+#include <ripple/beast/unit_test.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class JobQueue_test : public beast::unit_test::suite
+{
+    // Blocks a job until released
+    class gate
+    {
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool open_ = false;
+
+    public:
+        void
+        wait ()
+        {
+            std::unique_lock<std::mutex> lock (mutex_);
+            cv_.wait (lock, [this]{ return open_; });
+        }
+
+        void
+        open ()
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            open_ = true;
+            cv_.notify_all ();
+        }
+    };
+
+    // Owns a started JobQueue
+    struct Fixture
+    {
+        Logs logs {beast::severities::kDisabled};
+        RootStoppable root {"root"};
+        JobQueue jq;
+
+        explicit
+        Fixture (int threads)
+            : jq (beast::insight::NullCollector::New (), root,
+                beast::Journal (), logs)
+        {
+            jq.setThreadCount (threads, false);
+            root.prepare ();
+            root.start ();
+        }
+
+        ~Fixture ()
+        {
+            root.stop (beast::Journal ());
+        }
+    };
+
+    void
+    testPriority ()
+    {
+        testcase ("priority");
+
+        Fixture f (1);
+        gate started;
+        gate g;
+        std::mutex m;
+        std::vector<JobType> order;
+
+        f.jq.addJob (jtADMIN, "block", [&](Job&)
+        {
+            started.open ();
+            g.wait ();
+        });
+
+        for (auto const type : { jtPACK, jtACCEPT, jtCLIENT, jtTRANSACTION,
+            jtCLIENT })
+        {
+            f.jq.addJob (type, "test", [&, type](Job&)
+            {
+                std::lock_guard<std::mutex> lock (m);
+                order.push_back (type);
+            });
+        }
+
+        // The counts are available while the jobs wait
+        started.wait ();
+        BEAST_EXPECT(f.jq.getJobCount (jtCLIENT) == 2);
+        BEAST_EXPECT(f.jq.getJobCount (jtPACK) == 1);
+        BEAST_EXPECT(f.jq.getJobCountTotal (jtADMIN) == 1);
+        BEAST_EXPECT(f.jq.getJobCountGE (jtCLIENT) == 4);
+
+        g.open ();
+        f.jq.rendezvous ();
+
+        BEAST_EXPECT((order == std::vector<JobType>{
+            jtACCEPT, jtTRANSACTION, jtCLIENT, jtCLIENT, jtPACK }));
+        BEAST_EXPECT(f.jq.getJobCountTotal (jtCLIENT) == 0);
+    }
+
+    void
+    testLimit ()
+    {
+        testcase ("limit");
+
+        // jtLEDGER_REQ may only run two at a time
+        Fixture f (8);
+        gate full;
+        gate release;
+        std::atomic<int> running {0};
+        std::atomic<int> peak {0};
+        std::atomic<int> done {0};
+        int const count = 200;
+
+        for (int i = 0; i < count; ++i)
+        {
+            f.jq.addJob (jtLEDGER_REQ, "test", [&](Job&)
+            {
+                int const now = ++running;
+                int p = peak;
+                while (now > p && ! peak.compare_exchange_weak (p, now))
+                    ;
+                if (now == 2)
+                    full.open ();
+                release.wait ();
+                --running;
+                ++done;
+            });
+        }
+
+        // With two jobs held, the rest wait despite idle threads
+        full.wait ();
+        BEAST_EXPECT(running == 2);
+        BEAST_EXPECT(f.jq.getJobCount (jtLEDGER_REQ) == count - 2);
+        BEAST_EXPECT(f.jq.getJobCountTotal (jtLEDGER_REQ) == count);
+
+        release.open ();
+        f.jq.rendezvous ();
+        BEAST_EXPECT(done == count);
+        BEAST_EXPECT(peak == 2);
+    }
+
+    void
+    testConcurrent ()
+    {
+        testcase ("concurrent");
+
+        JobType const types[] = { jtPACK, jtLEDGER_REQ, jtLEDGER_DATA,
+            jtCLIENT, jtTRANSACTION, jtUNL, jtWRITE, jtADMIN };
+
+        Fixture f (8);
+        std::atomic<int> done {0};
+        int const producers = 4;
+        int const perProducer = 20000;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < producers; ++i)
+        {
+            threads.emplace_back ([&, i]
+            {
+                for (int j = 0; j < perProducer; ++j)
+                {
+                    auto const type = types[(i + j) % std::extent<
+                        decltype(types)>::value];
+                    f.jq.addJob (type, "test", [&](Job&) { ++done; });
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join ();
+
+        f.jq.rendezvous ();
+        BEAST_EXPECT(done == producers * perProducer);
+        for (auto const type : types)
+            BEAST_EXPECT(f.jq.getJobCountTotal (type) == 0);
+    }
+
+    void
+    testParallelFor ()
+    {
+        testcase ("parallelFor");
+
+        {
+            Fixture f (4);
+            std::vector<std::atomic<int>> calls (1000);
+            for (auto& c : calls)
+                c = 0;
+            f.jq.parallelFor (jtCLIENT, "test", calls.size (), 4,
+                [&](std::size_t i) { ++calls[i]; });
+            bool once = true;
+            for (auto const& c : calls)
+                once = once && c == 1;
+            BEAST_EXPECT(once);
+            f.jq.rendezvous ();
+        }
+
+        {
+            // Completes on the calling thread when no job thread is free
+            Fixture f (1);
+            gate g;
+            f.jq.addJob (jtCLIENT, "block", [&](Job&) { g.wait (); });
+            std::atomic<int> calls {0};
+            f.jq.parallelFor (jtCLIENT, "test", 100, 4,
+                [&](std::size_t) { ++calls; });
+            BEAST_EXPECT(calls == 100);
+            g.open ();
+            f.jq.rendezvous ();
+        }
+
+        {
+            Fixture f (4);
+            bool thrown = false;
+            try
+            {
+                f.jq.parallelFor (jtCLIENT, "test", 100, 4,
+                    [&](std::size_t i)
+                    {
+                        if (i == 10)
+                            Throw<std::runtime_error> ("parallelFor");
+                    });
+            }
+            catch (std::runtime_error const&)
+            {
+                thrown = true;
+            }
+            BEAST_EXPECT(thrown);
+            f.jq.rendezvous ();
+        }
+    }
+
+public:
+    void
+    run () override
+    {
+        testPriority ();
+        testLimit ();
+        testConcurrent ();
+        testParallelFor ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(JobQueue,core,ripple);
+
+}
@@ -20,12 +20,15 @@
 #include <BeastConfig.h>
 
 #include <ripple/core/ConfigSections.h>
+#include <ripple/core/DatabaseCon.h>
 #include <ripple/core/SociDB.h>
+#include <ripple/protocol/JsonFields.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/TestSuite.h>
 #include <ripple/basics/BasicConfig.h>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
+#include <future>
 
 namespace ripple {
 class SociDB_test final : public TestSuite
@@ -361,12 +364,83 @@ public:
         if (bfs::is_regular_file (dbPath))
             bfs::remove (dbPath);
     }
+    void testReadConnections ()
+    {
+        testcase ("readConnections");
+        const char* dbInit[] = {
+            "PRAGMA journal_mode=WAL;",
+            "PRAGMA cache_size=-1234;",
+            "CREATE TABLE IF NOT EXISTS Ledgers (LedgerSeq BIGINT UNSIGNED);"};
+        int const dbInitCount = std::extent<decltype(dbInit)>::value;
+        std::string const dbName ("DatabaseConTestDB.db");
+
+        DatabaseCon::Setup setup;
+        setup.dataDir = getDatabasePath ();
+        setup.readers = 2;
+        {
+            DatabaseCon dbCon (setup, dbName, dbInit, dbInitCount);
+            {
+                auto db = dbCon.checkoutDb ();
+                *db << "INSERT INTO Ledgers (LedgerSeq) VALUES (1);";
+            }
+            {
+                // Readers see committed writes, and cannot write
+                auto db = dbCon.checkoutReadDb ();
+                BEAST_EXPECT(db.get () != &dbCon.getSession ());
+                int count = 0;
+                *db << "SELECT COUNT(*) FROM Ledgers;", soci::into (count);
+                BEAST_EXPECT(count == 1);
+
+                // and share the writer's per-connection settings
+                int cacheSize = 0;
+                *db << "PRAGMA cache_size;", soci::into (cacheSize);
+                BEAST_EXPECT(cacheSize == -1234);
+                try
+                {
+                    *db << "INSERT INTO Ledgers (LedgerSeq) VALUES (2);";
+                    fail ("reader wrote to the database");
+                }
+                catch (soci::soci_error const&)
+                {
+                    pass ();
+                }
+            }
+            {
+                // Concurrent checkouts get different readers
+                auto a = dbCon.checkoutReadDb ();
+                auto b = std::async (std::launch::async,
+                    [&dbCon] { return dbCon.checkoutReadDb ().get (); });
+                BEAST_EXPECT(b.get () != a.get ());
+            }
+            auto const json = dbCon.getJson ();
+            BEAST_EXPECT(json[jss::read_connections].asUInt () == 2);
+            BEAST_EXPECT(json[jss::reads][jss::checkouts].asUInt () == 3);
+            BEAST_EXPECT(json[jss::reads][jss::waits].asUInt () == 0);
+            BEAST_EXPECT(json[jss::writes][jss::checkouts].asUInt () == 1);
+        }
+        {
+            // A private temporary database has no readers
+            setup.standAlone = true;
+            DatabaseCon dbCon (setup, dbName, dbInit, dbInitCount);
+            BEAST_EXPECT(dbCon.getJson ()[jss::read_connections] == 0);
+            auto db = dbCon.checkoutReadDb ();
+            BEAST_EXPECT(db.get () == &dbCon.getSession ());
+        }
+        namespace bfs = boost::filesystem;
+        for (auto const suffix : {"", "-wal", "-shm"})
+        {
+            bfs::path dbPath (getDatabasePath () / (dbName + suffix));
+            if (bfs::is_regular_file (dbPath))
+                bfs::remove (dbPath);
+        }
+    }
     void testSQLite ()
     {
         testSQLiteFileNames ();
         testSQLiteSession ();
         testSQLiteSelect ();
         testSQLiteDeleteWithSubselect();
+        testReadConnections ();
     }
     void run ()
     {
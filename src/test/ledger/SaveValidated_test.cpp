@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/core/DatabaseCon.h>
+#include <ripple/test/jtx.h>
+#include <ripple/beast/unit_test.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+// Measures how quickly validated ledgers are written to the SQL
+// databases, as they are when backfilling history.
+class SaveValidated_test : public beast::unit_test::suite
+{
+public:
+    void
+    test (std::size_t ledgers, std::size_t txns)
+    {
+        using namespace jtx;
+        using clock_type = std::chrono::steady_clock;
+
+        testcase << ledgers << " ledgers of " << txns << " payments";
+
+        // Build the history on one server
+        Env source (*this);
+        source.disable_sigs();
+
+        std::vector<Account> accounts;
+        for (std::size_t i = 0; i < txns; ++i)
+        {
+            accounts.emplace_back ("a" + std::to_string (i));
+            source.fund (XRP(100000), accounts.back());
+        }
+        source.close();
+
+        std::vector<std::shared_ptr<Ledger const>> history;
+        for (std::size_t i = 0; i < ledgers; ++i)
+        {
+            for (std::size_t j = 0; j < txns; ++j)
+                source (pay (accounts[j],
+                    accounts[(i + j + 1) % txns], XRP(1)));
+            source.close();
+            history.push_back (
+                source.app().getLedgerMaster().getClosedLedger());
+        }
+
+        // Save it into another which has never seen it
+        Env dest (*this);
+
+        auto const start = clock_type::now();
+        for (auto const& ledger : history)
+            BEAST_EXPECT(pendSaveValidated (
+                dest.app(), ledger, true, false));
+        auto const elapsed = std::chrono::duration_cast<
+            std::chrono::milliseconds>(clock_type::now() - start);
+
+        log << history.size() << " ledgers in " << elapsed.count() <<
+            "ms, " << (history.size() * 1000.0 /
+                std::max<std::int64_t>(elapsed.count(), 1)) <<
+            " ledgers/s" << std::endl;
+
+        // Each payment touches two accounts
+        int rows = 0;
+        {
+            auto db = dest.app().getTxnDB().checkoutDb();
+            *db << "SELECT COUNT(*) FROM AccountTransactions;",
+                soci::into (rows);
+        }
+        BEAST_EXPECT(rows == static_cast<int>(ledgers * txns * 2));
+    }
+
+    void
+    run() override
+    {
+        test (100, 10);
+        test (100, 100);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SaveValidated,ledger,ripple);
+
+} // test
+} // ripple
@@ -20,6 +20,8 @@
 #include <BeastConfig.h>
 #include <ripple/test/jtx.h>
 #include <ripple/app/ledger/Ledger.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/ledger/CachedSLEs.h>
 #include <ripple/ledger/ApplyViewImpl.h>
 #include <ripple/ledger/OpenView.h>
 #include <ripple/ledger/PaymentSandbox.h>
@@ -179,6 +181,51 @@ class View_test
         BEAST_EXPECT(v.exists(k(3)));
     }
 
+    // Exercise reads through the SLE cache
+    void
+    testCachedReads()
+    {
+        using namespace jtx;
+        Env env(*this);
+        Config config;
+        CachedSLEs cache(std::chrono::minutes(1), stopwatch());
+        std::shared_ptr<Ledger const> const genesis =
+            std::make_shared<Ledger>(
+                create_genesis, config, env.app().family());
+        auto const ledger =
+            std::make_shared<Ledger>(
+                *genesis,
+                env.app().timeKeeper().closeTime());
+        wipe(*ledger);
+        ledger->rawInsert(sle(1, 1));
+        ledger->rawInsert(sle(2, 2));
+
+        // Mutable ledgers are not cached
+        ledger->setCache(cache);
+        BEAST_EXPECT(ledger->read(k(1)) != ledger->read(k(1)));
+        BEAST_EXPECT(cache.rate() == 0);
+
+        ledger->setImmutable(config);
+        auto const first = ledger->read(k(1));
+        BEAST_EXPECT(seq(first) == 1);
+        BEAST_EXPECT(ledger->read(k(1)) == first);
+        BEAST_EXPECT(! ledger->read(Keylet{ltOFFER, k(1).key}));
+
+        // The next ledger shares the unchanged items
+        auto const next =
+            std::make_shared<Ledger>(
+                *ledger,
+                env.app().timeKeeper().closeTime());
+        auto s = copy(next->read(k(2)));
+        seq(s, 3);
+        next->rawReplace(std::move(s));
+        next->setImmutable(config);
+        BEAST_EXPECT(next->read(k(1)) == first);
+        BEAST_EXPECT(seq(next->read(k(2))) == 3);
+        BEAST_EXPECT(seq(ledger->read(k(2))) == 2);
+        BEAST_EXPECT(cache.rate() > 0);
+    }
+
     void
     testMeta()
     {
@@ -783,6 +830,7 @@ class View_test
         BEAST_EXPECT(k(0).key < k(1).key);
 
         testLedger();
+        testCachedReads();
         testMeta();
         testMetaSucc();
         testStacked();
@@ -80,6 +80,14 @@ public:
                 fetchCopyOfBatch (*backend, &copy, batch);
                 BEAST_EXPECT(areBatchesEqual (batch, copy));
             }
+
+            {
+                // Read it back in a single batch
+                BEAST_EXPECT(backend->canFetchBatch ());
+                Batch copy;
+                fetchBatchCopyOfBatch (*backend, &copy, batch);
+                BEAST_EXPECT(areBatchesEqual (batch, copy));
+            }
         }
 
         {
@@ -105,6 +113,8 @@ public:
 
         testBackend ("nudb", seedValue);
 
+        testBackend ("memory", seedValue);
+
     #if RIPPLE_ROCKSDB_AVAILABLE
         testBackend ("rocksdb", seedValue);
     #endif
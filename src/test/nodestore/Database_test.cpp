@@ -20,6 +20,7 @@
 #include <BeastConfig.h>
 #include <ripple/nodestore/tests/Base.test.h>
 #include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Factory.h>
 #include <ripple/nodestore/Manager.h>
 #include <ripple/beast/utility/temp_dir.h>
 #include <algorithm>
@@ -29,7 +30,113 @@ namespace NodeStore {
 
 class Database_test : public TestBase
 {
+    // A memory backend whose batch fetches always fail
+    class FailBatchBackend : public Backend
+    {
+        std::unique_ptr <Backend> backend_;
+
+    public:
+        explicit
+        FailBatchBackend (std::unique_ptr <Backend> backend)
+            : backend_ (std::move (backend))
+        {
+        }
+
+        std::string getName () override { return backend_->getName (); }
+        void close () override { backend_->close (); }
+
+        Status fetch (void const* key,
+            std::shared_ptr<NodeObject>* pObject) override
+        {
+            return backend_->fetch (key, pObject);
+        }
+
+        bool canFetchBatch () override { return true; }
+
+        std::vector<std::shared_ptr<NodeObject>>
+        fetchBatch (std::size_t, void const* const*) override
+        {
+            Throw<std::runtime_error> ("batch fetch failed");
+            return {};
+        }
+
+        void store (std::shared_ptr<NodeObject> const& object) override
+        {
+            backend_->store (object);
+        }
+        void storeBatch (Batch const& batch) override
+        {
+            backend_->storeBatch (batch);
+        }
+        void for_each (
+            std::function <void (std::shared_ptr<NodeObject>)> f) override
+        {
+            backend_->for_each (f);
+        }
+        int getWriteLoad () override { return 0; }
+        void setDeletePath () override { }
+        void verify () override { }
+        int fdlimit () const override { return 0; }
+    };
+
+    class FailBatchFactory : public Factory
+    {
+    public:
+        std::string getName () const override { return "failbatch"; }
+
+        std::unique_ptr <Backend>
+        createInstance (size_t, Section const& parameters,
+            Scheduler& scheduler, beast::Journal journal) override
+        {
+            Section memory (parameters);
+            memory.set ("type", "memory");
+            return std::make_unique <FailBatchBackend> (
+                Manager::instance().make_Backend (
+                    memory, scheduler, journal));
+        }
+    };
+
 public:
+    // The prefetch threads survive a backend whose batch fetches
+    // throw, and read the objects one at a time instead.
+    void testFetchBatchErrors (std::int64_t const seedValue)
+    {
+        testcase ("batch fetch errors");
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+        FailBatchFactory factory;
+        Manager::instance().insert (factory);
+
+        Section params;
+        params.set ("type", "memory");
+        params.set ("path", "failbatch");
+
+        auto batch = createPredictableBatch (
+            numObjectsToTest, seedValue);
+        {
+            auto backend = Manager::instance().make_Backend (
+                params, scheduler, j);
+            storeBatch (*backend, batch);
+        }
+
+        params.set ("type", "failbatch");
+        {
+            std::unique_ptr <Database> db = Manager::instance().make_Database (
+                "test", scheduler, j, 2, params);
+
+            Batch copy;
+            fetchAsyncCopyOfBatch (*db, &copy, batch);
+
+            std::sort (batch.begin (), batch.end (), LessThan{});
+            std::sort (copy.begin (), copy.end (), LessThan{});
+            BEAST_EXPECT(areBatchesEqual (batch, copy));
+            BEAST_EXPECT(db->getFetchErrorCount () > 0);
+        }
+
+        Manager::instance().erase (factory);
+    }
+
     void testImport (std::string const& destBackendType,
         std::string const& srcBackendType, std::int64_t seedValue)
     {
@@ -154,6 +261,19 @@ public:
                 std::sort (copy.begin (), copy.end (), LessThan{});
                 BEAST_EXPECT(areBatchesEqual (batch, copy));
             }
+
+            {
+                // Re-open the database and read it back in
+                // through the prefetch threads
+                std::unique_ptr <Database> db = Manager::instance().make_Database (
+                    "test", scheduler, j, 2, nodeParams);
+
+                Batch copy;
+                fetchAsyncCopyOfBatch (*db, &copy, batch);
+
+                std::sort (copy.begin (), copy.end (), LessThan{});
+                BEAST_EXPECT(areBatchesEqual (batch, copy));
+            }
         }
     }
 
@@ -191,6 +311,8 @@ public:
 
         testNodeStore ("memory", false, seedValue);
 
+        testFetchBatchErrors (seedValue);
+
         runBackendTests (seedValue);
 
         runImportTests (seedValue);
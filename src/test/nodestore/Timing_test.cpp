@@ -118,8 +118,13 @@ public:
         rngcpy (data + 1, key.size() - 1, gen_);
         Blob value(d_size_(gen_));
         rngcpy (&value[0], value.size(), gen_);
+        auto type = d_type_(gen_);
+        // The value between hotLEDGER and hotACCOUNT_NODE is unused,
+        // and the decoder rejects it
+        if (type == hotLEDGER + 1)
+            type = hotACCOUNT_NODE;
         return NodeObject::createObject (
-            static_cast<NodeObjectType>(d_type_(gen_)),
+            static_cast<NodeObjectType>(type),
                 std::move(value), key);
     }
 
@@ -383,6 +388,84 @@ public:
         backend->close();
     }
 
+    // Fetch existing keys in batches
+    void
+    do_batch (Section const& config, Params const& params)
+    {
+        beast::Journal journal;
+        DummyScheduler scheduler;
+        auto backend = make_Backend (config, scheduler, journal);
+        BEAST_EXPECT(backend != nullptr);
+
+        // Matches the batches the prefetch threads issue
+        std::size_t const batchSize = 64;
+
+        class Body
+        {
+        private:
+            suite& suite_;
+            Backend& backend_;
+            std::size_t const batchSize_;
+            Sequence seq1_;
+            beast::xor_shift_engine gen_;
+            std::uniform_int_distribution<std::size_t> dist_;
+
+        public:
+            Body (std::size_t id, suite& s, Params const& params,
+                    Backend& backend, std::size_t batchSize)
+                : suite_(s)
+                , backend_ (backend)
+                , batchSize_ (batchSize)
+                , seq1_ (1)
+                , gen_ (id + 1)
+                , dist_ (0, params.items - 1)
+            {
+            }
+
+            void
+            operator()(std::size_t i)
+            {
+                try
+                {
+                    std::vector<std::shared_ptr<NodeObject>> objs;
+                    std::vector<void const*> keys;
+                    objs.reserve (batchSize_);
+                    keys.reserve (batchSize_);
+                    for (std::size_t j = 0; j < batchSize_; ++j)
+                    {
+                        objs.push_back (seq1_.obj(dist_(gen_)));
+                        keys.push_back (objs.back()->getHash().data());
+                    }
+                    auto const results = backend_.fetchBatch (
+                        keys.size(), keys.data());
+                    for (std::size_t j = 0; j < batchSize_; ++j)
+                        suite_.expect(results[j] &&
+                            isSame(results[j], objs[j]));
+                }
+                catch(std::exception const& e)
+                {
+                    suite_.fail(e.what());
+                }
+            }
+        };
+        try
+        {
+            // Each call fetches a batch, so the number
+            // of objects read is the same as do_fetch.
+            parallel_for_id<Body>(params.items / batchSize, params.threads,
+                std::ref(*this), std::ref(params), std::ref(*backend),
+                    batchSize);
+        }
+        catch (std::exception const&)
+        {
+        #if NODESTORE_TIMING_DO_VERIFY
+            backend->verify();
+        #endif
+            Rethrow();
+        }
+        backend->close();
+    }
+
     // Perform lookups of non-existent keys
     void
     do_missing (Section const& config, Params const& params)
@@ -701,9 +784,13 @@ public:
             repeat          Number of times to repeat each test
             items           Number of objects to create in the database
 
+            For NuDB, queue_depth sets the number of reads a
+            batch fetch keeps outstanding.
         */
         std::string default_args =
-            "type=nudb"
+            "type=nudb,queue_depth=1"
+            ";type=nudb,queue_depth=4"
+            ";type=nudb,queue_depth=16"
         #if RIPPLE_ROCKSDB_AVAILABLE
             ";type=rocksdb,open_files=2000,filter_bits=12,cache_mb=256,"
                 "file_size_mb=8,file_size_mult=2"
@@ -717,6 +804,7 @@ public:
             {
                  { "Insert",    &Timing_test::do_insert }
                 ,{ "Fetch",     &Timing_test::do_fetch }
+                ,{ "Batch",     &Timing_test::do_batch }
                 ,{ "Missing",   &Timing_test::do_missing }
                 ,{ "Mixed",     &Timing_test::do_mixed }
                 ,{ "Work",      &Timing_test::do_work }
@@ -0,0 +1,216 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright 2014 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/overlay/Message.h>
+#include <ripple/overlay/impl/ProtocolMessage.h>
+#include <ripple/overlay/impl/Tuning.h>
+#include <ripple/beast/unit_test.h>
+#include <boost/asio/buffer.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+class compression_test : public beast::unit_test::suite
+{
+    // Records the messages passed to it
+    struct Handler
+    {
+        std::shared_ptr<::google::protobuf::Message> message;
+        std::size_t size = 0;
+        std::size_t uncompressedSize = 0;
+
+        boost::system::error_code
+        onMessageUnknown (std::uint16_t)
+        {
+            return boost::system::errc::make_error_code(
+                boost::system::errc::not_supported);
+        }
+
+        boost::system::error_code
+        onMessageBegin (std::uint16_t,
+            std::shared_ptr<::google::protobuf::Message> const& m,
+            std::size_t size_, std::size_t uncompressedSize_)
+        {
+            message = m;
+            size = size_;
+            uncompressedSize = uncompressedSize_;
+            return {};
+        }
+
+        template <class T>
+        void
+        onMessage (std::shared_ptr<T> const&)
+        {
+        }
+
+        void
+        onMessageEnd (std::uint16_t,
+            std::shared_ptr<::google::protobuf::Message> const&)
+        {
+        }
+    };
+
+    static
+    protocol::TMLedgerData
+    makeLedgerData (int nodes)
+    {
+        protocol::TMLedgerData ld;
+        ld.set_ledgerhash (std::string (32, 'h'));
+        ld.set_ledgerseq (1);
+        ld.set_type (protocol::liAS_NODE);
+        for (int i = 0; i < nodes; ++i)
+        {
+            auto node = ld.add_nodes ();
+            node->set_nodeid (std::string (33, char (i)));
+            node->set_nodedata (std::string (64, 'd'));
+        }
+        return ld;
+    }
+
+    void
+    testRoundTrip ()
+    {
+        testcase ("round trip");
+
+        auto const ld = makeLedgerData (100);
+        Message m (ld, protocol::mtLEDGER_DATA);
+
+        auto const& plain = m.getBuffer (false);
+        auto const& packed = m.getBuffer (true);
+        BEAST_EXPECT(&plain == &m.getBuffer ());
+        BEAST_EXPECT(packed.size () < plain.size ());
+        BEAST_EXPECT(Message::compressed (boost::asio::buffer (packed)));
+        BEAST_EXPECT(! Message::compressed (boost::asio::buffer (plain)));
+        BEAST_EXPECT(Message::type (boost::asio::buffer (packed)) ==
+            protocol::mtLEDGER_DATA);
+
+        // Compressed once, for every peer
+        BEAST_EXPECT(&m.getBuffer (true) == &packed);
+
+        Handler h;
+        auto const result = invokeProtocolMessage (
+            boost::asio::buffer (packed), h);
+        BEAST_EXPECT(! result.second);
+        BEAST_EXPECT(result.first == packed.size ());
+        BEAST_EXPECT(h.size == packed.size ());
+        BEAST_EXPECT(h.uncompressedSize == plain.size ());
+        if (BEAST_EXPECT(h.message))
+            BEAST_EXPECT(h.message->SerializeAsString () ==
+                ld.SerializeAsString ());
+
+        // Incomplete messages are not consumed
+        std::vector<std::uint8_t> part (packed.begin (), packed.end () - 1);
+        Handler h2;
+        BEAST_EXPECT(invokeProtocolMessage (
+            boost::asio::buffer (part), h2).first == 0);
+        BEAST_EXPECT(! h2.message);
+    }
+
+    void
+    testUncompressed ()
+    {
+        testcase ("uncompressed");
+
+        // Too small to be worth compressing
+        auto const small = makeLedgerData (1);
+        Message m (small, protocol::mtLEDGER_DATA);
+        BEAST_EXPECT(m.getBuffer ().size () <
+            Message::kHeaderBytes + Tuning::minCompressBytes);
+        BEAST_EXPECT(&m.getBuffer (true) == &m.getBuffer ());
+
+        // Does not shrink
+        std::uint64_t x = 88172645463325252ULL;
+        std::string data (4096 + 32, 0);
+        for (auto& c : data)
+        {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            c = static_cast<char> (x);
+        }
+        protocol::TMLedgerData random;
+        random.set_ledgerhash (data.substr (4096));
+        random.set_ledgerseq (1);
+        random.set_type (protocol::liAS_NODE);
+        random.add_nodes ()->set_nodedata (data.substr (0, 4096));
+        Message r (random, protocol::mtLEDGER_DATA);
+        BEAST_EXPECT(&r.getBuffer (true) == &r.getBuffer ());
+
+        Handler h;
+        auto const& buffer = r.getBuffer ();
+        auto const result = invokeProtocolMessage (
+            boost::asio::buffer (buffer), h);
+        BEAST_EXPECT(! result.second);
+        BEAST_EXPECT(result.first == buffer.size ());
+        BEAST_EXPECT(h.uncompressedSize == buffer.size ());
+    }
+
+    void
+    testCorrupt ()
+    {
+        testcase ("corrupt");
+
+        Message m (makeLedgerData (100), protocol::mtLEDGER_DATA);
+        auto const& packed = m.getBuffer (true);
+
+        // The packed length is larger than the data
+        {
+            auto bad = packed;
+            bad[Message::kHeaderBytes + 2] ^= 0x40;
+            Handler h;
+            BEAST_EXPECT(invokeProtocolMessage (
+                boost::asio::buffer (bad), h).second);
+            BEAST_EXPECT(! h.message);
+        }
+
+        // The packed length is too large
+        {
+            auto bad = packed;
+            bad[Message::kHeaderBytes] = 0xFF;
+            Handler h;
+            BEAST_EXPECT(invokeProtocolMessage (
+                boost::asio::buffer (bad), h).second);
+        }
+
+        // The compressed data is truncated
+        {
+            std::vector<std::uint8_t> bad (packed.begin (),
+                packed.begin () + Message::kHeaderBytes + 8);
+            Message::encodeHeader (bad.data (),
+                8 | Message::kCompressedBit, protocol::mtLEDGER_DATA);
+            Handler h;
+            BEAST_EXPECT(invokeProtocolMessage (
+                boost::asio::buffer (bad), h).second);
+        }
+    }
+
+public:
+    void
+    run () override
+    {
+        testRoundTrip ();
+        testUncompressed ();
+        testCorrupt ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(compression,overlay,ripple);
+
+}
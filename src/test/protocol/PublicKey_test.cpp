@@ -20,7 +20,12 @@
 #include <BeastConfig.h>
 #include <ripple/protocol/PublicKey.h>
 #include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/digest.h>
 #include <ripple/beast/unit_test.h>
+#include <openssl/bn.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <vector>
 
 namespace ripple {
@@ -382,11 +387,193 @@ public:
         BEAST_EXPECT(pk1 == pk3);
     }
 
+    // Little-endian conversions for the Ed25519 arithmetic below
+    static
+    BIGNUM*
+    fromLE (std::uint8_t const* data, std::size_t size)
+    {
+        std::vector<std::uint8_t> be (data, data + size);
+        std::reverse (be.begin(), be.end());
+        return BN_bin2bn (be.data(), be.size(), nullptr);
+    }
+
+    static
+    void
+    toLE (BIGNUM const* n, std::uint8_t* out)
+    {
+        std::array<std::uint8_t, 32> be {};
+        BN_bn2bin (n, be.data() + be.size() - BN_num_bytes (n));
+        std::reverse_copy (be.begin(), be.end(), out);
+    }
+
+    // Sign with the given key, but declare a public key which is
+    // the real one plus the point of order two, (0, -1). Verifying
+    // computes SB - hA' = R - hT, which is R only when h is even,
+    // so whether the signature is valid depends on the message.
+    // The cofactorless batch equation can't tell the two cases
+    // apart, and accepts the odd ones half of the time.
+    //
+    // Returns the public key, and sets `odd` to whether the
+    // signature is invalid.
+    blob
+    forgeTorsion (SecretKey const& sk, blob const& m,
+        blob& sig, bool& odd)
+    {
+        auto const pk = derivePublicKey (KeyType::ed25519, sk);
+        auto const good = sign (pk, sk, makeSlice (m));
+
+        BN_CTX* ctx = BN_CTX_new();
+        BIGNUM* order = nullptr;
+        BN_hex2bn (&order, "1000000000000000000000000000000"
+            "014DEF9DEA2F79CD65812631A5CF5D3ED");
+        BIGNUM* prime = nullptr;
+        BN_hex2bn (&prime, "7FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF"
+            "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFED");
+
+        // A' = -A's coordinates: y' = p - y, with x's sign flipped
+        std::array<std::uint8_t, 32> A;
+        std::memcpy (A.data(), pk.data() + 1, A.size());
+        bool const negative = (A[31] & 0x80) != 0;
+        A[31] &= 0x7f;
+        BIGNUM* const y = fromLE (A.data(), A.size());
+        BN_sub (y, prime, y);
+        toLE (y, A.data());
+        if (! negative)
+            A[31] |= 0x80;
+
+        // The secret scalar and the nonce, as ed25519_sign has them
+        sha512_hasher ha;
+        ha (sk.data(), sk.size());
+        auto const az = static_cast<sha512_hasher::result_type>(ha);
+        std::array<std::uint8_t, 32> a;
+        std::memcpy (a.data(), az.data(), a.size());
+        a[0] &= 248;
+        a[31] &= 127;
+        a[31] |= 64;
+        BIGNUM* const secret = fromLE (a.data(), a.size());
+
+        sha512_hasher hr;
+        hr (az.data() + 32, 32);
+        hr (m.data(), m.size());
+        auto const rd = static_cast<sha512_hasher::result_type>(hr);
+        BIGNUM* const r = fromLE (rd.data(), rd.size());
+        BN_nnmod (r, r, order, ctx);
+
+        sha512_hasher hh;
+        hh (good.data(), 32);
+        hh (A.data(), A.size());
+        hh (m.data(), m.size());
+        auto const hd = static_cast<sha512_hasher::result_type>(hh);
+        BIGNUM* const h = fromLE (hd.data(), hd.size());
+        BN_nnmod (h, h, order, ctx);
+        odd = BN_is_odd (h);
+
+        // S = r + h * a
+        BIGNUM* const S = BN_new();
+        BN_mod_mul (S, h, secret, order, ctx);
+        BN_mod_add (S, S, r, order, ctx);
+
+        sig.assign (good.data(), good.data() + 64);
+        toLE (S, sig.data() + 32);
+
+        for (auto n : {order, prime, y, secret, r, h, S})
+            BN_free (n);
+        BN_CTX_free (ctx);
+
+        blob result (1, 0xED);
+        result.insert (result.end(), A.begin(), A.end());
+        return result;
+    }
+
+    void testGroupVerify ()
+    {
+        testcase ("Group verification");
+
+        // Signatures of all kinds, valid and not
+        std::vector<blob> keys;
+        std::vector<blob> messages;
+        std::vector<Buffer> sigs;
+        std::vector<bool> expected;
+        for (int i = 0; i < 20; ++i)
+        {
+            auto const type = (i % 3) ?
+                KeyType::ed25519 : KeyType::secp256k1;
+            auto const kp = randomKeyPair (type);
+            blob const m (1 + i, static_cast<std::uint8_t>(i));
+            auto sig = sign (kp.first, kp.second, makeSlice (m));
+            bool const good = (i % 4) != 1;
+            if (! good)
+                sig.data()[10] ^= 0x01;
+            keys.emplace_back (kp.first.data(),
+                kp.first.data() + kp.first.size());
+            messages.push_back (m);
+            sigs.push_back (std::move (sig));
+            expected.push_back (good);
+        }
+
+        auto makeChecks = [&]
+        {
+            std::vector<SignatureCheck> checks;
+            for (std::size_t i = 0; i < keys.size(); ++i)
+                checks.push_back ({ makeSlice (keys[i]),
+                    makeSlice (messages[i]), sigs[i], true });
+            return checks;
+        };
+
+        {
+            auto const results = verify (makeChecks ());
+            BEAST_EXPECT(results.size() == keys.size());
+            for (std::size_t i = 0; i < keys.size(); ++i)
+                BEAST_EXPECT(results[i] == expected[i]);
+        }
+
+        // An unknown key type is simply invalid
+        {
+            auto checks = makeChecks ();
+            blob const junk (33, 0x01);
+            checks[0].publicKey = makeSlice (junk);
+            BEAST_EXPECT(! verify (checks)[0]);
+        }
+        BEAST_EXPECT(verify (std::vector<SignatureCheck>{}).empty());
+
+        // Signatures which a batch equation would accept part of
+        // the time must get the same answer as checking them alone.
+        auto const sk = randomSecretKey();
+        int tested[2] = { 0, 0 };
+        for (std::uint8_t i = 0;
+            tested[0] < 4 || tested[1] < 16; ++i)
+        {
+            blob const m (32, i);
+            blob sig;
+            bool odd;
+            auto const pk = forgeTorsion (sk, m, sig, odd);
+            ++tested[odd];
+
+            bool const alone = verify (PublicKey (makeSlice (pk)),
+                makeSlice (m), makeSlice (sig), true);
+            BEAST_EXPECT(alone == ! odd);
+
+            // Alongside only valid signatures, so that a batch
+            // as a whole could pass
+            std::vector<SignatureCheck> checks;
+            for (auto const& check : makeChecks ())
+                if (verify (std::vector<SignatureCheck>{ check })[0])
+                    checks.push_back (check);
+            checks.push_back ({ makeSlice (pk), makeSlice (m),
+                makeSlice (sig), true });
+            auto const results = verify (checks);
+            BEAST_EXPECT(results.back() == alone);
+            BEAST_EXPECT(std::count (results.begin(),
+                results.end(), true) == checks.size() - 1 + alone);
+        }
+    }
+
     void run() override
     {
         testBase58();
         testCanonical();
         testMiscOperations();
+        testGroupVerify();
     }
 };
 
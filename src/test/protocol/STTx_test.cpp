@@ -37,6 +37,48 @@ public:
 
         testcase ("ed25519 signatures");
         testSTTx (KeyType::ed25519);
+
+        testcase ("batch signatures");
+        testBatch ();
+    }
+
+    void testBatch()
+    {
+        std::vector<std::shared_ptr<STTx const>> txs;
+        std::vector<bool> expected;
+        for (int i = 0; i < 150; ++i)
+        {
+            auto const keypair = randomKeyPair (
+                (i % 5) ? KeyType::ed25519 : KeyType::secp256k1);
+
+            STTx tx (ttACCOUNT_SET,
+                [&keypair, i](auto& obj)
+                {
+                    obj.setAccountID (sfAccount, calcAccountID(keypair.first));
+                    obj.setFieldU32 (sfSequence, i);
+                    obj.setFieldVL (sfSigningPubKey, keypair.first.slice());
+                });
+            tx.sign (keypair.first, keypair.second);
+
+            // Spoil every seventh signature by changing
+            // a signed field after signing.
+            bool const good = (i % 7) != 3;
+            if (! good)
+                tx.setFieldU32 (sfSequence, i + 1);
+
+            txs.push_back (std::make_shared<STTx const> (std::move (tx)));
+            expected.push_back (good);
+        }
+
+        auto const results = checkSign (txs, true);
+        BEAST_EXPECT(results.size() == txs.size());
+        for (std::size_t i = 0; i < txs.size(); ++i)
+        {
+            BEAST_EXPECT(results[i].first == expected[i]);
+            BEAST_EXPECT(results[i].first == txs[i]->checkSign (true).first);
+        }
+
+        BEAST_EXPECT(checkSign ({}, true).empty());
     }
 
     void testSTTx(KeyType keyType)
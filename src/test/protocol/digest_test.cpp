@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <ripple/protocol/digest.h>
+#include <ripple/basics/random.h>
 #include <ripple/beast/utility/rngfill.h>
 #include <ripple/beast/xor_shift_engine.h>
 #include <ripple/beast/unit_test.h>
@@ -149,14 +150,125 @@ public:
         pass ();
     }
 
+    // Hash the dataset one message at a time, then in batches
+    void testSHA512HalfBatch ()
+    {
+        testcase ("SHA512Half batch");
+
+        using namespace std::chrono;
+
+        std::vector<Slice> messages;
+        messages.reserve (dataset1.size ());
+        for (auto const& x : dataset1)
+            messages.emplace_back (x.data (), x.size ());
+        std::vector<uint256> digests (messages.size ());
+
+        auto const single = [&]
+        {
+            auto const start = high_resolution_clock::now ();
+            for (std::size_t i = 0; i < messages.size (); ++i)
+                digests[i] = sha512Half (messages[i]);
+            return high_resolution_clock::now () - start;
+        };
+
+        auto const batch = [&](std::size_t size)
+        {
+            auto const start = high_resolution_clock::now ();
+            for (std::size_t i = 0; i < messages.size (); i += size)
+            {
+                sha512HalfBatch (&messages[i],
+                    std::min (size, messages.size () - i), &digests[i]);
+            }
+            return high_resolution_clock::now () - start;
+        };
+
+        auto const rate = [&](high_resolution_clock::duration d)
+        {
+            return static_cast<std::size_t> (messages.size () /
+                std::max (duration<double> (d).count (), 1e-9));
+        };
+
+        log << "    " << (sha512HalfBatchIsVectorized () ?
+            "AVX2" : "Scalar") << ":" << std::endl;
+        log << "       single: " << rate (single ()) <<
+            " hashes/s" << std::endl;
+        for (std::size_t size : { 4, 16, 256, 4096 })
+        {
+            log << "    batch " << size << ": " << rate (batch (size)) <<
+                " hashes/s" << std::endl;
+        }
+        pass ();
+    }
+
     void run ()
     {
         testSHA512 ();
         testSHA256 ();
         testRIPEMD160 ();
+        testSHA512HalfBatch ();
     }
 };
 
 BEAST_DEFINE_TESTSUITE_MANUAL(digest,ripple_data,ripple);
 
+//------------------------------------------------------------------------------
+
+class sha512HalfBatch_test : public beast::unit_test::suite
+{
+    // Compare each digest of a batch with sha512Half
+    void check (std::vector<Blob> const& data)
+    {
+        std::vector<Slice> messages;
+        for (auto const& x : data)
+            messages.emplace_back (x.data (), x.size ());
+
+        std::vector<uint256> digests (messages.size ());
+        sha512HalfBatch (messages.data (), messages.size (), digests.data ());
+
+        for (std::size_t i = 0; i < messages.size (); ++i)
+            BEAST_EXPECT(digests[i] == sha512Half (messages[i]));
+    }
+
+public:
+    void run ()
+    {
+        beast::xor_shift_engine g (19207813);
+
+        testcase ("padding");
+        // Every length across the one and two block boundaries, with
+        // lanes of different lengths in each group of four
+        for (std::size_t size = 0; size <= 300; ++size)
+        {
+            std::vector<Blob> data;
+            for (std::size_t n : { size, size / 2, size + 128, size })
+            {
+                data.emplace_back (n);
+                beast::rngfill (data.back ().data (), n, g);
+            }
+            check (data);
+        }
+
+        testcase ("batch sizes");
+        // Short groups repeat a lane, and a single message is scalar
+        for (std::size_t count = 0; count <= 9; ++count)
+        {
+            std::vector<Blob> data (count, Blob (100));
+            for (auto& x : data)
+                beast::rngfill (x.data (), x.size (), g);
+            check (data);
+        }
+
+        testcase ("mixed lengths");
+        std::vector<Blob> data;
+        for (int i = 0; i < 1000; ++i)
+        {
+            data.emplace_back (rand_int (g, std::size_t{2048}));
+            beast::rngfill (data.back ().data (), data.back ().size (), g);
+        }
+        check (data);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(sha512HalfBatch,ripple_data,ripple);
+
 } // ripple
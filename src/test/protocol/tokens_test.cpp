@@ -0,0 +1,348 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/protocol/tokens.h>
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/basics/random.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/beast/unit_test.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+// The byte at a time conversions which the limb based codec
+// replaced, kept to check its results and to time it against.
+namespace reference {
+
+// Code from Bitcoin: https://github.com/bitcoin/bitcoin
+// Copyright (c) 2014 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+static char const alphabet[] =
+    "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz";
+
+static
+std::string
+encodeBase58 (unsigned char const* pbegin, std::size_t size)
+{
+    auto const pend = pbegin + size;
+    int zeroes = 0;
+    while (pbegin != pend && *pbegin == 0)
+    {
+        pbegin++;
+        zeroes++;
+    }
+    std::vector<unsigned char> b58 (size * (138 / 100 + 1));
+    while (pbegin != pend)
+    {
+        int carry = *pbegin;
+        for (auto iter = b58.rbegin(); iter != b58.rend(); ++iter)
+        {
+            carry += 256 * (*iter);
+            *iter = carry % 58;
+            carry /= 58;
+        }
+        pbegin++;
+    }
+    auto iter = std::find_if (b58.begin(), b58.end(),
+        [](unsigned char c) { return c != 0; });
+    std::string str (zeroes, alphabet[0]);
+    while (iter != b58.end())
+        str += alphabet[*(iter++)];
+    return str;
+}
+
+static
+std::string
+decodeBase58 (std::string const& s)
+{
+    std::array<int, 256> inv;
+    inv.fill (-1);
+    for (int i = 0; i < 58; ++i)
+        inv[static_cast<unsigned char>(alphabet[i])] = i;
+
+    auto psz = s.c_str();
+    auto remain = s.size();
+    int zeroes = 0;
+    while (remain > 0 && inv[static_cast<unsigned char>(*psz)] == 0)
+    {
+        ++zeroes;
+        ++psz;
+        --remain;
+    }
+    std::vector<unsigned char> b256 (remain * 733 / 1000 + 1);
+    while (remain > 0)
+    {
+        auto carry = inv[static_cast<unsigned char>(*psz)];
+        if (carry == -1)
+            return {};
+        for (auto iter = b256.rbegin(); iter != b256.rend(); ++iter)
+        {
+            carry += 58 * *iter;
+            *iter = carry % 256;
+            carry /= 256;
+        }
+        ++psz;
+        --remain;
+    }
+    auto iter = std::find_if (b256.begin(), b256.end(),
+        [](unsigned char c) { return c != 0; });
+    std::string result (zeroes, 0x00);
+    while (iter != b256.end())
+        result.push_back (*(iter++));
+    return result;
+}
+
+static
+std::string
+encodeToken (std::uint8_t type, void const* token, std::size_t size)
+{
+    std::vector<unsigned char> expanded (1 + size + 4);
+    expanded[0] = type;
+    std::memcpy (expanded.data() + 1, token, size);
+    sha256_hasher h1;
+    h1 (expanded.data(), 1 + size);
+    auto const d1 = static_cast<sha256_hasher::result_type>(h1);
+    sha256_hasher h2;
+    h2 (d1.data(), d1.size());
+    auto const d2 = static_cast<sha256_hasher::result_type>(h2);
+    std::memcpy (expanded.data() + 1 + size, d2.data(), 4);
+    return encodeBase58 (expanded.data(), expanded.size());
+}
+
+} // reference
+
+static
+std::vector<unsigned char>
+randomBytes (beast::xor_shift_engine& r, std::size_t size)
+{
+    std::vector<unsigned char> v (size);
+    for (auto& c : v)
+        c = rand_int<unsigned char>(r);
+    return v;
+}
+
+class tokens_test : public beast::unit_test::suite
+{
+public:
+    void
+    testEncode ()
+    {
+        testcase ("encode");
+
+        beast::xor_shift_engine r;
+        for (std::size_t size = 0; size <= 64; ++size)
+        {
+            for (int i = 0; i < 32; ++i)
+            {
+                auto v = randomBytes (r, size);
+                // Cover runs of leading zeroes in the token
+                std::fill_n (v.begin(),
+                    std::min<std::size_t> (i % 4, size), 0);
+                auto const type = (i % 2) ?
+                    TOKEN_ACCOUNT_ID : TOKEN_NODE_PUBLIC;
+                BEAST_EXPECT(base58EncodeToken (type, v.data(), size) ==
+                    reference::encodeToken (type, v.data(), size));
+            }
+        }
+
+        AccountID const zero (beast::zero);
+        BEAST_EXPECT(toBase58 (zero) == "rrrrrrrrrrrrrrrrrrrrrhoLvTp");
+        AccountID const one (1);
+        BEAST_EXPECT(toBase58 (one) == "rrrrrrrrrrrrrrrrrrrrBZbvji");
+    }
+
+    void
+    testDecode ()
+    {
+        testcase ("decode");
+
+        beast::xor_shift_engine r;
+        for (std::size_t size = 1; size <= 64; ++size)
+        {
+            for (int i = 0; i < 32; ++i)
+            {
+                auto v = randomBytes (r, size);
+                std::fill_n (v.begin(),
+                    std::min<std::size_t> (i % 4, size), 0);
+                std::string const token (v.begin(), v.end());
+                auto const s = base58EncodeToken (
+                    TOKEN_ACCOUNT_PUBLIC, v.data(), size);
+
+                BEAST_EXPECT(decodeBase58Token (
+                    s, TOKEN_ACCOUNT_PUBLIC) == token);
+                BEAST_EXPECT(decodeBase58Token (
+                    s, TOKEN_NODE_PUBLIC).empty());
+
+                // Characters outside the alphabet
+                auto bad = s;
+                bad[bad.size() / 2] = '0';
+                BEAST_EXPECT(decodeBase58Token (
+                    bad, TOKEN_ACCOUNT_PUBLIC).empty());
+            }
+        }
+
+        // Strings which are not tokens, including ones long
+        // enough to need working storage off the stack
+        std::string const big (128, 'z');
+        for (auto const& s : {std::string (), std::string ("r"),
+            std::string ("rrr"), std::string ("rpshnaf39wBUDNEGHJ"),
+            std::string ("0OIl"), big, std::string (40, 'r') + big})
+        {
+            BEAST_EXPECT(decodeBase58Token (s, TOKEN_ACCOUNT_ID).empty());
+        }
+
+        // Leading zero bytes survive the round trip
+        AccountID const zero (beast::zero);
+        BEAST_EXPECT(parseBase58<AccountID> (
+            "rrrrrrrrrrrrrrrrrrrrrhoLvTp") == zero);
+    }
+
+    void
+    testBatch ()
+    {
+        testcase ("batch");
+
+        beast::xor_shift_engine r;
+        std::vector<AccountID> ids;
+        for (int i = 0; i < 64; ++i)
+        {
+            auto const v = randomBytes (r, AccountID::bytes);
+            ids.push_back (AccountID::fromVoid (v.data()));
+        }
+        auto const encoded = toBase58 (ids);
+        BEAST_EXPECT(encoded.size() == ids.size());
+        for (std::size_t i = 0; i < ids.size(); ++i)
+            BEAST_EXPECT(encoded[i] == toBase58 (ids[i]));
+
+        auto const keys = randomBytes (r, 33 * 16);
+        auto const keysEncoded = base58EncodeTokens (
+            TOKEN_NODE_PUBLIC, keys.data(), 33, 16);
+        BEAST_EXPECT(keysEncoded.size() == 16);
+        for (std::size_t i = 0; i < keysEncoded.size(); ++i)
+            BEAST_EXPECT(keysEncoded[i] == reference::encodeToken (
+                TOKEN_NODE_PUBLIC, keys.data() + 33 * i, 33));
+
+        BEAST_EXPECT(base58EncodeTokens (
+            TOKEN_ACCOUNT_ID, nullptr, 20, 0).empty());
+    }
+
+    void
+    run ()
+    {
+        testEncode ();
+        testDecode ();
+        testBatch ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(tokens,protocol,ripple);
+
+//------------------------------------------------------------------------------
+
+// Compares the time to encode and decode account IDs and public
+// keys with the limb based codec against the byte at a time one.
+class tokensTiming_test : public beast::unit_test::suite
+{
+public:
+    enum
+    {
+        tokens = 100000
+    };
+
+    template <class F>
+    std::chrono::milliseconds
+    time (F&& f)
+    {
+        using namespace std::chrono;
+        auto const start = steady_clock::now ();
+        f ();
+        return duration_cast<milliseconds> (steady_clock::now () - start);
+    }
+
+    void
+    testSize (std::string const& name, std::uint8_t type, std::size_t size)
+    {
+        beast::xor_shift_engine r;
+        auto const data = randomBytes (r, size * tokens);
+        std::size_t n = 0;
+
+        auto const reference = time ([&]
+        {
+            for (std::size_t i = 0; i < tokens; ++i)
+                n += reference::encodeToken (
+                    type, data.data() + size * i, size).size();
+        });
+        auto const single = time ([&]
+        {
+            for (std::size_t i = 0; i < tokens; ++i)
+                n += base58EncodeToken (
+                    type, data.data() + size * i, size).size();
+        });
+        std::vector<std::string> encoded;
+        auto const batch = time ([&]
+        {
+            encoded = base58EncodeTokens (type, data.data(), size, tokens);
+        });
+
+        std::size_t decodedSize = 0;
+        auto const referenceDecode = time ([&]
+        {
+            for (auto const& s : encoded)
+                decodedSize += reference::decodeBase58 (s).size();
+        });
+        auto const decode = time ([&]
+        {
+            for (auto const& s : encoded)
+                decodedSize += decodeBase58Token (s, type).size();
+        });
+
+        BEAST_EXPECT(n > 0);
+        BEAST_EXPECT(decodedSize > 0);
+
+        log <<
+            tokens << " " << name << ": encode " <<
+            "reference " << reference.count() << "ms, " <<
+            "limbs " << single.count() << "ms, " <<
+            "batch " << batch.count() << "ms; decode " <<
+            "reference " << referenceDecode.count() << "ms, " <<
+            "limbs " << decode.count() << "ms" << std::endl;
+    }
+
+    void
+    run ()
+    {
+        testcase ("base58 timing");
+        testSize ("account IDs", TOKEN_ACCOUNT_ID, 20);
+        testSize ("public keys", TOKEN_ACCOUNT_PUBLIC, 33);
+        testSize ("64 byte tokens", TOKEN_NONE, 64);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(tokensTiming,protocol,ripple);
+
+} // ripple
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/resource/Consumer.h>
+#include <ripple/resource/impl/Entry.h>
+#include <ripple/resource/impl/Logic.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace Resource {
+
+// Measures how many charges per second the consumer table takes
+// against the number of threads charging, with each thread charging
+// its own consumer and with all of them charging the same one.
+class LogicTiming_test : public beast::unit_test::suite
+{
+public:
+    enum
+    {
+        charges = 200000
+    };
+
+    // Returns charges per second
+    double
+    measure (Logic& logic, std::vector <Consumer>& consumers, int threads)
+    {
+        std::vector <std::thread> workers;
+        workers.reserve (threads);
+
+        Charge const fee (1);
+        auto const start = std::chrono::steady_clock::now ();
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back (
+                [&consumers, &fee, t]
+                {
+                    // Copy the consumer, as a peer or client holds one
+                    Consumer c (consumers[t % consumers.size ()]);
+                    for (int i = 0; i < charges; ++i)
+                        c.charge (fee);
+                });
+        }
+        for (auto& worker : workers)
+            worker.join ();
+        std::chrono::duration <double> const elapsed =
+            std::chrono::steady_clock::now () - start;
+
+        return threads * charges / elapsed.count ();
+    }
+
+    void
+    run ()
+    {
+        testcase ("charge throughput");
+
+        beast::Journal const j;
+        Logic logic (beast::insight::NullCollector::New (), stopwatch (), j);
+
+        int const most = std::max (4u, std::thread::hardware_concurrency ());
+
+        std::vector <Consumer> distinct;
+        for (int t = 0; t < most; ++t)
+            distinct.push_back (logic.newInboundEndpoint (
+                beast::IP::Endpoint (beast::IP::AddressV4 (
+                    192, 0, 2, 1 + t))));
+
+        std::vector <Consumer> shared;
+        shared.push_back (logic.newInboundEndpoint (
+            beast::IP::Endpoint (beast::IP::AddressV4 (198, 51, 100, 1))));
+
+        for (int threads = 1; threads <= most; threads *= 2)
+        {
+            auto const own = measure (logic, distinct, threads);
+            auto const one = measure (logic, shared, threads);
+
+            log <<
+                threads << " threads: " <<
+                "distinct " << static_cast <std::uint64_t> (own) << "/s, " <<
+                "shared " << static_cast <std::uint64_t> (one) << "/s" <<
+                std::endl;
+        }
+
+        BEAST_EXPECT(shared.front ().balance () > 0);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(LogicTiming,resource,ripple);
+
+}
+}
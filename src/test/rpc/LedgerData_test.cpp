@@ -18,6 +18,8 @@
 //==============================================================================
 
 #include <ripple/protocol/JsonFields.h>
+#include <ripple/test/JSONRPCClient.h>
+#include <ripple/test/WSClient.h>
 #include <ripple/test/jtx.h>
 
 namespace ripple {
@@ -221,6 +223,67 @@ public:
         BEAST_EXPECT( running_total == total_count );
     }
 
+    void testStream()
+    {
+        using namespace test::jtx;
+        Env env { *this };
+        Account const gw { "gateway" };
+        env.fund(XRP(100000), gw);
+
+        for (auto i = 0; i < 20; i++)
+        {
+            Account const bob { std::string("bob") + std::to_string(i) };
+            env.fund(XRP(1000), bob);
+        }
+        env.close();
+        env.fund(XRP(1000), Account {"carol"});
+
+        // The command line cannot stream
+        {
+            Json::Value jvParams;
+            jvParams[jss::stream] = true;
+            auto const jrr = env.rpc ( "json", "ledger_data", jvParams.toStyledString() ) [jss::result];
+            BEAST_EXPECT(jrr[jss::error] == "notSupported");
+        }
+
+        auto ws = test::makeWS2Client(env.app().config());
+
+        // A streamed HTTP reply ends the connection
+        auto const streamHTTP = [&env](Json::Value const& params)
+        {
+            return test::makeJSONRPCClient(env.app().config())->invoke(
+                "ledger_data", params)[jss::result];
+        };
+
+        for (auto const ledger : {"closed", "current"})
+        {
+            for (auto const binary : {false, true})
+            {
+                Json::Value jvParams;
+                jvParams[jss::ledger_index] = ledger;
+                jvParams[jss::binary]       = binary;
+                auto const paged = env.rpc ( "json", "ledger_data", jvParams.toStyledString() ) [jss::result];
+                BEAST_EXPECT( ! paged.isMember(jss::marker) );
+
+                jvParams[jss::stream] = true;
+                for (auto const& jrr : {streamHTTP(jvParams),
+                    ws->invoke("ledger_data", jvParams)[jss::result]})
+                {
+                    BEAST_EXPECT(jrr[jss::status] == "success");
+                    BEAST_EXPECT(jrr[jss::ledger_hash] == paged[jss::ledger_hash]);
+                    BEAST_EXPECT(jrr[jss::state] == paged[jss::state]);
+                }
+
+                // Resume after a marker
+                jvParams[jss::marker] = paged[jss::state][4u][jss::index];
+                auto const jrr = streamHTTP(jvParams);
+                BEAST_EXPECT(checkArraySize(jrr[jss::state],
+                    paged[jss::state].size() - 5));
+                BEAST_EXPECT(jrr[jss::state][0u] == paged[jss::state][5u]);
+            }
+        }
+    }
+
     void run()
     {
         testCurrentLedgerToLimits(true);
@@ -228,6 +291,7 @@ public:
         testCurrentLedgerBinary();
         testBadInput();
         testMarkerFollow();
+        testStream();
     }
 
 };
@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/SHAMapItem.h>
+#include <ripple/shamap/tests/common.h>
+#include <ripple/basics/random.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/test/BasicNetwork.h>
+#include <boost/lexical_cast.hpp>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace tests {
+
+/** Measures state map acquisition from one versus several peers.
+
+    Peers are simulated with BasicNetwork. Each round the syncer asks
+    for its missing nodes, splits them into disjoint subtrees, one group
+    per peer, and applies the replies concurrently as InboundLedger
+    does. The suite argument sets the number of items (default 1000000).
+    InboundLedger_test runs the same rounds through InboundLedger's own
+    gotData and runData.
+*/
+class ParallelSync_test : public beast::unit_test::suite
+{
+    // Peer 0 is the syncer, peers 1..n serve the source map
+    using Network = ripple::test::BasicNetwork<int>;
+
+    struct Reply
+    {
+        std::vector<SHAMapNodeID> ids;
+        std::vector<Blob> nodes;
+    };
+
+    static
+    std::shared_ptr<SHAMapItem>
+    makeRandomAS ()
+    {
+        Serializer s;
+        for (int d = 0; d < 3; ++d)
+            s.add32 (rand_int<std::uint32_t>());
+        return std::make_shared<SHAMapItem>(
+            s.getSHA512Half(), s.peekData ());
+    }
+
+    void
+    sync (SHAMap const& source, std::size_t peers)
+    {
+        using namespace std::chrono;
+        using namespace std::chrono_literals;
+
+        beast::Journal const j;
+        TestFamily f (j);
+        SHAMap dest (SHAMapType::FREE, f, source.get_version ());
+        dest.setSynching ();
+
+        {
+            std::vector<SHAMapNodeID> ids;
+            std::vector<Blob> nodes;
+            BEAST_EXPECT(source.getNodeFat (
+                SHAMapNodeID (), ids, nodes, false, 0));
+            BEAST_EXPECT(dest.addRootNode (source.getHash (),
+                makeSlice (nodes.front ()), snfWIRE, nullptr).isGood ());
+        }
+
+        Network net;
+        for (int peer = 1; peer <= peers; ++peer)
+        {
+            net.connect (0, peer, 50ms);
+            net.connect (peer, 0, 50ms);
+        }
+
+        auto const wallStart = steady_clock::now ();
+        auto const netStart = net.now ();
+        std::size_t rounds = 0;
+
+        while (true)
+        {
+            auto missing = dest.getMissingNodes (256 * peers, nullptr);
+            if (missing.empty ())
+                break;
+            if (missing.size () > 128 * peers)
+                missing.resize (128 * peers);
+            ++rounds;
+
+            std::vector<Reply> replies;
+            auto const groups = SHAMap::splitMissingNodes (missing, peers);
+            for (int peer = 1; peer <= peers; ++peer)
+            {
+                auto const& group = groups[peer - 1];
+                if (group.empty ())
+                    continue;
+                net.send (0, peer, [&, peer]
+                {
+                    auto reply = std::make_shared<Reply>();
+                    for (auto const& node : group)
+                        source.getNodeFat (node.first,
+                            reply->ids, reply->nodes, true, 1);
+                    net.send (peer, 0, [&replies, reply]
+                    {
+                        replies.push_back (std::move (*reply));
+                    });
+                });
+            }
+            net.step ();
+
+            std::vector<std::thread> threads;
+            for (auto const& reply : replies)
+            {
+                threads.emplace_back ([&dest, &reply]
+                {
+                    for (std::size_t i = 0; i < reply.ids.size (); ++i)
+                        dest.addKnownNode (reply.ids[i],
+                            makeSlice (reply.nodes[i]), nullptr);
+                });
+            }
+            for (auto& t : threads)
+                t.join ();
+        }
+
+        dest.clearSynching ();
+        BEAST_EXPECT(source.deepCompare (dest));
+
+        log << peers << " peer(s): " << rounds << " rounds, " <<
+            duration_cast<milliseconds>(net.now () - netStart).count () <<
+            "ms simulated, " <<
+            duration_cast<milliseconds>(
+                steady_clock::now () - wallStart).count () <<
+            "ms wall" << std::endl;
+    }
+
+public:
+    void
+    run () override
+    {
+        std::size_t items = 1000000;
+        if (! arg ().empty ())
+            items = boost::lexical_cast<std::size_t>(arg ());
+
+        beast::Journal const j;
+        TestFamily f (j);
+        SHAMap source (SHAMapType::FREE, f, SHAMap::version{1});
+        for (std::size_t i = 0; i < items; ++i)
+            source.addItem (std::move (*makeRandomAS ()), false, false);
+        source.getHash ();      // compute the tree's hashes
+        source.setImmutable ();
+
+        sync (source, 1);
+        sync (source, 4);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ParallelSync,shamap,ripple);
+
+} // tests
+} // ripple
@@ -0,0 +1,137 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/tests/common.h>
+#include <ripple/basics/random.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/beast/unit_test.h>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+namespace ripple {
+namespace tests {
+
+// Measures how long flushing a map takes, as when a ledger
+// closes, against the number of modified nodes, with the
+// branches of the root flushed serially and in parallel.
+class SHAMapFlush_test : public beast::unit_test::suite
+{
+public:
+    enum
+    {
+        tableItems = 100000,
+        passes = 4
+    };
+
+    static
+    std::shared_ptr <SHAMapItem>
+    make_random_item (beast::xor_shift_engine& r)
+    {
+        Serializer s;
+        for (int d = 0; d < 3; ++d)
+            s.add32 (rand_int<std::uint32_t>(r));
+        return std::make_shared <SHAMapItem> (
+            s.getSHA512Half(), s.peekData ());
+    }
+
+    // Add the items to a mutable snapshot of the map and flush it,
+    // returning the elapsed time and the number of nodes flushed.
+    std::pair <std::chrono::microseconds, int>
+    flush (SHAMap const& map, int threshold,
+        std::vector <std::shared_ptr <SHAMapItem>> const& items,
+        SHAMapHash& hash)
+    {
+        auto copy = map.snapShot (true);
+        copy->setFlushThreshold (threshold);
+        for (auto const& item : items)
+            BEAST_EXPECT(copy->addItem (SHAMapItem (*item), false, false));
+
+        auto const start = std::chrono::steady_clock::now ();
+        int const flushed = copy->flushDirty (hotACCOUNT_NODE, 2);
+        auto const elapsed = std::chrono::duration_cast <
+            std::chrono::microseconds> (
+                std::chrono::steady_clock::now () - start);
+
+        hash = copy->getHash ();
+        return { elapsed, flushed };
+    }
+
+    void
+    run ()
+    {
+        testcase ("flush latency");
+
+        beast::Journal const j;
+        TestFamily f (j);
+        beast::xor_shift_engine r;
+
+        SHAMap map (SHAMapType::FREE, f, SHAMap::version{1});
+        for (int i = 0; i < tableItems; ++i)
+        {
+            auto item = make_random_item (r);
+            BEAST_EXPECT(map.addItem (std::move (*item), false, false));
+        }
+        map.flushDirty (hotACCOUNT_NODE, 1);
+        map.setImmutable ();
+
+        for (int changes = 10; changes <= tableItems; changes *= 10)
+        {
+            std::vector <std::shared_ptr <SHAMapItem>> items;
+            items.reserve (changes);
+            for (int i = 0; i < changes; ++i)
+                items.push_back (make_random_item (r));
+
+            std::chrono::microseconds serial {0};
+            std::chrono::microseconds parallel {0};
+            int nodes = 0;
+
+            for (int i = 0; i < passes; ++i)
+            {
+                SHAMapHash serialHash;
+                SHAMapHash parallelHash;
+
+                auto const s = flush (map,
+                    std::numeric_limits <int>::max (), items, serialHash);
+                auto const p = flush (map, 0, items, parallelHash);
+
+                BEAST_EXPECT(serialHash == parallelHash);
+                BEAST_EXPECT(s.second == p.second);
+
+                serial += s.first;
+                parallel += p.first;
+                nodes = s.second;
+            }
+
+            log <<
+                changes << " changes, " << nodes << " nodes: " <<
+                "serial " << (serial / passes).count () << "us, " <<
+                "parallel " << (parallel / passes).count () << "us" <<
+                std::endl;
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapFlush,shamap,ripple);
+
+} // tests
+} // ripple
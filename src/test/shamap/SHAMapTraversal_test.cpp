@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2016 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/tests/common.h>
+#include <ripple/basics/random.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/beast/unit_test.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace tests {
+
+// Measures how SHAMap traversal scales when many threads
+// walk the same tree, which exercises child publication
+// in the inner nodes.
+class SHAMapTraversal_test : public beast::unit_test::suite
+{
+public:
+    enum
+    {
+        tableItems = 100000,
+        passes = 4
+    };
+
+    static
+    std::shared_ptr <SHAMapItem>
+    make_random_item (beast::xor_shift_engine& r)
+    {
+        Serializer s;
+        for (int d = 0; d < 3; ++d)
+            s.add32 (rand_int<std::uint32_t>(r));
+        return std::make_shared <SHAMapItem> (
+            s.getSHA512Half(), s.peekData ());
+    }
+
+    // Visit every leaf of the map from each of the given
+    // number of threads, returning the elapsed time.
+    std::chrono::milliseconds
+    traverse (SHAMap const& map, int threads)
+    {
+        std::atomic <std::size_t> visited (0);
+        std::vector <std::thread> workers;
+        workers.reserve (threads);
+
+        auto const start = std::chrono::steady_clock::now ();
+        for (int i = 0; i < threads; ++i)
+        {
+            workers.emplace_back (
+                [&map, &visited]
+                {
+                    std::size_t n = 0;
+                    for (auto const& item : map)
+                    {
+                        (void) item;
+                        ++n;
+                    }
+                    visited += n;
+                });
+        }
+        for (auto& t : workers)
+            t.join ();
+        auto const elapsed = std::chrono::duration_cast <
+            std::chrono::milliseconds> (
+                std::chrono::steady_clock::now () - start);
+
+        BEAST_EXPECT(visited == static_cast <std::size_t> (
+            tableItems) * threads);
+        return elapsed;
+    }
+
+    void
+    run ()
+    {
+        testcase ("concurrent traversal");
+
+        beast::Journal const j;
+        TestFamily f (j);
+        beast::xor_shift_engine r;
+
+        SHAMapHash hash;
+        {
+            SHAMap source (SHAMapType::FREE, f, SHAMap::version{1});
+            for (int i = 0; i < tableItems; ++i)
+            {
+                auto item = make_random_item (r);
+                BEAST_EXPECT(source.addItem (std::move (*item), false, false));
+            }
+            source.flushDirty (hotACCOUNT_NODE, 1);
+            hash = source.getHash ();
+        }
+
+        int const maxThreads = std::max (4u,
+            std::thread::hardware_concurrency ());
+
+        for (int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            // Start from a cold tree so that every thread
+            // races to hook up the children it loads.
+            f.treecache ().clear ();
+            SHAMap map (SHAMapType::FREE, hash.as_uint256 (), f,
+                SHAMap::version{1});
+            BEAST_EXPECT(map.fetchRoot (hash, nullptr));
+            map.setImmutable ();
+
+            auto const cold = traverse (map, threads);
+
+            std::chrono::milliseconds warm {0};
+            for (int i = 0; i < passes; ++i)
+                warm += traverse (map, threads);
+            warm /= passes;
+
+            auto const rate = [threads](std::chrono::milliseconds ms)
+            {
+                return static_cast <std::size_t> (1000.0 * tableItems *
+                    threads / std::max <std::int64_t> (ms.count (), 1));
+            };
+
+            log <<
+                threads << " threads: " <<
+                "cold " << cold.count () << "ms (" <<
+                    rate (cold) << " leaves/s), " <<
+                "warm " << warm.count () << "ms (" <<
+                    rate (warm) << " leaves/s)" << std::endl;
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapTraversal,shamap,ripple);
+
+} // tests
+} // ripple
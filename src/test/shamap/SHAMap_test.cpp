@@ -22,8 +22,10 @@
 #include <ripple/shamap/tests/common.h>
 #include <ripple/basics/Blob.h>
 #include <ripple/basics/StringUtilities.h>
+#include <ripple/protocol/digest.h>
 #include <ripple/beast/unit_test.h>
 #include <ripple/beast/utility/Journal.h>
+#include <limits>
 
 namespace ripple {
 namespace tests {
@@ -122,6 +124,101 @@ public:
         run (false, SHAMap::version{1});
         run (true,  SHAMap::version{2});
         run (false, SHAMap::version{2});
+        testInnerNodeMemory ();
+        testParallelFlush (SHAMap::version{1});
+        testParallelFlush (SHAMap::version{2});
+    }
+
+    void testInnerNodeMemory ()
+    {
+        testcase ("inner node memory");
+
+        tests::TestFamily f{beast::Journal{}};
+        SHAMap map (SHAMapType::FREE, f, SHAMap::version{1});
+        map.setUnbacked ();
+        for (int k = 0; k < 1000; ++k)
+        {
+            uint256 key = sha512Half (k);
+            BEAST_EXPECT(map.addItem (
+                SHAMapItem{key, IntToVUC (k)}, true, false));
+        }
+        map.invariants ();
+
+        std::size_t nodes = 0;
+        std::size_t used = 0;
+        map.visitNodes ([&](SHAMapAbstractNode& node)
+            {
+                if (node.isInner ())
+                {
+                    ++nodes;
+                    used += node.getMemoryUsage ();
+                }
+                return false;
+            });
+        BEAST_EXPECT(nodes > 0);
+
+        // Inner nodes hold storage only for the branches in use
+        BEAST_EXPECT(used < nodes * (sizeof(SHAMapInnerNode) +
+            16 * (sizeof(SHAMapHash) +
+                sizeof(std::shared_ptr<SHAMapAbstractNode>))));
+        log << nodes << " inner nodes, " <<
+            (used / nodes) << " bytes each" << std::endl;
+    }
+
+    // Flushing the branches of the root in parallel must give the
+    // same hash and count as flushing the whole map serially.
+    void testParallelFlush (SHAMap::version v)
+    {
+        testcase ("parallel flush");
+
+        tests::TestFamily f{beast::Journal{}};
+        SHAMap map (SHAMapType::FREE, f, v);
+        for (int k = 0; k < 2000; ++k)
+        {
+            BEAST_EXPECT(map.addItem (
+                SHAMapItem{sha512Half (k), IntToVUC (k)}, false, false));
+        }
+        map.flushDirty (hotACCOUNT_NODE, 1);
+        map.setImmutable ();
+
+        for (auto const doWrite : {true, false})
+        {
+            SHAMapHash hash[2];
+            int flushed[2];
+
+            for (int i = 0; i < 2; ++i)
+            {
+                auto copy = map.snapShot (true);
+                copy->setFlushThreshold (
+                    (i == 0) ? std::numeric_limits<int>::max () : 0);
+
+                for (int k = 0; k < 100; ++k)
+                    BEAST_EXPECT(copy->delItem (sha512Half (k)));
+                for (int k = 100; k < 200; ++k)
+                {
+                    BEAST_EXPECT(copy->updateGiveItem (
+                        std::make_shared<SHAMapItem> (
+                            sha512Half (k), IntToVUC (k + 1)),
+                        false, false));
+                }
+                for (int k = 2000; k < 2500; ++k)
+                {
+                    BEAST_EXPECT(copy->addItem (
+                        SHAMapItem{sha512Half (k), IntToVUC (k)},
+                        false, false));
+                }
+
+                flushed[i] = doWrite ?
+                    copy->flushDirty (hotACCOUNT_NODE, 2) :
+                    copy->unshare ();
+                hash[i] = copy->getHash ();
+                copy->invariants ();
+            }
+
+            BEAST_EXPECT(flushed[0] > 0);
+            BEAST_EXPECT(flushed[0] == flushed[1]);
+            BEAST_EXPECT(hash[0] == hash[1]);
+        }
     }
 
     void run (bool backed, SHAMap::version v)
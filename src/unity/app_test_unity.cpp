@@ -24,14 +24,17 @@
 #include <test/app/DeliverMin_test.cpp>
 #include <test/app/Flow_test.cpp>
 #include <test/app/HashRouter_test.cpp>
+#include <test/app/InboundLedger_test.cpp>
 #include <test/app/LoadFeeTrack_test.cpp>
 #include <test/app/MultiSign_test.cpp>
 #include <test/app/OfferStream_test.cpp>
 #include <test/app/Offer_test.cpp>
+#include <test/app/OrderBookDB_test.cpp>
 #include <test/app/OversizeMeta_test.cpp>
 #include <test/app/Path_test.cpp>
 #include <test/app/PayChan_test.cpp>
 #include <test/app/Regression_test.cpp>
+#include <test/app/RippleLineCache_test.cpp>
 #include <test/app/SetAuth_test.cpp>
 #include <test/app/SetRegularKey_test.cpp>
 #include <test/app/SHAMapStore_test.cpp>
@@ -22,5 +22,6 @@
 #include <test/ledger/Directory_test.cpp>
 #include <test/ledger/PaymentSandbox_test.cpp>
 #include <test/ledger/PendingSaves_test.cpp>
+#include <test/ledger/SaveValidated_test.cpp>
 #include <test/ledger/SkipList_test.cpp>
 #include <test/ledger/View_test.cpp>
\ No newline at end of file
@@ -31,5 +31,6 @@
 #include <test/protocol/STAmount_test.cpp>
 #include <test/protocol/STObject_test.cpp>
 #include <test/protocol/STTx_test.cpp>
+#include <test/protocol/tokens_test.cpp>
 #include <test/protocol/types_test.cpp>
 #include <test/protocol/XRPAmount_test.cpp>
\ No newline at end of file
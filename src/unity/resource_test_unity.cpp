@@ -18,4 +18,5 @@
 */
 //==============================================================================
 
+#include <test/resource/LogicTiming_test.cpp>
 #include <test/resource/Logic_test.cpp>
\ No newline at end of file
@@ -19,5 +19,8 @@
 //==============================================================================
 
 #include <test/shamap/FetchPack_test.cpp>
+#include <test/shamap/ParallelSync_test.cpp>
+#include <test/shamap/SHAMapFlush_test.cpp>
 #include <test/shamap/SHAMapSync_test.cpp>
+#include <test/shamap/SHAMapTraversal_test.cpp>
 #include <test/shamap/SHAMap_test.cpp>
\ No newline at end of file